@@ -7,8 +7,8 @@
 // EEPROM存储配置
 #define EEPROM_CONFIG_START_ADDR    0
 #define EEPROM_MAGIC_NUMBER         0xAB
-#define EEPROM_VERSION              1
-#define EEPROM_CONFIG_SIZE          8
+#define EEPROM_VERSION              5
+#define EEPROM_CONFIG_SIZE          20
 
 // 配置参数范围定义
 #define MOTOR_DIRECTION_CW          0
@@ -18,6 +18,34 @@
 #define MOTOR_SPEED_MAX             30
 #define MOTOR_SPEED_DEFAULT         4
 
+// 电机速度预设值（毫秒），配置校验、配置菜单和编译期加速表共用
+// 运行时数组放在Flash中（config.cpp），用config_get_motor_speed_preset()读取；
+// 编译期加速表需要常量表达式，直接展开MOTOR_SPEED_PRESET_LIST
+#define MOTOR_SPEED_PRESET_COUNT    9
+#define MOTOR_SPEED_PRESET_LIST     2, 4, 6, 8, 10, 15, 30, 60, 100
+extern const uint8_t MOTOR_SPEED_PRESETS[MOTOR_SPEED_PRESET_COUNT] PROGMEM;
+
+#define MOTION_PROFILE_TRAPEZOID    0
+#define MOTION_PROFILE_SCURVE       1
+#define MOTION_PROFILE_DEFAULT      MOTION_PROFILE_TRAPEZOID
+
+// 齿轮间隙补偿（全步），28BYJ-48减速箱的间隙约1.5度
+#define BACKLASH_STEPS_MIN          0
+#define BACKLASH_STEPS_MAX          32
+#define BACKLASH_STEPS_STEP         2
+#define BACKLASH_STEPS_DEFAULT      8
+
+// 共振禁区（全步/秒），0-0表示未启用
+// 禁区宽度限制为下限的25%，加减速跳过禁区时的速度突变不会导致失步
+#define RESONANCE_BAND_COUNT        2
+#define RESONANCE_BAND_SPS_MAX      1000
+#define RESONANCE_BAND_WIDTH_PCT    25
+
+// 转台皮带/齿轮齿数比（转台齿数:电机轴齿数），电机直接驱动转台时为1:1
+#define BELT_TEETH_MIN              1
+#define BELT_TEETH_MAX              160     // 与STEPPER_GEAR_TEETH_MAX一致
+#define BELT_TEETH_DEFAULT          1
+
 #define ROTATION_ANGLE_90           90
 #define ROTATION_ANGLE_180          180
 #define ROTATION_ANGLE_360          360
@@ -37,6 +65,12 @@ typedef struct {
     uint8_t version;            // 版本号
     uint8_t motor_direction;    // 电机方向：0=顺时针，1=逆时针
     uint8_t motor_speed;        // 电机速度：2-8ms
+    uint8_t motion_profile;     // 速度曲线：0=梯形，1=S曲线
+    uint8_t backlash_steps;     // 齿轮间隙补偿：0-32全步
+    uint16_t resonance_band_min[RESONANCE_BAND_COUNT];  // 共振禁区下限（全步/秒）
+    uint16_t resonance_band_max[RESONANCE_BAND_COUNT];  // 共振禁区上限（全步/秒）
+    uint8_t belt_driven_teeth;  // 转台（从动轮）齿数：1-160
+    uint8_t belt_drive_teeth;   // 电机轴（主动轮）齿数：1-160
     uint16_t rotation_angle;    // 旋转角度：90/180/360/540/720度
     uint8_t photo_interval;     // 拍照间隔：5/10/15/30度
     uint8_t checksum;           // 校验和
@@ -57,23 +91,38 @@ uint8_t config_calculate_checksum(const system_config_t* config);
 system_config_t* config_get(void);
 uint8_t config_get_motor_direction(void);
 uint8_t config_get_motor_speed(void);
+uint8_t config_get_motion_profile(void);
+uint8_t config_get_backlash_steps(void);
+void config_get_resonance_band(uint8_t index, uint16_t* min_sps, uint16_t* max_sps);
+uint8_t config_get_belt_driven_teeth(void);
+uint8_t config_get_belt_drive_teeth(void);
 uint16_t config_get_rotation_angle(void);
 uint8_t config_get_photo_interval(void);
+uint8_t config_get_motor_speed_preset(uint8_t index);
 
 // 配置设置函数
 void config_set_motor_direction(uint8_t direction);
 void config_set_motor_speed(uint8_t speed);
+void config_set_motion_profile(uint8_t profile);
+void config_set_backlash_steps(uint8_t steps);
+void config_set_resonance_band(uint8_t index, uint16_t min_sps, uint16_t max_sps);
+void config_set_belt_ratio(uint8_t driven_teeth, uint8_t drive_teeth);
 void config_set_rotation_angle(uint16_t angle);
 void config_set_photo_interval(uint8_t interval);
 
 // 配置验证函数
 bool config_is_valid_motor_direction(uint8_t direction);
 bool config_is_valid_motor_speed(uint8_t speed);
+bool config_is_valid_motion_profile(uint8_t profile);
+bool config_is_valid_backlash_steps(uint8_t steps);
+bool config_is_valid_resonance_band(uint16_t min_sps, uint16_t max_sps);
+bool config_is_valid_belt_teeth(uint8_t teeth);
 bool config_is_valid_rotation_angle(uint16_t angle);
 bool config_is_valid_photo_interval(uint8_t interval);
 
 // 配置字符串转换函数（用于显示）
 const char* config_get_motor_direction_string(void);
+const char* config_get_motion_profile_string(void);
 const char* config_get_rotation_angle_string(void);
 
 #endif // CONFIG_H
@@ -22,11 +22,29 @@
 
 #define VOLTAGE_SENSOR_PIN PC2
 
+// 电机电流采样（ULN2003公共地串联采样电阻），未安装时CURRENT_SENSE_ENABLED设为0
+#define CURRENT_SENSE_PIN PC3
+#define CURRENT_SENSE_ADC_CHANNEL 3
+#define CURRENT_SENSE_ENABLED 0
+
 #define STEP_MOTOR_INT1_PIN PE0
 #define STEP_MOTOR_INT2_PIN PE1
 #define STEP_MOTOR_INT3_PIN PE2
 #define STEP_MOTOR_INT4_PIN PE3
 
+// 相机俯仰轴电机（第二个28BYJ-48），4个线圈引脚需在同一端口上连续排列
+#define TILT_MOTOR_INT1_PIN PB2
+#define TILT_MOTOR_INT2_PIN PB3
+#define TILT_MOTOR_INT3_PIN PB4
+#define TILT_MOTOR_INT4_PIN PB5
+
+// 转台原点/索引传感器（霍尔传感器或限位开关，触发时拉低），未安装时HOME_SENSOR_ENABLED设为0（可由编译选项覆盖）
+#define HOME_SENSOR_PIN 5 //PD5
+#define HOME_SENSOR_ACTIVE_LEVEL LOW
+#ifndef HOME_SENSOR_ENABLED
+#define HOME_SENSOR_ENABLED 0
+#endif
+
 // to detect if camera control cable has been plugged in, if plugged then it should be LOW, the pin should be INPUT_PULLUP
 #define CAMERA_TRIGGER_SENSOR_PIN PD2
 #define CAMERA_SHUTTER_TRIGGER_PIN PC0
@@ -37,6 +55,8 @@
 
 // 拍照模式时间配置
 #define PHOTO_PRE_SHUTTER_SETTLE_TIME   1000  // 快门前停留时间（毫秒）
+#define PHOTO_PRE_SHUTTER_SETTLE_TIME_SCURVE  500  // S曲线旋转后快门前停留时间（毫秒），无加速度突变，晃动更小
 #define PHOTO_POST_SHUTTER_SETTLE_TIME  3500  // 快门后停留时间（毫秒）
+#define PHOTO_HOLD_DUTY_PERCENT         30    // 停留拍摄期间的减流保持占空比（%）
 
 #endif // HAL_H
@@ -5,20 +5,14 @@
 #include "config.h"
 #include "camera.h"
 #include "stepper_motor.h"
+#include "stepper_home.h"
 #include "buzzer.h"
 #include "ui_display.h"
 
-// 角度补偿参数
-// 每次启停会因机械阻力和惯性损失约0.5-1度
-// 使用十倍整数法避免浮点运算：7 = 0.7度, 10 = 1.0度, 15 = 1.5度
-// 全步模式：0.7度 ≈ 3.98步 ≈ 4步, 1度 ≈ 5.69步 ≈ 6步
-// 半步模式：0.7度 ≈ 7.96步 ≈ 8步, 1度 ≈ 11.38步 ≈ 11步
-#define ANGLE_COMPENSATION_BASE 0                       // 基础补偿步数
-#define ANGLE_COMPENSATION_PER_STOP_DEGREES_X10 7      // 每次暂停补偿角度×10 (7=0.7度)
-
 // 拍照模式状态枚举
 typedef enum {
     PHOTO_STATE_IDLE = 0,           // 空闲状态
+    PHOTO_STATE_HOMING,             // 归零到索引
     PHOTO_STATE_COUNTDOWN,          // 倒计时状态
     PHOTO_STATE_FOCUS,              // 对焦状态
     PHOTO_STATE_PRE_FIRST_SHOT,     // 第一张照片前停留
@@ -28,6 +22,7 @@ typedef enum {
     PHOTO_STATE_PRE_SHOOTING,       // 拍摄前停留
     PHOTO_STATE_SHOOTING,           // 拍摄照片
     PHOTO_STATE_POST_SHOOTING,      // 拍摄后停留
+    PHOTO_STATE_RETURNING,          // 快速回原点
     PHOTO_STATE_COMPLETE,           // 完成状态
     PHOTO_STATE_STOPPED             // 停止状态
 } photo_state_t;
@@ -50,11 +45,9 @@ typedef struct {
     uint16_t angle_per_photo;
 
     // 电机控制相关
-    uint32_t steps_per_photo;
+    uint32_t angle_carry;                // 角度换算余数（带到下一次旋转，累计步数不漂移）
     uint32_t total_steps_moved;
-    uint32_t per_rotation_compensation;  // 每次旋转的启停补偿步数
-    uint32_t final_compensation;         // 最后一次复位的累积补偿步数
-    uint32_t remaining_steps;            // 累积精度误差补偿步数
+    bool rotation_done;                  // 本次旋转的结束事件已到达
 
     // 相机触发相关
     unsigned long focus_start_time;
@@ -76,6 +69,7 @@ bool photo_mode_is_running(void);
 photo_state_t photo_mode_get_state(void);
 
 // 状态处理函数
+void photo_mode_handle_homing(void);
 void photo_mode_handle_countdown(void);
 void photo_mode_handle_focus(void);
 void photo_mode_handle_pre_first_shot(void);
@@ -86,6 +80,8 @@ void photo_mode_handle_pre_shooting(void);
 void photo_mode_handle_shooting(void);
 void photo_mode_handle_post_shooting(void);
 void photo_mode_handle_complete(void);
+void photo_mode_handle_stall(void);
+void photo_mode_handle_event(uint8_t events);
 
 // 辅助函数
 void photo_mode_calculate_parameters(void);
@@ -93,12 +89,12 @@ void photo_mode_start_countdown(void);
 void photo_mode_trigger_focus(void);
 void photo_mode_trigger_shutter(void);
 void photo_mode_start_rotation(void);
+void photo_mode_start_return(void);
 void photo_mode_finish_session(void);
 void photo_mode_update_display(void);
 
 // 角度和步数转换函数
 uint32_t photo_mode_angle_to_steps(uint16_t angle);
-uint32_t photo_mode_angle_to_steps_x10(uint16_t angle_x10);  // 十倍精度版本 (angle_x10单位: 0.1度)
 uint16_t photo_mode_steps_to_angle(uint32_t steps);
 
 #endif // PHOTO_MODE_H
@@ -4,6 +4,7 @@
 #include <Arduino.h>
 #include "config.h"
 #include "stepper_motor.h"
+#include "stepper_home.h"
 #include "buzzer.h"
 #include "ui_display.h"
 
@@ -28,8 +29,8 @@ typedef struct {
     // 运行统计
     unsigned long start_time;
     unsigned long total_runtime;
-    uint32_t total_steps;
-    float total_turns;
+    uint32_t total_turns;       // 已完成的整圈数
+    uint8_t turn_hundredths;    // 当前圈已转过的百分之一圈数（0-99）
     
     // 显示更新
     unsigned long last_display_update;
@@ -47,6 +48,8 @@ scan_state_t scan_mode_get_state(void);
 // 状态处理函数
 void scan_mode_handle_countdown(void);
 void scan_mode_handle_running(void);
+void scan_mode_handle_stall(void);
+void scan_mode_handle_event(uint8_t events);
 
 // 辅助函数
 void scan_mode_start_countdown(void);
@@ -55,7 +58,7 @@ void scan_mode_update_statistics(void);
 void scan_mode_update_display(void);
 
 // 统计计算函数
-float scan_mode_calculate_turns(void);
+uint32_t scan_mode_calculate_turns(void);
 unsigned long scan_mode_get_elapsed_seconds(void);
 
 #endif // SCAN_MODE_H
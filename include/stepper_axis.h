@@ -0,0 +1,43 @@
+#ifndef STEPPER_AXIS_H
+#define STEPPER_AXIS_H
+
+#include <Arduino.h>
+#include "hal.h"
+#include "stepper_coil.h"
+
+// 运动轴编号
+// 旋转轴由stepper_motor驱动（加减速、队列、细分等全部功能），其余为辅助轴：
+// 半步或全步驱动，只在联动运动中由同一个Timer1中断按Bresenham直线插补步进
+#define STEPPER_AXIS_ROTATION  0   // 转台旋转轴（PE0-PE3）
+#define STEPPER_AXIS_TILT      1   // 相机俯仰轴（PB2-PB5）
+#define STEPPER_AXIS_COUNT     2
+
+// 旋转轴步进中断内使用的线圈驱动（端口需与hal.h中的引脚一致，INT1-INT4在同一端口上连续排列）
+typedef stepper_coil_driver<stepper_port_e, STEP_MOTOR_INT1_PIN, stepper_sequence_half> stepper_rotation_coils;
+typedef stepper_coil_driver<stepper_port_e, STEP_MOTOR_INT1_PIN, stepper_sequence_full> stepper_rotation_full_coils;
+
+// 轴实例：引脚绑定、线圈序列和位置，按轴编号存放在数组中
+// 旋转轴的实例只提供引脚绑定（stepper_axis_write），序列位置、步进模式和绝对位置由stepper_motor维护；
+// 辅助轴的序列位置以半步序列下标计，全步模式每步跨两个下标并停在双线圈组合上
+typedef struct {
+    volatile uint8_t* port;     // 线圈所在端口
+    volatile uint8_t* ddr;      // 端口方向寄存器
+    uint8_t shift;              // INT1所在位号（INT1-INT4连续）
+    bool auxiliary;             // 是否为辅助轴（联动时由本模块步进，结束后断电）
+    uint8_t step_mode;          // 步进模式（辅助轴只支持STEP_MODE_HALF/STEP_MODE_FULL）
+    int8_t current_step;        // 半步序列位置
+    int32_t position;           // 绝对位置（步，单位随step_mode，正方向为INT1→INT4）
+} stepper_axis_t;
+
+// 函数声明
+void stepper_axis_init();
+void stepper_axis_write(uint8_t axis, uint8_t step_pattern);
+void stepper_axis_release(uint8_t axis);
+void stepper_axis_release_auxiliary();
+void stepper_axis_step(uint8_t axis, bool forward);
+void stepper_axis_set_step_mode(uint8_t axis, uint8_t mode);
+uint8_t stepper_axis_get_step_mode(uint8_t axis);
+int32_t stepper_axis_get_position(uint8_t axis);
+void stepper_axis_set_position(uint8_t axis, int32_t position);
+
+#endif // STEPPER_AXIS_H
@@ -0,0 +1,86 @@
+#ifndef STEPPER_COIL_H
+#define STEPPER_COIL_H
+
+#include <Arduino.h>
+
+// 线圈驱动模板
+// 端口、起始引脚和线圈序列都是模板参数，序列预先移位到引脚位置存成表，
+// 每步只做一次"读端口-清4位-或入表项-写端口"，4个线圈同时切换，中间没有全部断电的毛刺。
+// 调用方需保证与同一端口上其他中断写入互斥（步进中断内天然满足，主循环调用需关中断）。
+
+#define STEP_SEQUENCE_LENGTH_HALF 8     // 半步序列长度
+#define STEP_SEQUENCE_LENGTH_FULL 4     // 全步序列长度
+
+// 28BYJ-48 半步序列 (8步，平滑但扭矩较小)：0001 0011 0010 0110 0100 1100 1000 1001
+struct stepper_sequence_half {
+    static const uint8_t length = STEP_SEQUENCE_LENGTH_HALF;
+    static constexpr uint8_t pattern(uint8_t index) {
+        return (index & 0x01) ? (uint8_t)((1 << ((index >> 1) & 0x03)) | (1 << (((index >> 1) + 1) & 0x03)))
+                              : (uint8_t)(1 << ((index >> 1) & 0x03));
+    }
+};
+
+// 28BYJ-48 全步序列 (4步，扭矩更大)：两个相邻线圈同时通电，即半步序列的奇数步
+struct stepper_sequence_full {
+    static const uint8_t length = STEP_SEQUENCE_LENGTH_FULL;
+    static constexpr uint8_t pattern(uint8_t index) {
+        return stepper_sequence_half::pattern((uint8_t)(((index & 0x03) << 1) + 1));
+    }
+};
+
+// 端口描述：以内联访问函数返回寄存器，优化后就是一条固定地址的in/out指令
+struct stepper_port_b {
+    static volatile uint8_t& port() { return PORTB; }
+    static volatile uint8_t& ddr() { return DDRB; }
+};
+
+struct stepper_port_e {
+    static volatile uint8_t& port() { return PORTE; }
+    static volatile uint8_t& ddr() { return DDRE; }
+};
+
+// 驱动：Port为端口描述，Shift为INT1所在位号（INT1-INT4连续），Sequence为线圈序列
+template<typename Port, uint8_t Shift, typename Sequence>
+struct stepper_coil_driver {
+    static_assert(Shift <= 4, "coil pins INT1-INT4 must fit in one 8-bit port");
+
+    static const uint8_t mask = (uint8_t)(0x0F << Shift);
+
+    // 按序列位置预先移位好的端口值
+    static constexpr uint8_t table[STEP_SEQUENCE_LENGTH_HALF] = {
+        (uint8_t)(Sequence::pattern(0 % Sequence::length) << Shift),
+        (uint8_t)(Sequence::pattern(1 % Sequence::length) << Shift),
+        (uint8_t)(Sequence::pattern(2 % Sequence::length) << Shift),
+        (uint8_t)(Sequence::pattern(3 % Sequence::length) << Shift),
+        (uint8_t)(Sequence::pattern(4 % Sequence::length) << Shift),
+        (uint8_t)(Sequence::pattern(5 % Sequence::length) << Shift),
+        (uint8_t)(Sequence::pattern(6 % Sequence::length) << Shift),
+        (uint8_t)(Sequence::pattern(7 % Sequence::length) << Shift)
+    };
+
+    // 引脚设为输出并断电
+    static inline void init() {
+        Port::ddr() |= mask;
+        Port::port() &= (uint8_t)~mask;
+    }
+
+    // 输出序列第index步（0 ~ Sequence::length-1）
+    static inline void write(uint8_t index) {
+        Port::port() = (Port::port() & (uint8_t)~mask) | table[index];
+    }
+
+    // 输出任意线圈组合（bit0-3对应INT1-INT4）
+    static inline void write_pattern(uint8_t step_pattern) {
+        Port::port() = (Port::port() & (uint8_t)~mask) | (uint8_t)((step_pattern & 0x0F) << Shift);
+    }
+
+    // 断开所有线圈
+    static inline void release() {
+        Port::port() &= (uint8_t)~mask;
+    }
+};
+
+template<typename Port, uint8_t Shift, typename Sequence>
+constexpr uint8_t stepper_coil_driver<Port, Shift, Sequence>::table[STEP_SEQUENCE_LENGTH_HALF];
+
+#endif // STEPPER_COIL_H
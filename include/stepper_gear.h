@@ -0,0 +1,49 @@
+#ifndef STEPPER_GEAR_H
+#define STEPPER_GEAR_H
+
+#include <Arduino.h>
+
+// 精确减速比
+// 28BYJ-48转子每转32全步，减速箱为(32/9)×(22/11)×(26/9)×(31/10) = 25792/405 ≈ 63.684，
+// 输出轴每转 32×25792/405 = 825344/405 ≈ 2037.886 全步，而不是常用的2048。
+// 每转步数以约分后的分数保存，角度与步数的换算只用32位整数，余数带到下一次换算，连续多圈不累积误差。
+
+#define STEPPER_GEAR_FULL_STEPS_NUM  825344UL   // 输出轴每转全步数（分子）
+#define STEPPER_GEAR_FULL_STEPS_DEN  405UL      // 输出轴每转全步数（分母）
+
+// 转台皮带/齿轮的齿数上限：分子需小于2^31（16细分 × 825344 × 160 ≈ 2.1×10^9）
+#define STEPPER_GEAR_TEETH_MAX       160
+
+// 转台每转步数 = num / den（约分后）
+typedef struct {
+    uint32_t num;
+    uint32_t den;
+} stepper_gear_ratio_t;
+
+// 累计转动量 = turns + offset/num 圈（offset以1/den步为单位，0 ~ num-1）
+// 圈数和圈内偏移分开保存，不会像"步数×360"那样溢出；32位圈数在最高速度下可以累计数百年
+typedef struct {
+    uint32_t turns;
+    uint32_t offset;
+} stepper_gear_travel_t;
+
+// 函数声明
+uint32_t stepper_gear_muldiv(uint32_t a, uint32_t b, uint32_t c, uint32_t* remainder);
+void stepper_gear_make_ratio(stepper_gear_ratio_t* ratio, uint8_t units_per_full, uint8_t driven_teeth, uint8_t drive_teeth);
+uint32_t stepper_gear_steps_per_revolution(const stepper_gear_ratio_t* ratio);
+
+// 角度（度）与步数换算
+uint32_t stepper_gear_carry_init(const stepper_gear_ratio_t* ratio);
+uint32_t stepper_gear_degrees_to_steps(const stepper_gear_ratio_t* ratio, uint32_t degrees, uint32_t* carry);
+uint32_t stepper_gear_steps_to_degrees(const stepper_gear_ratio_t* ratio, uint32_t steps);
+
+// 绝对位置与圈数换算
+int32_t stepper_gear_revolution_of(const stepper_gear_ratio_t* ratio, int32_t position, uint32_t* fraction);
+int32_t stepper_gear_angle_position(const stepper_gear_ratio_t* ratio, int32_t revolution, uint16_t degrees);
+
+// 累计转动量
+void stepper_gear_travel_add(const stepper_gear_ratio_t* ratio, stepper_gear_travel_t* travel, uint32_t steps);
+void stepper_gear_travel_rescale(const stepper_gear_ratio_t* from, const stepper_gear_ratio_t* to, stepper_gear_travel_t* travel);
+uint32_t stepper_gear_travel_fraction(const stepper_gear_ratio_t* ratio, const stepper_gear_travel_t* travel, uint32_t scale);
+
+#endif // STEPPER_GEAR_H
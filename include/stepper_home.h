@@ -0,0 +1,48 @@
+#ifndef STEPPER_HOME_H
+#define STEPPER_HOME_H
+
+#include <Arduino.h>
+#include "hal.h"
+#include "stepper_motor.h"
+
+// 原点/索引传感器
+// 转台上的磁铁经过霍尔传感器（或挡片触发限位开关）时产生一个索引信号，每转一次。
+// 归零：先快速寻找索引，反向退出到传感器释放（再留一点余量）后慢速逼近，以慢速触发的边沿作为原点（位置0）。
+// 跟踪：扫描/拍摄过程中每次沿同一方向经过索引，都按索引的已知位置修正绝对位置，丢步和每转步数误差不再累积。
+
+#define STEPPER_HOME_FAST_MS            2       // 快速寻找速度（每全步毫秒数）
+#define STEPPER_HOME_SLOW_MS            12      // 慢速逼近速度（每全步毫秒数）
+#define STEPPER_HOME_BACKOFF_MARGIN_DEGREES 3   // 反向退出到传感器释放后再多退的角度
+#define STEPPER_HOME_DEBOUNCE_DIVISOR   8       // 距上次索引不足1/8圈的边沿视为抖动
+#define STEPPER_HOME_MAX_CORRECTION_DIVISOR 16  // 单次修正超过1/16圈视为误触发，不修正
+
+// 归零状态
+typedef enum {
+    HOME_STATE_IDLE = 0,        // 未归零
+    HOME_STATE_SEEK_FAST,       // 快速寻找索引
+    HOME_STATE_BACKOFF,         // 反向退出索引
+    HOME_STATE_SEEK_SLOW,       // 慢速逼近索引
+    HOME_STATE_CENTER,          // 回到索引边沿
+    HOME_STATE_DONE,            // 已归零
+    HOME_STATE_FAILED           // 转过一圈仍未找到索引
+} home_state_t;
+
+// 索引误差计算（纯计算，可在主机上用模拟的索引位置序列测试）
+int32_t stepper_home_index_error(int32_t captured, int32_t reference, const stepper_gear_ratio_t* ratio);
+
+// 函数声明
+void stepper_home_init();
+void stepper_home_update();
+bool stepper_home_start(motor_direction_t direction);
+void stepper_home_cancel();
+home_state_t stepper_home_get_state();
+bool stepper_home_is_busy();
+bool stepper_home_is_triggered();
+
+// 索引跟踪函数
+void stepper_home_enable_tracking(bool enable);
+void stepper_home_clear_reference();
+int32_t stepper_home_get_last_error();
+uint16_t stepper_home_get_correction_count();
+
+#endif // STEPPER_HOME_H
@@ -0,0 +1,28 @@
+#ifndef STEPPER_MICROSTEP_H
+#define STEPPER_MICROSTEP_H
+
+#include <Arduino.h>
+
+// 正弦细分驱动参数 (Timer3, CTC模式, 不分频)
+// PWM时隙中断32kHz，每个PWM周期32个时隙，线圈PWM频率1kHz，占空比分辨率1/32
+#define STEPPER_PWM_SLOT_FREQ      32000UL
+#define STEPPER_PWM_LEVELS         32
+
+// 电角度分辨率：每全步16个相位单位，一个电周期（4全步）共64个相位
+#define STEPPER_MICROSTEP_PHASES_PER_FULL  16
+#define STEPPER_MICROSTEP_PHASES           (STEPPER_MICROSTEP_PHASES_PER_FULL * 4)
+
+// 支持的细分数（每全步微步数）
+#define STEPPER_MICROSTEP_MIN      4
+#define STEPPER_MICROSTEP_MAX      16
+#define STEPPER_MICROSTEP_DEFAULT  8
+
+// 函数声明
+void stepper_microstep_init();
+bool stepper_microstep_is_valid_resolution(uint8_t microsteps);
+void stepper_microstep_set_phase(uint8_t phase, uint8_t amplitude);
+void stepper_microstep_hold_pattern(uint8_t step_pattern, uint8_t duty);
+void stepper_microstep_release();
+uint8_t stepper_microstep_get_duty(uint8_t coil);
+
+#endif // STEPPER_MICROSTEP_H
@@ -2,14 +2,60 @@
 #define STEPPER_MOTOR_H
 
 #include "hal.h"
+#include "stepper_axis.h"
+#include "stepper_gear.h"
 
 // 步进电机参数定义
-// #define STEPS_PER_REVOLUTION_HALF 4076  // 28BYJ-48 每转步数 (半步模式)
-// #define STEPS_PER_REVOLUTION_FULL 2038  // 28BYJ-48 每转步数 (全步模式)
-#define STEPS_PER_REVOLUTION_HALF 4096  // 28BYJ-48 每转步数 (半步模式)
-#define STEPS_PER_REVOLUTION_FULL 2048  // 28BYJ-48 每转步数 (全步模式)
-#define STEP_SEQUENCE_LENGTH_HALF 8     // 半步序列长度
-#define STEP_SEQUENCE_LENGTH_FULL 4     // 全步序列长度
+// 每转步数由精确减速比（stepper_gear.h，825344/405 ≈ 2037.886全步）和转台皮带齿数比计算
+
+// 步进定时器参数 (Timer1, CTC模式, 64分频)
+// 16MHz / 64 = 250kHz，每个tick为4μs，16位比较寄存器最长可表示262ms间隔
+#define STEPPER_TIMER_PRESCALER   64
+#define STEPPER_TIMER_FREQ        (F_CPU / STEPPER_TIMER_PRESCALER)
+#define STEPPER_TICKS_PER_MS      (STEPPER_TIMER_FREQ / 1000UL)
+#define STEPPER_US_TO_TICKS(us)   ((uint16_t)((us) / (1000000UL / STEPPER_TIMER_FREQ)))
+
+// 步/秒速度范围（stepper_motor_set_speed_sps）
+// 上限为28BYJ-48在5V下可靠起步的速度，下限由16位比较寄存器决定（250kHz / 65535）
+#define STEPPER_MAX_SPEED_SPS     1000
+#define STEPPER_MIN_SPEED_SPS     4
+
+// 运动段队列中单个转动段的最大步数（联动运动的各轴步数为int）
+#define STEPPER_QUEUE_MAX_MOVE_STEPS  32767
+
+// 绝对位置回绕阈值：超过后由主循环减去整数圈（num步 = den圈），连续转动多日也不溢出int32
+#define STEPPER_POSITION_WRAP     0x40000000L
+
+// 自动步进模式的驱动切换点（全步/秒，带回差）
+// 高于ENTER切换为全步驱动获得更大扭矩，低于EXIT回到半步驱动保证平滑
+#define STEPPER_AUTO_FULL_ENTER_SPS  320
+#define STEPPER_AUTO_FULL_EXIT_SPS   260
+
+// 齿轮间隙补偿：换向后以固定全步速率空转（2ms/全步，无需加速即可可靠起步）
+#define STEPPER_BACKLASH_FULL_STEP_TICKS  STEPPER_US_TO_TICKS(2000)
+
+// 供电电压调速：按电压→最高转速/加速度曲线（分段线性插值）限制步进速率，电压低时28BYJ-48的牵出扭矩下降，
+// 超过曲线的速度会悄悄丢步。曲线点按电压升序排列，低于第一点按第一点、高于最后一点按最后一点限制
+#define STEPPER_GOVERNOR_POINTS   4
+#define STEPPER_GOVERNOR_MIN_MV   1000  // 低于此电压视为未接电压检测，不限制
+
+// 线圈温升模型（一阶I²R热模型，温升指高于环境温度的度数，上电时假设电机处于环境温度）
+// 稳态温升与线圈通电量成正比：持续通电1个线圈对应RISE_PER_COIL，全步运转为2个线圈，半步平均1.5个
+#define STEPPER_THERMAL_RISE_PER_COIL   30      // 每个线圈持续通电的稳态温升（°C）
+#define STEPPER_THERMAL_TAU_S           900     // 热时间常数（秒）
+#define STEPPER_THERMAL_DERATE_RISE     40      // 温升超过此值时降速（°C）
+#define STEPPER_THERMAL_DWELL_RISE      45      // 温升超过此值时在拍照旋转之间插入冷却停留（°C）
+#define STEPPER_THERMAL_RESUME_RISE     35      // 降温到此值以下时恢复（°C）
+#define STEPPER_THERMAL_DERATE_FSPS     250     // 降速后的最高转速（全步/秒），低于自动模式的全步切换点
+#define STEPPER_THERMAL_PERIOD_MS       1000    // 热模型积分周期（毫秒）
+#define STEPPER_THERMAL_MAX_GAP_MS      60000   // 两次采样间隔的上限（毫秒），主循环长时间阻塞时按此计，防止积分溢出
+
+// 减流保持：运动结束后以PWM占空比保持最后的线圈组合，超时后断电
+#define STEPPER_HOLD_MAX_DUTY     100   // 占空比上限（%）
+
+// 起步预励磁：线圈断电或减流保持后开始运动时，先以满电流输出当前相位锁定转子，再发出第一步
+#define STEPPER_LOCK_IN_MS        30    // 默认锁定时间（毫秒）
+#define STEPPER_LOCK_IN_MAX_MS    200   // 锁定时间上限（单独占一个比较周期，不超过16位比较寄存器）
 
 // 转动方向定义
 typedef enum {
@@ -26,39 +72,109 @@ typedef enum {
 // 步进模式定义
 typedef enum {
     STEP_MODE_HALF = 0,    // 半步模式（平滑，扭矩较小）
-    STEP_MODE_FULL = 1     // 全步模式（扭矩大）
+    STEP_MODE_FULL = 1,    // 全步模式（扭矩大）
+    STEP_MODE_MICRO = 2,   // 正弦细分模式（PWM驱动线圈，最平滑，细分数可设）
+    STEP_MODE_AUTO = 3     // 自动模式（位置以半步为单位，低速半步驱动，高速自动切换为全步驱动）
 } step_mode_t;
 
+// 速度曲线类型
+typedef enum {
+    PROFILE_TRAPEZOID = 0,  // 梯形曲线（加速度突变）
+    PROFILE_SCURVE = 1      // 7段S曲线（加速度连续变化，jerk受限）
+} motion_profile_t;
+
 // 步进电机状态结构体
 typedef struct {
     int current_step;           // 当前步数位置
     motor_direction_t direction; // 转动方向
     motor_speed_t speed;        // 转动速度
     step_mode_t step_mode;      // 步进模式
+    uint8_t microsteps;         // 细分模式下每全步的微步数（4/8/16）
     bool is_running;            // 是否正在运行
-    unsigned long last_step_time; // 上次步进时间
-    int target_steps;           // 目标步数
-    int remaining_steps;        // 剩余步数
+    uint16_t step_interval;     // 当前步进间隔（定时器tick）
+    int32_t target_steps;       // 目标步数
+    int32_t remaining_steps;    // 剩余步数（-1表示连续转动）
+    int32_t position;           // 绝对位置（步，顺时针为正，单位随步进模式）
 } stepper_motor_t;
 
 // 函数声明
 void stepper_motor_init();
 void stepper_motor_set_speed(motor_speed_t speed);
 void stepper_motor_set_custom_speed(uint8_t delay_ms);
+void stepper_motor_set_speed_sps(uint32_t sps_q8);
+void stepper_motor_set_angular_speed(uint16_t deg_per_s_x10);
 void stepper_motor_set_direction(motor_direction_t direction);
+motor_direction_t stepper_motor_get_direction();
 void stepper_motor_set_step_mode(step_mode_t mode);
+void stepper_motor_set_microsteps(uint8_t microsteps);
+void stepper_motor_set_backlash(uint8_t full_steps);
+void stepper_motor_set_resonance_band(uint8_t index, uint16_t min_full_sps, uint16_t max_full_sps);
+uint8_t stepper_motor_get_backlash();
 void stepper_motor_rotate_angle(float angle);
-void stepper_motor_rotate_steps(int steps);
+void stepper_motor_rotate_steps(int32_t steps);
 void stepper_motor_start();
 void stepper_motor_stop();
+void stepper_motor_halt();
+void stepper_motor_set_hold(uint8_t duty_percent, uint16_t timeout_ms);
+void stepper_motor_hold();
+void stepper_motor_release();
+bool stepper_motor_is_holding();
+void stepper_motor_set_lock_in(uint16_t lock_in_ms);
+
+// 供电电压调速函数
+void stepper_motor_set_supply_voltage(uint16_t millivolts);
+void stepper_motor_set_governor_point(uint8_t index, uint16_t millivolts, uint16_t max_full_sps, uint16_t max_full_accel);
+uint16_t stepper_motor_get_governor_limit();
+
+// 线圈温升函数
+uint16_t stepper_motor_get_temperature_rise();
+bool stepper_motor_needs_cooldown();
+
+// 堵转检测函数（需要电流采样电阻，堵转以STEPPER_EVENT_STALL事件通知）
+void stepper_motor_enable_stall_detection(bool enable);
+
+// 运动事件（中断中置位，主循环的stepper_motor_update()合并为位掩码后调用回调）
+#define STEPPER_EVENT_MOVE_DONE   0x01  // 运动结束：到达目标步数、队列执行完或停止完成（stepper_motor_halt()不产生）
+#define STEPPER_EVENT_CRUISE      0x02  // 加速完成，进入巡航
+#define STEPPER_EVENT_STALL       0x04  // 堵转
+typedef void (*stepper_event_callback_t)(uint8_t events);
+void stepper_motor_set_event_callback(stepper_event_callback_t callback);
+
+// 运动段队列函数（由Timer1中断直接消费，段间无主循环延迟）
+bool stepper_motor_queue_move(uint32_t steps, motion_profile_t profile);
+bool stepper_motor_queue_dwell(uint32_t dwell_us);
+bool stepper_motor_queue_direction(motor_direction_t direction);
+void stepper_motor_queue_clear();
+uint8_t stepper_motor_queue_free();
+void stepper_motor_set_acceleration(uint16_t acceleration);
+uint16_t stepper_motor_get_acceleration();
+void stepper_motor_set_jerk(uint16_t jerk);
+void stepper_motor_set_motion_profile(motion_profile_t profile);
+motion_profile_t stepper_motor_get_motion_profile();
 void stepper_motor_update();
 bool stepper_motor_is_running();
 step_mode_t stepper_motor_get_step_mode();
-uint32_t stepper_motor_get_step_count();
+void stepper_motor_get_travel(stepper_gear_travel_t* travel);
 void stepper_motor_reset_step_count();
 uint32_t stepper_motor_get_current_rotation_steps();
 uint16_t stepper_motor_get_current_angle();
 
+// 绝对位置函数
+int32_t stepper_motor_get_position();
+void stepper_motor_set_position(int32_t position);
+void stepper_motor_adjust_position(int32_t delta);
+void stepper_motor_set_home();
+uint32_t stepper_motor_get_steps_per_revolution();
+void stepper_motor_get_gear_ratio(stepper_gear_ratio_t* ratio);
+void stepper_motor_set_belt_ratio(uint8_t driven_teeth, uint8_t drive_teeth);
+uint32_t stepper_motor_get_position_in_revolution();
+int32_t stepper_motor_get_shortest_offset(uint32_t target_in_revolution);
+void stepper_motor_move_to(uint16_t angle);
+void stepper_motor_move_to_position(int32_t position);
+
+// 多轴联动函数（各轴沿Bresenham直线同时到达，耗时取决于步数最多的轴）
+void stepper_motor_move_axes(const int steps[STEPPER_AXIS_COUNT]);
+
 // 扭矩优化函数
 void stepper_motor_enable_high_torque();
 void stepper_motor_disable_high_torque();
@@ -0,0 +1,37 @@
+#ifndef STEPPER_QUEUE_H
+#define STEPPER_QUEUE_H
+
+#include <Arduino.h>
+#include "stepper_motor.h"
+
+// 运动段队列长度（必须为2的幂，实际可存放长度-1段）
+#define STEPPER_QUEUE_SIZE  8
+#define STEPPER_QUEUE_MASK  (STEPPER_QUEUE_SIZE - 1)
+
+static_assert((STEPPER_QUEUE_SIZE & STEPPER_QUEUE_MASK) == 0, "STEPPER_QUEUE_SIZE must be a power of two");
+
+// 运动段类型
+typedef enum {
+    MOTION_SEGMENT_MOVE = 0,    // 按指定速度曲线转动N步
+    MOTION_SEGMENT_DWELL,       // 原地停留T微秒（线圈保持通电）
+    MOTION_SEGMENT_DIRECTION    // 切换转动方向
+} motion_segment_type_t;
+
+// 运动段
+typedef struct {
+    uint8_t type;       // motion_segment_type_t
+    uint8_t arg;        // MOVE: motion_profile_t；DIRECTION: 1顺时针，0逆时针
+    uint32_t value;     // MOVE: 步数；DWELL: 微秒
+} motion_segment_t;
+
+// 函数声明
+// 单生产者（主循环）/单消费者（Timer1中断）：push只在主循环调用，
+// pop/peek只在中断中调用（电机空闲、定时器停止时可在ATOMIC_BLOCK内调用）
+bool stepper_queue_push(const motion_segment_t* segment);
+bool stepper_queue_pop(motion_segment_t* segment);
+bool stepper_queue_peek(uint8_t index, motion_segment_t* segment);
+void stepper_queue_clear();
+uint8_t stepper_queue_count();
+uint8_t stepper_queue_free();
+
+#endif // STEPPER_QUEUE_H
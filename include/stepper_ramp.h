@@ -0,0 +1,114 @@
+#ifndef STEPPER_RAMP_H
+#define STEPPER_RAMP_H
+
+#include <Arduino.h>
+#include "stepper_motor.h"
+
+// 加减速参数
+// 加速度单位：步/秒²（步的含义随当前步进模式：全步或半步）
+#define STEPPER_DEFAULT_ACCELERATION  2000
+#define STEPPER_MIN_ACCELERATION      100
+#define STEPPER_MAX_ACCELERATION      20000
+
+// S曲线加加速度（jerk）参数，单位：步/秒³
+// 默认值下加速度从0升到2000步/秒²需要0.1秒
+#define STEPPER_DEFAULT_JERK          20000
+#define STEPPER_MIN_JERK              1000
+#define STEPPER_MAX_JERK              50000
+
+// AVR446: c0 = 0.676 × f × sqrt(2 / a)
+// 预先计算 (0.676² × 2 × f²) / 16，保证在32位范围内，c0 = 4 × sqrt(常数 / a)
+#define STEPPER_RAMP_C0_SQ_DIV16 \
+    ((uint32_t)(913952ULL * (STEPPER_TIMER_FREQ / 1000ULL) * (STEPPER_TIMER_FREQ / 1000ULL) / 16ULL))
+
+// 无限步数（连续转动时不规划减速点）
+#define STEPPER_RAMP_UNLIMITED  0xFFFFFFFFUL
+
+// 共振禁区个数
+#define STEPPER_RAMP_MAX_BANDS  2
+
+// S曲线分段
+typedef enum {
+    SCURVE_JERK_UP = 0,     // 加速度上升
+    SCURVE_CONST_ACCEL,     // 匀加速
+    SCURVE_JERK_DOWN,       // 加速度回落到0
+    SCURVE_CRUISE,          // 匀速
+    SCURVE_DECEL_JERK_IN,   // 减速度上升
+    SCURVE_CONST_DECEL,     // 匀减速
+    SCURVE_DECEL_JERK_OUT   // 减速度回落到0
+} scurve_segment_t;
+
+// 加减速阶段
+typedef enum {
+    RAMP_STOP = 0,      // 停止
+    RAMP_ACCEL,         // 加速
+    RAMP_RUN,           // 匀速巡航
+    RAMP_DECEL          // 减速
+} ramp_phase_t;
+
+// 梯形加减速状态（AVR446整数算法）
+typedef struct {
+    ramp_phase_t phase;         // 当前阶段
+    uint16_t step_delay;        // 当前步进间隔（tick）
+    uint16_t min_delay;         // 巡航步进间隔（tick）整数部分
+    uint8_t cruise_frac;        // 巡航步进间隔小数部分（1/256 tick）
+    uint8_t cruise_phase;       // 巡航小数相位累加器（DDA）
+    uint16_t c0;                // 第一步间隔（tick），由加速度决定
+    uint16_t last_accel_delay;  // 进入巡航前的最后一个加速间隔
+    uint16_t acceleration;      // 加速度（步/秒²）
+    int32_t accel_count;        // AVR446中的n，负数表示减速剩余步数
+    int32_t decel_val;          // 开始减速时赋给accel_count的值
+    int32_t rest;               // 除法余数，累积到下一步以消除截断误差
+    uint32_t step_count;        // 本次运动已走步数
+    uint32_t decel_start;       // 开始减速的步数
+
+    // 查表模式（默认加速度+速度预设时使用编译期加速表，热路径无乘除法）
+    bool use_table;             // 是否使用加速表
+    const uint16_t* table;      // Flash中的加速表
+    uint8_t table_len;          // 本次运动的加速步数
+    uint8_t table_limit;        // 加速到巡航速度需要的表项数（短距离运动table_len小于它）
+    uint8_t table_index;        // 当前表下标
+
+    // S曲线状态（速度为Q4定点数：步/秒×16）
+    motion_profile_t profile;   // 速度曲线类型
+    scurve_segment_t segment;   // 当前S曲线分段
+    uint16_t jerk;              // 加加速度（步/秒³）
+    uint16_t peak_accel;        // 本次运动的峰值加速度（步/秒²）
+    int32_t accel_now;          // 当前加速度（步/秒²）
+    uint32_t velocity;          // 当前速度（Q4）
+    uint32_t peak_velocity;     // 巡航速度（Q4）
+    uint32_t floor_velocity;    // 起步/停止速度（Q4）
+    uint32_t jerk_out_velocity; // 加速段开始回落加速度的速度（Q4）
+    uint32_t jerk_in_velocity;  // 减速段开始回落减速度的速度（Q4）
+    uint32_t total_steps;       // 本次运动总步数
+    uint32_t accel_steps;       // 加速段实际用掉的步数，用于对称减速
+    uint32_t rest_accel;        // 加速度积分余数
+    int32_t rest_velocity;      // 速度积分余数
+    bool accel_done;            // 是否已进入巡航
+    bool full_cruise;           // 峰值速度是否等于设定巡航速度（短距离运动会降低峰值）
+    bool stopping;              // 是否为中途停止请求
+
+    // 共振禁区（步进间隔范围，tick，闭区间，0表示未启用）
+    uint16_t band_low[STEPPER_RAMP_MAX_BANDS];
+    uint16_t band_high[STEPPER_RAMP_MAX_BANDS];
+    bool has_bands;             // 是否有启用的禁区（中断内快速跳过检查）
+} stepper_ramp_t;
+
+// 函数声明
+void stepper_ramp_set_acceleration(stepper_ramp_t* ramp, uint16_t acceleration);
+void stepper_ramp_set_jerk(stepper_ramp_t* ramp, uint16_t jerk);
+void stepper_ramp_set_profile(stepper_ramp_t* ramp, motion_profile_t profile);
+void stepper_ramp_set_cruise_fraction(stepper_ramp_t* ramp, uint8_t fraction);
+uint16_t stepper_ramp_plan(stepper_ramp_t* ramp, uint32_t steps, uint16_t cruise_delay);
+bool stepper_ramp_set_cruise(stepper_ramp_t* ramp, uint16_t cruise_delay);
+bool stepper_ramp_begin_stop(stepper_ramp_t* ramp);
+bool stepper_ramp_extend(stepper_ramp_t* ramp, uint32_t steps);
+uint16_t stepper_ramp_next_delay(stepper_ramp_t* ramp);
+uint32_t stepper_ramp_steps_to_speed(const stepper_ramp_t* ramp, uint16_t delay);
+void stepper_ramp_set_band(stepper_ramp_t* ramp, uint8_t index, uint16_t low_delay, uint16_t high_delay);
+uint16_t stepper_ramp_avoid_bands(const stepper_ramp_t* ramp, uint16_t delay, int8_t prefer);
+
+// 辅助函数
+uint16_t stepper_isqrt32(uint32_t value);
+
+#endif // STEPPER_RAMP_H
@@ -0,0 +1,76 @@
+#ifndef STEPPER_RAMP_TABLE_H
+#define STEPPER_RAMP_TABLE_H
+
+#include <Arduino.h>
+#include "stepper_ramp.h"
+
+// 编译期生成的加速表
+// 默认加速度下AVR446的间隔序列 c(n) 与巡航速度无关，只是在不同速度处截断，
+// 因此所有速度预设共用一张以最快预设为终点的表，每个预设只记录自己的截断长度。
+// 表内容与运行时stepper_ramp_next_delay()逐步计算的结果完全一致。
+
+// 编译期整数平方根（向下取整，与stepper_isqrt32()一致）
+constexpr uint32_t stepper_ct_isqrt(uint32_t value, uint32_t low = 0, uint32_t high = 65536) {
+    return (high - low <= 1) ? low :
+           ((unsigned long long)((low + high) / 2) * ((low + high) / 2) <= value) ?
+               stepper_ct_isqrt(value, (low + high) / 2, high) :
+               stepper_ct_isqrt(value, low, (low + high) / 2);
+}
+
+// 编译期c0，与stepper_ramp_set_acceleration()一致
+constexpr uint16_t stepper_ct_ramp_c0(uint16_t acceleration) {
+    return (4UL * stepper_ct_isqrt(STEPPER_RAMP_C0_SQ_DIV16 / acceleration) > 0xFFFF) ?
+           0xFFFF : (uint16_t)(4UL * stepper_ct_isqrt(STEPPER_RAMP_C0_SQ_DIV16 / acceleration));
+}
+
+// AVR446递推中的一个点：间隔和累积余数
+struct stepper_ct_ramp_point {
+    uint32_t delay;
+    uint32_t rest;
+    constexpr stepper_ct_ramp_point(uint32_t d, uint32_t r) : delay(d), rest(r) {}
+};
+
+constexpr stepper_ct_ramp_point stepper_ct_ramp_next(stepper_ct_ramp_point p, uint32_t n) {
+    return stepper_ct_ramp_point(p.delay - (2UL * p.delay + p.rest) / (4UL * n + 1),
+                                 (2UL * p.delay + p.rest) % (4UL * n + 1));
+}
+
+// 第n个加速间隔 c(n)
+constexpr stepper_ct_ramp_point stepper_ct_ramp_point_at(uint32_t n, uint16_t c0) {
+    return (n == 0) ? stepper_ct_ramp_point(c0, 0) :
+                      stepper_ct_ramp_next(stepper_ct_ramp_point_at(n - 1, c0), n);
+}
+
+// 加速到min_delay之前需要查表的间隔个数（第一个 c(n) <= min_delay 的n）
+constexpr uint8_t stepper_ct_ramp_length(stepper_ct_ramp_point p, uint32_t n, uint16_t min_delay) {
+    return (p.delay <= min_delay || n >= 255) ? (uint8_t)n :
+           stepper_ct_ramp_length(stepper_ct_ramp_next(p, n + 1), n + 1, min_delay);
+}
+
+constexpr uint8_t stepper_ct_ramp_length_for(uint16_t acceleration, uint16_t min_delay) {
+    return stepper_ct_ramp_length(stepper_ct_ramp_point(stepper_ct_ramp_c0(acceleration), 0), 0, min_delay);
+}
+
+// C++11下的编译期下标序列
+template<size_t... I> struct stepper_ct_index_seq {};
+template<size_t N, size_t... I> struct stepper_ct_make_index_seq : stepper_ct_make_index_seq<N - 1, N - 1, I...> {};
+template<size_t... I> struct stepper_ct_make_index_seq<0, I...> {
+    typedef stepper_ct_index_seq<I...> type;
+};
+
+// 加速表：values[n] = c(n)，放在Flash中
+template<uint16_t Acceleration, typename Seq> struct stepper_ramp_table_data;
+template<uint16_t Acceleration, size_t... I>
+struct stepper_ramp_table_data<Acceleration, stepper_ct_index_seq<I...> > {
+    static const uint16_t values[sizeof...(I)] PROGMEM;
+};
+template<uint16_t Acceleration, size_t... I>
+const uint16_t stepper_ramp_table_data<Acceleration, stepper_ct_index_seq<I...> >::values[sizeof...(I)] PROGMEM = {
+    (uint16_t)stepper_ct_ramp_point_at(I, stepper_ct_ramp_c0(Acceleration)).delay...
+};
+
+// 函数声明
+uint8_t stepper_ramp_table_lookup(uint16_t acceleration, uint16_t cruise_delay, const uint16_t** table);
+uint16_t stepper_ramp_table_flash_bytes();
+
+#endif // STEPPER_RAMP_TABLE_H
@@ -0,0 +1,46 @@
+#ifndef STEPPER_STALL_H
+#define STEPPER_STALL_H
+
+#include <Arduino.h>
+#include "hal.h"
+
+// 堵转/丢步检测
+// 在ULN2003公共地上串联采样电阻，经PC3（ADC通道3）测量电机供电电流。转子正常转动时反电动势抵消一部分电压，
+// 步进后固定时刻的电流明显低于堵转时（堵转时没有反电动势）；线圈断线时电流则明显偏低。
+// 每次运动进入巡航后先学习基线，之后连续多步偏离基线即判定为异常。
+
+#define STEPPER_STALL_SAMPLE_TICKS        100   // 步进后的采样时刻（tick，400μs）
+#define STEPPER_STALL_MIN_INTERVAL_TICKS  (STEPPER_STALL_SAMPLE_TICKS + 40)  // 步距短于此值时不采样（ADC转换约104μs）
+#define STEPPER_STALL_LEARN_SAMPLES       16    // 每种线圈组合学习基线的样本数
+#define STEPPER_STALL_THRESHOLD_PCT       25    // 偏离基线的百分比超过此值视为异常
+#define STEPPER_STALL_CONSECUTIVE         8     // 连续异常样本数达到此值判定堵转
+#define STEPPER_STALL_TRACK_SHIFT         6     // 正常样本对基线的跟踪速度（1/64）
+
+// 线圈组合分类：单线圈和双线圈通电的电流不同，分别学习基线
+#define STEPPER_STALL_CLASSES             2
+
+// 检测器状态（基线为ADC值×16）
+typedef struct {
+    uint16_t baseline_q4[STEPPER_STALL_CLASSES];
+    uint8_t learned[STEPPER_STALL_CLASSES];
+    uint8_t anomalies;
+    bool stalled;
+} stepper_stall_detector_t;
+
+// 检测算法（纯计算，不访问硬件，可在主机上喂入正常/堵转时记录的ADC序列测试）
+void stepper_stall_detector_reset(stepper_stall_detector_t* detector);
+bool stepper_stall_detector_feed(stepper_stall_detector_t* detector, uint8_t pattern_class, uint16_t sample);
+
+// 同步采样（Timer1比较B在步进后固定时刻启动ADC，ADC中断把结果交给检测器）
+void stepper_stall_init();
+void stepper_stall_enable(bool enable);
+bool stepper_stall_is_enabled();
+void stepper_stall_begin_move();
+void stepper_stall_arm(uint8_t pattern_class, uint16_t next_delay);
+bool stepper_stall_take_event();
+
+// ADC共用：主循环用analogRead()读取其他通道前后调用
+void stepper_stall_adc_lock();
+void stepper_stall_adc_unlock();
+
+#endif // STEPPER_STALL_H
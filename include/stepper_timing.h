@@ -0,0 +1,59 @@
+#ifndef STEPPER_TIMING_H
+#define STEPPER_TIMING_H
+
+#include <Arduino.h>
+
+// 步进时序统计（调试用）
+// 编译时定义STEPPER_TIMING_STATS开启（例如在platformio.ini的build_flags中加入-DSTEPPER_TIMING_STATS），
+// 未定义时所有记录宏展开为空，不占用Flash、RAM和中断时间。
+//
+// 步进中断入口读取TCNT1：CTC模式下计数器在比较匹配时清零，入口处的计数值就是本步比预定时刻晚了多少tick（超时）。
+// 实际步距 = 预定间隔 + 本步超时 - 上一步超时。超时来自其他中断（Timer0、Timer3 PWM、TWI）和主循环的关中断区。
+
+// 直方图桶数：第0桶为0 tick，第k桶为[2^(k-1), 2^k) tick
+#define STEPPER_TIMING_BUCKETS   16
+
+// 主循环分段数（记录每段运行期间出现的最大超时，定位拖慢步进的子系统）
+#define STEPPER_TIMING_SECTIONS  8
+
+// 主循环分段编号
+typedef enum {
+    TIMING_SECTION_IDLE = 0,     // 未标记（setup、loop之间）
+    TIMING_SECTION_KEYS,         // keys_update
+    TIMING_SECTION_MENU,         // menu_update（含OLED刷新和配置保存）
+    TIMING_SECTION_STEPPER,      // stepper_motor_update
+    TIMING_SECTION_CAMERA,       // camera_update_status / camera_update_triggers
+    TIMING_SECTION_PHOTO,        // photo_mode_update
+    TIMING_SECTION_SCAN,         // scan_mode_update
+    TIMING_SECTION_VOLTAGE       // update_voltage_reading
+} stepper_timing_section_t;
+
+// 统计结果（tick为4μs）
+typedef struct {
+    uint16_t interval_histogram[STEPPER_TIMING_BUCKETS];   // 实际步距的对数直方图
+    uint16_t overrun_histogram[STEPPER_TIMING_BUCKETS];    // 超时的对数直方图
+    uint16_t section_worst[STEPPER_TIMING_SECTIONS];       // 各分段期间的最大超时
+    uint16_t worst_overrun;                                // 最大超时
+    uint32_t overrun_sum;                                  // 超时累计（求平均）
+    uint32_t samples;                                      // 记录的步数
+} stepper_timing_stats_t;
+
+#ifdef STEPPER_TIMING_STATS
+
+void stepper_timing_begin_move();
+void stepper_timing_record(uint16_t overrun, uint16_t scheduled);
+void stepper_timing_set_section(uint8_t section);
+void stepper_timing_get(stepper_timing_stats_t* stats);
+void stepper_timing_reset();
+void stepper_timing_dump();
+void stepper_timing_poll_serial();
+
+#define STEPPER_TIMING_SECTION(section)  stepper_timing_set_section(section)
+
+#else
+
+#define STEPPER_TIMING_SECTION(section)  ((void)0)
+
+#endif // STEPPER_TIMING_STATS
+
+#endif // STEPPER_TIMING_H
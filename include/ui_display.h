@@ -20,6 +20,8 @@
 typedef enum {
     CONFIG_ITEM_MOTOR_DIRECTION = 0,
     CONFIG_ITEM_MOTOR_SPEED,
+    CONFIG_ITEM_MOTION_PROFILE,
+    CONFIG_ITEM_BACKLASH,
     CONFIG_ITEM_ROTATION_ANGLE,
     CONFIG_ITEM_PHOTO_INTERVAL,
     CONFIG_ITEM_COUNT
@@ -56,7 +58,7 @@ void ui_draw_config_menu_fullscreen(void);
 void ui_draw_config_edit_fullscreen(void);
 void ui_draw_photo_running(uint8_t current_photo, uint8_t total_photos,
                           uint16_t total_angle, uint8_t angle_per_photo);
-void ui_draw_scan_running(float turns, unsigned long elapsed_seconds);
+void ui_draw_scan_running(uint32_t turns, uint8_t hundredths, unsigned long elapsed_seconds);
 void ui_draw_countdown(uint8_t seconds);
 
 // 进度条绘制
@@ -3,6 +3,9 @@
 // 全局配置变量
 system_config_t g_config;
 
+// 电机速度预设值（毫秒）
+const uint8_t MOTOR_SPEED_PRESETS[MOTOR_SPEED_PRESET_COUNT] PROGMEM = {MOTOR_SPEED_PRESET_LIST};
+
 /**
  * 初始化配置系统
  */
@@ -43,6 +46,14 @@ void config_reset_to_default(void) {
     g_config.version = EEPROM_VERSION;
     g_config.motor_direction = MOTOR_DIRECTION_CW;
     g_config.motor_speed = MOTOR_SPEED_DEFAULT;
+    g_config.motion_profile = MOTION_PROFILE_DEFAULT;
+    g_config.backlash_steps = BACKLASH_STEPS_DEFAULT;
+    for (uint8_t i = 0; i < RESONANCE_BAND_COUNT; i++) {
+        g_config.resonance_band_min[i] = 0;
+        g_config.resonance_band_max[i] = 0;
+    }
+    g_config.belt_driven_teeth = BELT_TEETH_DEFAULT;
+    g_config.belt_drive_teeth = BELT_TEETH_DEFAULT;
     g_config.rotation_angle = ROTATION_ANGLE_DEFAULT;
     g_config.photo_interval = PHOTO_INTERVAL_DEFAULT;
     g_config.checksum = 0; // 将在保存时计算
@@ -66,11 +77,21 @@ bool config_validate(void) {
     // 检查参数范围
     if (!config_is_valid_motor_direction(g_config.motor_direction) ||
         !config_is_valid_motor_speed(g_config.motor_speed) ||
+        !config_is_valid_motion_profile(g_config.motion_profile) ||
+        !config_is_valid_backlash_steps(g_config.backlash_steps) ||
+        !config_is_valid_belt_teeth(g_config.belt_driven_teeth) ||
+        !config_is_valid_belt_teeth(g_config.belt_drive_teeth) ||
         !config_is_valid_rotation_angle(g_config.rotation_angle) ||
         !config_is_valid_photo_interval(g_config.photo_interval)) {
         return false;
     }
 
+    for (uint8_t i = 0; i < RESONANCE_BAND_COUNT; i++) {
+        if (!config_is_valid_resonance_band(g_config.resonance_band_min[i], g_config.resonance_band_max[i])) {
+            return false;
+        }
+    }
+
     return true;
 }
 
@@ -110,6 +131,57 @@ uint8_t config_get_motor_speed(void) {
     return g_config.motor_speed;
 }
 
+/**
+ * 获取第index个电机速度预设值（毫秒），超出范围返回最慢的预设
+ */
+uint8_t config_get_motor_speed_preset(uint8_t index) {
+    if (index >= MOTOR_SPEED_PRESET_COUNT) {
+        index = MOTOR_SPEED_PRESET_COUNT - 1;
+    }
+    return pgm_read_byte(&MOTOR_SPEED_PRESETS[index]);
+}
+
+/**
+ * 获取速度曲线类型
+ */
+uint8_t config_get_motion_profile(void) {
+    return g_config.motion_profile;
+}
+
+/**
+ * 获取齿轮间隙补偿步数
+ */
+uint8_t config_get_backlash_steps(void) {
+    return g_config.backlash_steps;
+}
+
+/**
+ * 获取共振禁区
+ */
+void config_get_resonance_band(uint8_t index, uint16_t* min_sps, uint16_t* max_sps) {
+    if (index >= RESONANCE_BAND_COUNT) {
+        *min_sps = 0;
+        *max_sps = 0;
+        return;
+    }
+    *min_sps = g_config.resonance_band_min[index];
+    *max_sps = g_config.resonance_band_max[index];
+}
+
+/**
+ * 获取转台（从动轮）齿数
+ */
+uint8_t config_get_belt_driven_teeth(void) {
+    return g_config.belt_driven_teeth;
+}
+
+/**
+ * 获取电机轴（主动轮）齿数
+ */
+uint8_t config_get_belt_drive_teeth(void) {
+    return g_config.belt_drive_teeth;
+}
+
 /**
  * 获取旋转角度
  */
@@ -142,6 +214,44 @@ void config_set_motor_speed(uint8_t speed) {
     }
 }
 
+/**
+ * 设置速度曲线类型
+ */
+void config_set_motion_profile(uint8_t profile) {
+    if (config_is_valid_motion_profile(profile)) {
+        g_config.motion_profile = profile;
+    }
+}
+
+/**
+ * 设置齿轮间隙补偿步数
+ */
+void config_set_backlash_steps(uint8_t steps) {
+    if (config_is_valid_backlash_steps(steps)) {
+        g_config.backlash_steps = steps;
+    }
+}
+
+/**
+ * 设置共振禁区
+ */
+void config_set_resonance_band(uint8_t index, uint16_t min_sps, uint16_t max_sps) {
+    if (index < RESONANCE_BAND_COUNT && config_is_valid_resonance_band(min_sps, max_sps)) {
+        g_config.resonance_band_min[index] = min_sps;
+        g_config.resonance_band_max[index] = max_sps;
+    }
+}
+
+/**
+ * 设置转台皮带/齿轮齿数比
+ */
+void config_set_belt_ratio(uint8_t driven_teeth, uint8_t drive_teeth) {
+    if (config_is_valid_belt_teeth(driven_teeth) && config_is_valid_belt_teeth(drive_teeth)) {
+        g_config.belt_driven_teeth = driven_teeth;
+        g_config.belt_drive_teeth = drive_teeth;
+    }
+}
+
 /**
  * 设置旋转角度
  */
@@ -172,17 +282,46 @@ bool config_is_valid_motor_direction(uint8_t direction) {
  */
 bool config_is_valid_motor_speed(uint8_t speed) {
     // 检查是否为预设的有效值
-    const uint8_t valid_speeds[] = {2, 4, 6, 8, 10, 15, 30, 60, 100};
-    const uint8_t valid_count = sizeof(valid_speeds) / sizeof(valid_speeds[0]);
-
-    for (uint8_t i = 0; i < valid_count; i++) {
-        if (speed == valid_speeds[i]) {
+    for (uint8_t i = 0; i < MOTOR_SPEED_PRESET_COUNT; i++) {
+        if (speed == config_get_motor_speed_preset(i)) {
             return true;
         }
     }
     return false;
 }
 
+/**
+ * 验证速度曲线类型
+ */
+bool config_is_valid_motion_profile(uint8_t profile) {
+    return (profile == MOTION_PROFILE_TRAPEZOID || profile == MOTION_PROFILE_SCURVE);
+}
+
+/**
+ * 验证齿轮间隙补偿步数
+ */
+bool config_is_valid_backlash_steps(uint8_t steps) {
+    return (steps <= BACKLASH_STEPS_MAX && steps % BACKLASH_STEPS_STEP == 0);
+}
+
+/**
+ * 验证共振禁区（0-0表示未启用）
+ */
+bool config_is_valid_resonance_band(uint16_t min_sps, uint16_t max_sps) {
+    if (min_sps == 0 && max_sps == 0) {
+        return true;
+    }
+    return (min_sps > 0 && min_sps < max_sps && max_sps <= RESONANCE_BAND_SPS_MAX &&
+            (uint32_t)(max_sps - min_sps) * 100 <= (uint32_t)min_sps * RESONANCE_BAND_WIDTH_PCT);
+}
+
+/**
+ * 验证皮带轮齿数
+ */
+bool config_is_valid_belt_teeth(uint8_t teeth) {
+    return (teeth >= BELT_TEETH_MIN && teeth <= BELT_TEETH_MAX);
+}
+
 /**
  * 验证旋转角度
  */
@@ -207,6 +346,13 @@ const char* config_get_motor_direction_string(void) {
     return (g_config.motor_direction == MOTOR_DIRECTION_CW) ? "CW" : "CCW";
 }
 
+/**
+ * 获取速度曲线字符串
+ */
+const char* config_get_motion_profile_string(void) {
+    return (g_config.motion_profile == MOTION_PROFILE_SCURVE) ? "S-Curve" : "Trapezoid";
+}
+
 /**
  * 获取旋转角度字符串
  */
@@ -7,6 +7,7 @@
 #include "keys.h"
 #include "voltage.h"
 #include "stepper_motor.h"
+#include "stepper_home.h"
 #include "clock_verify.h"
 #include "camera.h"
 #include "config.h"
@@ -14,6 +15,7 @@
 #include "ui_display.h"
 #include "photo_mode.h"
 #include "scan_mode.h"
+#include "stepper_timing.h"
 
 // 创建显示对象
 Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, -1); // -1 表示不使用复位引脚
@@ -48,6 +50,7 @@ void setup() {
   keys_init();
   voltage_sensor_init();
   stepper_motor_init();
+  stepper_home_init();
   camera_init();
   config_init();
   ui_init();
@@ -61,27 +64,41 @@ void setup() {
 
 void loop() {
   // 更新按键状态
+  STEPPER_TIMING_SECTION(TIMING_SECTION_KEYS);
   keys_update();
 
   // 更新菜单系统（包含按键处理和状态管理）
+  STEPPER_TIMING_SECTION(TIMING_SECTION_MENU);
   menu_update();
 
   // 更新步进电机状态
+  STEPPER_TIMING_SECTION(TIMING_SECTION_STEPPER);
   stepper_motor_update();
+  stepper_home_update();
 
   // 更新相机状态
+  STEPPER_TIMING_SECTION(TIMING_SECTION_CAMERA);
   camera_update_status();
 
   // 更新相机触发状态（非阻塞）
   camera_update_triggers();
 
   // 更新拍照模式
+  STEPPER_TIMING_SECTION(TIMING_SECTION_PHOTO);
   photo_mode_update();
 
   // 更新3D扫描模式
+  STEPPER_TIMING_SECTION(TIMING_SECTION_SCAN);
   scan_mode_update();
 
   // 更新电压读取（每2秒一次）
+  STEPPER_TIMING_SECTION(TIMING_SECTION_VOLTAGE);
   update_voltage_reading();
 
+  STEPPER_TIMING_SECTION(TIMING_SECTION_IDLE);
+
+#ifdef STEPPER_TIMING_STATS
+  // 串口调试：'t'输出步进时序统计，'r'清空
+  stepper_timing_poll_serial();
+#endif
 }
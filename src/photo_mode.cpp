@@ -9,6 +9,11 @@ static photo_mode_state_t photo_state;
 #define SHUTTER_DURATION_MS         200
 #define ROTATION_SETTLE_TIME_MS     500
 #define PHOTO_DISPLAY_UPDATE_INTERVAL_MS  50  // 拍照模式高频显示更新间隔
+#define PHOTO_RETURN_SPEED          MOTOR_SPEED_MIN  // 回原点速度（毫秒/全步），不拍摄，用最快速度
+
+// 减流保持覆盖旋转后稳定、快门前停留、快门和快门后停留，留1秒余量
+#define PHOTO_HOLD_TIMEOUT_MS  (ROTATION_SETTLE_TIME_MS + PHOTO_PRE_SHUTTER_SETTLE_TIME + \
+                                SHUTTER_DURATION_MS + PHOTO_POST_SHUTTER_SETTLE_TIME + 1000)
 
 /**
  * 初始化拍照模式
@@ -24,11 +29,9 @@ void photo_mode_init(void) {
     photo_state.target_angle = 0;
     photo_state.current_angle = 0;
     photo_state.angle_per_photo = 0;
-    photo_state.steps_per_photo = 0;
+    photo_state.angle_carry = 0;
     photo_state.total_steps_moved = 0;
-    photo_state.per_rotation_compensation = 0;
-    photo_state.final_compensation = 0;
-    photo_state.remaining_steps = 0;
+    photo_state.rotation_done = false;
     photo_state.focus_start_time = 0;
     photo_state.shutter_start_time = 0;
     photo_state.focus_triggered = false;
@@ -47,22 +50,46 @@ void photo_mode_start(void) {
         return;
     }
 
+    // 自动半步/全步模式：低速旋转平滑，高速时保持扭矩（每转步数需在计算参数前确定）
+    stepper_motor_set_step_mode(STEP_MODE_AUTO);
+    stepper_motor_set_belt_ratio(config_get_belt_driven_teeth(), config_get_belt_drive_teeth());
+
     // 计算拍照参数
     photo_mode_calculate_parameters();
 
-    // 重置步数计数器，确保角度从0开始
+    // 每次旋转结束后以减流保持位置，直到拍完这一张
+    stepper_motor_set_hold(PHOTO_HOLD_DUTY_PERCENT, PHOTO_HOLD_TIMEOUT_MS);
+
+    // 旋转结束和堵转由电机事件推进（需要电流采样电阻才能检测堵转）
+    stepper_motor_set_event_callback(photo_mode_handle_event);
+    stepper_motor_enable_stall_detection(CURRENT_SENSE_ENABLED);
+
+#if HOME_SENSOR_ENABLED
+    // 先归零到索引，角度从索引开始，连续多次拍摄不累积误差
+    stepper_home_start(config_get_motor_direction() == MOTOR_DIRECTION_CW ? CLOCKWISE : COUNTER_CLOCKWISE);
+    photo_state.current_state = PHOTO_STATE_HOMING;
+    photo_state.state_enter_time = millis();
+#else
+    // 重置步数计数器和绝对位置，确保角度从0开始
     stepper_motor_reset_step_count();
+    stepper_motor_set_home();
 
     // 开始倒计时
     photo_mode_start_countdown();
+#endif
 }
 
 /**
  * 停止拍照模式
  */
 void photo_mode_stop(void) {
-    // 停止电机
+    // 取消归零和减流保持并停止电机
+    stepper_home_cancel();
+    stepper_home_enable_tracking(false);
+    stepper_motor_set_hold(0, 0);
     stepper_motor_stop();
+    stepper_motor_enable_stall_detection(false);
+    stepper_motor_set_event_callback(nullptr);
 
     // 释放相机触发
     camera_release_triggers();
@@ -85,6 +112,9 @@ void photo_mode_update(void) {
     photo_state.last_update_time = current_time;
 
     switch (photo_state.current_state) {
+        case PHOTO_STATE_HOMING:
+            photo_mode_handle_homing();
+            break;
         case PHOTO_STATE_COUNTDOWN:
             photo_mode_handle_countdown();
             break;
@@ -112,6 +142,9 @@ void photo_mode_update(void) {
         case PHOTO_STATE_POST_SHOOTING:
             photo_mode_handle_post_shooting();
             break;
+        case PHOTO_STATE_RETURNING:
+            // 等待运动结束事件
+            break;
         case PHOTO_STATE_COMPLETE:
             photo_mode_handle_complete();
             break;
@@ -141,6 +174,27 @@ photo_state_t photo_mode_get_state(void) {
     return photo_state.current_state;
 }
 
+/**
+ * 处理归零状态
+ * 归零完成后索引处即为位置0，拍摄过程中每次经过索引都会修正绝对位置
+ */
+void photo_mode_handle_homing(void) {
+    switch (stepper_home_get_state()) {
+        case HOME_STATE_DONE:
+            stepper_motor_reset_step_count();
+            stepper_home_enable_tracking(true);
+            photo_mode_start_countdown();
+            break;
+        case HOME_STATE_FAILED:
+            // 转过一圈仍未找到索引（传感器故障或转台卡住）
+            photo_mode_stop();
+            buzzer_tone(400, 1000);
+            break;
+        default:
+            break;
+    }
+}
+
 /**
  * 处理倒计时状态
  */
@@ -198,6 +252,9 @@ void photo_mode_handle_focus(void) {
 
         photo_state.current_state = PHOTO_STATE_PRE_FIRST_SHOT;
         photo_state.state_enter_time = current_time;
+
+        // 第一张照片前锁定原点
+        stepper_motor_hold();
         // current_photo保持为0，表示还没有完成任何照片
     }
 }
@@ -243,6 +300,12 @@ void photo_mode_handle_post_first_shot(void) {
 
     // 停留时间结束
     if (elapsed >= PHOTO_POST_SHUTTER_SETTLE_TIME) {
+        // 线圈温升过高时断电停留，降温后再旋转
+        if (stepper_motor_needs_cooldown()) {
+            stepper_motor_release();
+            return;
+        }
+
         // 第一张照片已完成
         photo_state.current_photo = 1;
 
@@ -260,23 +323,39 @@ void photo_mode_handle_post_first_shot(void) {
  * 处理旋转状态
  */
 void photo_mode_handle_rotating(void) {
-    // 检查电机是否完成旋转
-    if (!stepper_motor_is_running()) {
-        unsigned long current_time = millis();
-        unsigned long elapsed = current_time - photo_state.state_enter_time;
-
-        // 等待电机稳定
-        if (elapsed >= ROTATION_SETTLE_TIME_MS) {
-
-            // 检查是否已经拍摄完所有照片
-            // 最后一次旋转是为了复位，不需要拍摄
-            if (photo_state.current_photo >= photo_state.total_photos) {
-                photo_mode_finish_session();
-            } else {
-                // 进入拍摄前停留状态
-                photo_state.current_state = PHOTO_STATE_PRE_SHOOTING;
-                photo_state.state_enter_time = current_time;
-            }
+    // 旋转结束事件到达前不做任何事
+    if (!photo_state.rotation_done) {
+        return;
+    }
+
+    unsigned long current_time = millis();
+    unsigned long elapsed = current_time - photo_state.state_enter_time;
+
+    // 等待电机稳定
+    if (elapsed >= ROTATION_SETTLE_TIME_MS) {
+        // 进入拍摄前停留状态
+        photo_state.current_state = PHOTO_STATE_PRE_SHOOTING;
+        photo_state.state_enter_time = current_time;
+    }
+}
+
+/**
+ * 处理电机事件（在stepper_motor_update()中回调）
+ */
+void photo_mode_handle_event(uint8_t events) {
+    if (events & STEPPER_EVENT_STALL) {
+        photo_mode_handle_stall();
+        return;
+    }
+
+    if (events & STEPPER_EVENT_MOVE_DONE) {
+        if (photo_state.current_state == PHOTO_STATE_ROTATING) {
+            // 稳定时间从电机停止时开始计算，而不是从发起旋转时
+            photo_state.rotation_done = true;
+            photo_state.state_enter_time = millis();
+        } else if (photo_state.current_state == PHOTO_STATE_RETURNING) {
+            // 回到原点后不需要等待稳定，直接结束
+            photo_mode_finish_session();
         }
     }
 }
@@ -287,9 +366,11 @@ void photo_mode_handle_rotating(void) {
 void photo_mode_handle_pre_shooting(void) {
     unsigned long current_time = millis();
     unsigned long elapsed = current_time - photo_state.state_enter_time;
+    unsigned long settle_time = (stepper_motor_get_motion_profile() == PROFILE_SCURVE) ?
+                                PHOTO_PRE_SHUTTER_SETTLE_TIME_SCURVE : PHOTO_PRE_SHUTTER_SETTLE_TIME;
 
     // 停留时间结束，开始拍摄
-    if (elapsed >= PHOTO_PRE_SHUTTER_SETTLE_TIME) {
+    if (elapsed >= settle_time) {
         photo_state.current_state = PHOTO_STATE_SHOOTING;
         photo_state.state_enter_time = current_time;
         photo_mode_trigger_shutter();
@@ -322,13 +403,19 @@ void photo_mode_handle_post_shooting(void) {
 
     // 停留时间结束
     if (elapsed >= PHOTO_POST_SHUTTER_SETTLE_TIME) {
+        // 线圈温升过高时断电停留，降温后再旋转
+        if (stepper_motor_needs_cooldown()) {
+            stepper_motor_release();
+            return;
+        }
+
         // 当前照片已完成
         photo_state.current_photo++;
 
         // 检查是否已经拍摄完所有照片
         if (photo_state.current_photo >= photo_state.total_photos) {
-            // 已经拍摄完所有照片，最后一次旋转是为了复位
-            photo_mode_start_rotation();
+            // 已经拍摄完所有照片，走最短路径快速回到原点
+            photo_mode_start_return();
         } else {
             // 继续旋转到下一个位置进行拍摄
             photo_mode_start_rotation();
@@ -372,6 +459,21 @@ void photo_mode_handle_complete(void) {
     }
 }
 
+/**
+ * 处理堵转：丢步后绝对位置已不可信，后续角度无法保证，立即停止并中止本次拍摄
+ */
+void photo_mode_handle_stall(void) {
+    if (!photo_mode_is_running()) {
+        return;
+    }
+
+    stepper_motor_halt();
+    photo_mode_stop();
+
+    // 低音长鸣提示故障（覆盖停止提示音）
+    buzzer_tone(400, 1000);
+}
+
 /**
  * 计算拍照参数
  */
@@ -388,30 +490,12 @@ void photo_mode_calculate_parameters(void) {
     photo_state.current_angle = 0;
     photo_state.current_photo = 0;
 
-    // 累积误差补偿：预先计算整个旋转过程的总步数，然后平均分配
-    // 这样可以最大限度减少四舍五入造成的累积误差
-    step_mode_t step_mode = stepper_motor_get_step_mode();
-    uint16_t steps_per_revolution = (step_mode == STEP_MODE_FULL) ?
-                                   STEPS_PER_REVOLUTION_FULL : STEPS_PER_REVOLUTION_HALF;
-
-    // 计算实际旋转角度对应的总步数（使用四舍五入）
-    // 注意：这里使用 (total_photos - 1) 是因为第一张照片在0度拍摄，不需要旋转
-    uint16_t actual_rotation_angle = photo_interval * (photo_state.total_photos - 1);
-    uint32_t total_rotation_steps = ((uint32_t)actual_rotation_angle * steps_per_revolution + 180) / 360;
-
-    // 平均分配步数到每次旋转（除了第一张照片）
-    photo_state.steps_per_photo = total_rotation_steps / (photo_state.total_photos - 1);
-
-    // 累积精度误差将在最后一次旋转时补偿
-    photo_state.remaining_steps = total_rotation_steps % (photo_state.total_photos - 1);
+    // 每次旋转按精确每转步数换算，余数带到下一次旋转
+    // 第k次旋转后的累计步数始终等于 k×间隔角度 的精确步数四舍五入，转满一圈正好回到起点
+    stepper_gear_ratio_t ratio;
+    stepper_motor_get_gear_ratio(&ratio);
+    photo_state.angle_carry = stepper_gear_carry_init(&ratio);
     photo_state.total_steps_moved = 0;
-
-    // 分离补偿计算：
-    // 1. 每次旋转的启停补偿（使用十倍精度版本，支持0.7度等小数）
-    photo_state.per_rotation_compensation = photo_mode_angle_to_steps_x10(ANGLE_COMPENSATION_PER_STOP_DEGREES_X10);
-
-    // 2. 最后一次复位的累积补偿 = 基础补偿 + 累积精度误差
-    photo_state.final_compensation = ANGLE_COMPENSATION_BASE + photo_state.remaining_steps;
 }
 
 /**
@@ -446,28 +530,58 @@ void photo_mode_trigger_shutter(void) {
 void photo_mode_start_rotation(void) {
     photo_state.current_state = PHOTO_STATE_ROTATING;
     photo_state.state_enter_time = millis();
+    photo_state.rotation_done = false;
 
     // 设置电机参数
     stepper_motor_set_direction(config_get_motor_direction() == MOTOR_DIRECTION_CW ? CLOCKWISE : COUNTER_CLOCKWISE);
     stepper_motor_set_custom_speed(config_get_motor_speed());
-
-    // 计算旋转步数 = 基础步数 + 每次启停补偿
-    // ✅ 关键修复：每次旋转都应用启停补偿，而不是累积到最后
-    uint32_t rotation_steps = photo_state.steps_per_photo + photo_state.per_rotation_compensation;
-
-    // 如果这是最后一次旋转（复位旋转），额外应用最终累积补偿
-    if (photo_state.current_photo >= photo_state.total_photos) {
-        rotation_steps += photo_state.final_compensation;
+    stepper_motor_set_motion_profile(config_get_motion_profile() == MOTION_PROFILE_SCURVE ? PROFILE_SCURVE : PROFILE_TRAPEZOID);
+    stepper_motor_set_backlash(config_get_backlash_steps());
+    for (uint8_t i = 0; i < RESONANCE_BAND_COUNT; i++) {
+        uint16_t band_min, band_max;
+        config_get_resonance_band(i, &band_min, &band_max);
+        stepper_motor_set_resonance_band(i, band_min, band_max);
     }
 
+    // 计算旋转步数：电机起步前预励磁锁定相位，不再丢步，无需启停补偿
+    stepper_gear_ratio_t ratio;
+    stepper_motor_get_gear_ratio(&ratio);
+    uint32_t rotation_steps = stepper_gear_degrees_to_steps(&ratio, photo_state.angle_per_photo, &photo_state.angle_carry);
+
     // 开始旋转指定步数
     stepper_motor_rotate_steps(rotation_steps);
 }
 
+/**
+ * 开始回原点
+ * 原点为会话开始（或归零完成）时的位置0；按精确每转步数取最短有符号偏移，
+ * 最多转半圈。回程不拍摄，用梯形曲线和最高速度，电压调速和温度降额仍会限速
+ */
+void photo_mode_start_return(void) {
+    // 已在原点时不会有运动，也就不会有结束事件
+    if (stepper_motor_get_shortest_offset(0) == 0) {
+        photo_mode_finish_session();
+        return;
+    }
+
+    photo_state.current_state = PHOTO_STATE_RETURNING;
+    photo_state.state_enter_time = millis();
+
+    stepper_motor_set_custom_speed(PHOTO_RETURN_SPEED);
+    stepper_motor_set_motion_profile(PROFILE_TRAPEZOID);
+    stepper_motor_move_to(0);
+}
+
 /**
  * 完成拍摄会话
  */
 void photo_mode_finish_session(void) {
+    // 拍摄结束，断开线圈，不再接收电机事件（之后的手动转动不应推进拍照状态）
+    stepper_home_enable_tracking(false);
+    stepper_motor_set_hold(0, 0);
+    stepper_motor_release();
+    stepper_motor_set_event_callback(nullptr);
+
     photo_state.current_state = PHOTO_STATE_COMPLETE;
     photo_state.state_enter_time = millis();
 }
@@ -491,6 +605,9 @@ void photo_mode_update_display(void) {
 
     // 根据拍照状态绘制内容
     switch (photo_state.current_state) {
+        case PHOTO_STATE_HOMING:
+            ui_center_text("Homing...", 16);
+            break;
         case PHOTO_STATE_COUNTDOWN:
             ui_draw_countdown(photo_state.countdown_seconds);
             break;
@@ -506,6 +623,9 @@ void photo_mode_update_display(void) {
             ui_draw_photo_running(photo_state.current_photo, photo_state.total_photos,
                                  photo_state.target_angle, photo_state.angle_per_photo);
             break;
+        case PHOTO_STATE_RETURNING:
+            ui_center_text("Returning...", 16);
+            break;
         case PHOTO_STATE_COMPLETE:
             ui_center_text("Photo Complete!", 16);
             break;
@@ -518,48 +638,22 @@ void photo_mode_update_display(void) {
 }
 
 /**
- * 角度转换为步数
+ * 角度转换为步数（按精确每转步数四舍五入）
  */
 uint32_t photo_mode_angle_to_steps(uint16_t angle) {
-    // 根据当前步进模式获取正确的每圈步数
-    step_mode_t step_mode = stepper_motor_get_step_mode();
-    uint16_t steps_per_revolution = (step_mode == STEP_MODE_FULL) ?
-                                   STEPS_PER_REVOLUTION_FULL : STEPS_PER_REVOLUTION_HALF;
-
-    // 计算角度对应的步数（使用四舍五入而不是截断）
-    // 公式：(angle × steps_per_revolution + 180) / 360
-    // +180是为了四舍五入（180 = 360/2）
-    return ((uint32_t)angle * steps_per_revolution + 180) / 360;
-}
+    stepper_gear_ratio_t ratio;
+    stepper_motor_get_gear_ratio(&ratio);
 
-/**
- * 角度转换为步数（十倍精度版本）
- * @param angle_x10 角度×10（单位：0.1度）。例如：7表示0.7度，10表示1.0度
- * @return 对应的步数
- */
-uint32_t photo_mode_angle_to_steps_x10(uint16_t angle_x10) {
-    // 根据当前步进模式获取正确的每圈步数
-    step_mode_t step_mode = stepper_motor_get_step_mode();
-    uint16_t steps_per_revolution = (step_mode == STEP_MODE_FULL) ?
-                                   STEPS_PER_REVOLUTION_FULL : STEPS_PER_REVOLUTION_HALF;
-
-    // 计算角度对应的步数（使用四舍五入）
-    // angle_x10单位是0.1度，所以需要除以10才是实际角度
-    // 公式：(angle_x10 × steps_per_revolution + 1800) / 3600
-    // 1800 = 3600/2 用于四舍五入
-    // 3600 = 360 × 10
-    return ((uint32_t)angle_x10 * steps_per_revolution + 1800) / 3600;
+    uint32_t carry = stepper_gear_carry_init(&ratio);
+    return stepper_gear_degrees_to_steps(&ratio, angle, &carry);
 }
 
 /**
  * 步数转换为角度
  */
 uint16_t photo_mode_steps_to_angle(uint32_t steps) {
-    // 根据当前步进模式获取正确的每圈步数
-    step_mode_t step_mode = stepper_motor_get_step_mode();
-    uint16_t steps_per_revolution = (step_mode == STEP_MODE_FULL) ?
-                                   STEPS_PER_REVOLUTION_FULL : STEPS_PER_REVOLUTION_HALF;
+    stepper_gear_ratio_t ratio;
+    stepper_motor_get_gear_ratio(&ratio);
 
-    // 计算步数对应的角度
-    return (uint16_t)(steps * 360 / steps_per_revolution);
+    return (uint16_t)stepper_gear_steps_to_degrees(&ratio, steps);
 }
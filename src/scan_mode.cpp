@@ -19,8 +19,8 @@ void scan_mode_init(void) {
     scan_state.last_beep_time = 0;
     scan_state.start_time = 0;
     scan_state.total_runtime = 0;
-    scan_state.total_steps = 0;
-    scan_state.total_turns = 0.0;
+    scan_state.total_turns = 0;
+    scan_state.turn_hundredths = 0;
     scan_state.last_display_update = 0;
 
 
@@ -31,8 +31,8 @@ void scan_mode_init(void) {
  */
 void scan_mode_start(void) {
     // 重置统计数据
-    scan_state.total_steps = 0;
-    scan_state.total_turns = 0.0;
+    scan_state.total_turns = 0;
+    scan_state.turn_hundredths = 0;
     scan_state.start_time = 0;
     scan_state.total_runtime = 0;
 
@@ -46,6 +46,9 @@ void scan_mode_start(void) {
 void scan_mode_stop(void) {
     // 停止电机
     stepper_motor_stop();
+    stepper_motor_enable_stall_detection(false);
+    stepper_motor_set_event_callback(nullptr);
+    stepper_home_enable_tracking(false);
 
     // 计算总运行时间
     if (scan_state.start_time > 0) {
@@ -143,16 +146,40 @@ void scan_mode_handle_countdown(void) {
  * 处理运行状态
  */
 void scan_mode_handle_running(void) {
-    // 更新统计数据
+    // 更新统计数据（电机停止后的重新启动由事件处理）
     scan_mode_update_statistics();
+}
+
+/**
+ * 处理电机事件（在stepper_motor_update()中回调）
+ */
+void scan_mode_handle_event(uint8_t events) {
+    if (events & STEPPER_EVENT_STALL) {
+        scan_mode_handle_stall();
+        return;
+    }
 
-    // 检查电机是否还在运行
-    if (!stepper_motor_is_running()) {
-        // 如果电机停止了，重新启动连续旋转
+    // 连续旋转意外结束时重新启动
+    if ((events & STEPPER_EVENT_MOVE_DONE) && scan_state.current_state == SCAN_STATE_RUNNING) {
         stepper_motor_start();
     }
 }
 
+/**
+ * 处理堵转：转台被卡住时立即停止并中止扫描
+ */
+void scan_mode_handle_stall(void) {
+    if (!scan_mode_is_running()) {
+        return;
+    }
+
+    stepper_motor_halt();
+    scan_mode_stop();
+
+    // 低音长鸣提示故障（覆盖停止提示音）
+    buzzer_tone(400, 1000);
+}
+
 /**
  * 开始倒计时
  */
@@ -174,14 +201,34 @@ void scan_mode_start_scanning(void) {
     uint8_t motor_speed = config_get_motor_speed();
     uint8_t motor_direction = config_get_motor_direction();
 
-    // 直接使用用户配置的毫秒数
+    // 自动半步/全步模式，直接使用用户配置的每全步毫秒数
+    stepper_motor_set_step_mode(STEP_MODE_AUTO);
+    stepper_motor_set_belt_ratio(config_get_belt_driven_teeth(), config_get_belt_drive_teeth());
     stepper_motor_set_custom_speed(motor_speed);
 
     // 设置电机方向
     stepper_motor_set_direction(motor_direction == MOTOR_DIRECTION_CW ? CLOCKWISE : COUNTER_CLOCKWISE);
 
-    // 重置步数计数器
+    // 设置速度曲线
+    stepper_motor_set_motion_profile(config_get_motion_profile() == MOTION_PROFILE_SCURVE ? PROFILE_SCURVE : PROFILE_TRAPEZOID);
+    stepper_motor_set_backlash(config_get_backlash_steps());
+    for (uint8_t i = 0; i < RESONANCE_BAND_COUNT; i++) {
+        uint16_t band_min, band_max;
+        config_get_resonance_band(i, &band_min, &band_max);
+        stepper_motor_set_resonance_band(i, band_min, band_max);
+    }
+
+    // 重置步数计数器，扫描起点作为绝对位置原点
     stepper_motor_reset_step_count();
+    stepper_motor_set_home();
+
+    // 索引跟踪：第一次经过索引时记录其位置，之后每转修正一次绝对位置
+    stepper_home_clear_reference();
+    stepper_home_enable_tracking(HOME_SENSOR_ENABLED);
+
+    // 电机事件：连续旋转意外结束时重启，堵转时中止（堵转检测需要电流采样电阻）
+    stepper_motor_set_event_callback(scan_mode_handle_event);
+    stepper_motor_enable_stall_detection(CURRENT_SENSE_ENABLED);
 
     // 启动连续旋转
     stepper_motor_start();
@@ -191,15 +238,14 @@ void scan_mode_start_scanning(void) {
  * 更新统计数据
  */
 void scan_mode_update_statistics(void) {
-    // 直接从步进电机模块读取精确的步数
-    scan_state.total_steps = stepper_motor_get_step_count();
-
-    // 根据当前步进模式计算圈数
-    step_mode_t step_mode = stepper_motor_get_step_mode();
-    uint16_t steps_per_revolution = (step_mode == STEP_MODE_FULL) ?
-                                   STEPS_PER_REVOLUTION_FULL : STEPS_PER_REVOLUTION_HALF;
-
-    scan_state.total_turns = (float)scan_state.total_steps / steps_per_revolution;
+    // 步进电机模块按精确每转步数（num/den）累计整圈数和圈内偏移，多日连续扫描也不溢出
+    stepper_gear_travel_t travel;
+    stepper_gear_ratio_t ratio;
+    stepper_motor_get_travel(&travel);
+    stepper_motor_get_gear_ratio(&ratio);
+
+    scan_state.total_turns = travel.turns;
+    scan_state.turn_hundredths = (uint8_t)stepper_gear_travel_fraction(&ratio, &travel, 100);
 }
 
 /**
@@ -227,7 +273,7 @@ void scan_mode_update_display(void) {
         case SCAN_STATE_RUNNING:
             {
                 unsigned long elapsed_seconds = scan_mode_get_elapsed_seconds();
-                ui_draw_scan_running(scan_state.total_turns, elapsed_seconds);
+                ui_draw_scan_running(scan_state.total_turns, scan_state.turn_hundredths, elapsed_seconds);
             }
             break;
         default:
@@ -239,9 +285,9 @@ void scan_mode_update_display(void) {
 }
 
 /**
- * 计算旋转圈数
+ * 计算旋转圈数（已完成的整圈）
  */
-float scan_mode_calculate_turns(void) {
+uint32_t scan_mode_calculate_turns(void) {
     return scan_state.total_turns;
 }
 
@@ -0,0 +1,166 @@
+#include <util/atomic.h>
+#include "stepper_axis.h"
+#include "stepper_motor.h"
+
+static_assert(STEP_MOTOR_INT4_PIN == STEP_MOTOR_INT1_PIN + 3, "rotation coil pins must be consecutive");
+static_assert(TILT_MOTOR_INT4_PIN == TILT_MOTOR_INT1_PIN + 3, "tilt coil pins must be consecutive");
+static_assert(STEP_MOTOR_INT1_PIN <= 4 && TILT_MOTOR_INT1_PIN <= 4, "coil pins INT1-INT4 must fit in one 8-bit port");
+
+// 轴实例（下标为轴编号，端口需与hal.h中的引脚一致）
+static volatile stepper_axis_t axes[STEPPER_AXIS_COUNT] = {
+    { &PORTE, &DDRE, STEP_MOTOR_INT1_PIN, false, STEP_MODE_HALF, 0, 0 },    // STEPPER_AXIS_ROTATION
+    { &PORTB, &DDRB, TILT_MOTOR_INT1_PIN, true, STEP_MODE_HALF, 0, 0 }      // STEPPER_AXIS_TILT
+};
+
+/**
+ * 输出线圈组合到轴的端口（一次写端口，4个线圈同时切换；调用方负责关中断）
+ */
+static inline void axis_output(volatile stepper_axis_t* state, uint8_t step_pattern) {
+    uint8_t mask = (uint8_t)(0x0F << state->shift);
+    *state->port = (*state->port & (uint8_t)~mask) | (uint8_t)((step_pattern & 0x0F) << state->shift);
+}
+
+/**
+ * 初始化所有轴的线圈引脚为输出低电平
+ */
+void stepper_axis_init() {
+    for (uint8_t i = 0; i < STEPPER_AXIS_COUNT; i++) {
+        volatile stepper_axis_t* state = &axes[i];
+        *state->ddr |= (uint8_t)(0x0F << state->shift);
+        axis_output(state, 0);
+        state->step_mode = STEP_MODE_HALF;
+        state->current_step = 0;
+        state->position = 0;
+    }
+}
+
+/**
+ * 输出线圈组合（一次写端口，4个线圈同时切换）
+ * 主循环也可调用，关中断避免与PWM中断同时改写端口
+ * @param axis 轴编号
+ * @param step_pattern 线圈组合（bit0-3对应INT1-INT4）
+ */
+void stepper_axis_write(uint8_t axis, uint8_t step_pattern) {
+    if (axis >= STEPPER_AXIS_COUNT) return;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        axis_output(&axes[axis], step_pattern);
+    }
+}
+
+/**
+ * 断开轴的所有线圈
+ */
+void stepper_axis_release(uint8_t axis) {
+    stepper_axis_write(axis, 0);
+}
+
+/**
+ * 断开所有辅助轴的线圈（联动结束后调用，减速箱自锁，静止时无需通电）
+ */
+void stepper_axis_release_auxiliary() {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        for (uint8_t i = 0; i < STEPPER_AXIS_COUNT; i++) {
+            if (axes[i].auxiliary) {
+                axis_output(&axes[i], 0);
+            }
+        }
+    }
+}
+
+/**
+ * 辅助轴按自己的步进模式走一步（在Timer1中断或ATOMIC_BLOCK内调用）
+ * @param axis 辅助轴编号（旋转轴由stepper_motor步进，这里忽略）
+ * @param forward true为正方向
+ */
+void stepper_axis_step(uint8_t axis, bool forward) {
+    if (axis >= STEPPER_AXIS_COUNT || !axes[axis].auxiliary) return;
+
+    volatile stepper_axis_t* state = &axes[axis];
+    int8_t stride = (state->step_mode == STEP_MODE_FULL) ? 2 : 1;
+
+    if (forward) {
+        state->current_step = (state->current_step + stride) & (STEP_SEQUENCE_LENGTH_HALF - 1);
+        state->position++;
+    } else {
+        state->current_step = (state->current_step - stride) & (STEP_SEQUENCE_LENGTH_HALF - 1);
+        state->position--;
+    }
+
+    axis_output(state, stepper_sequence_half::pattern((uint8_t)state->current_step));
+}
+
+/**
+ * 设置辅助轴的步进模式（轴静止时调用）
+ * 全步位置k对应半步位置2k+1（双线圈组合）；从半步切到全步时，停在单线圈组合上的轴先沿正方向对齐半步
+ * @param axis 辅助轴编号
+ * @param mode STEP_MODE_HALF或STEP_MODE_FULL，其他值忽略
+ */
+void stepper_axis_set_step_mode(uint8_t axis, uint8_t mode) {
+    if (axis >= STEPPER_AXIS_COUNT || !axes[axis].auxiliary) return;
+    if (mode != STEP_MODE_HALF && mode != STEP_MODE_FULL) return;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        volatile stepper_axis_t* state = &axes[axis];
+        if (state->step_mode == mode) {
+            return;
+        }
+
+        if (mode == STEP_MODE_FULL) {
+            if (!(state->current_step & 0x01)) {
+                state->current_step = (state->current_step + 1) & (STEP_SEQUENCE_LENGTH_HALF - 1);
+                state->position++;
+            }
+            // 半步位置2k+1换算为全步位置k（按位右移为向下取整，负数也成立）
+            state->position = state->position >> 1;
+        } else {
+            state->position = state->position * 2 + 1;
+        }
+        state->step_mode = mode;
+    }
+}
+
+/**
+ * 获取轴的步进模式
+ */
+uint8_t stepper_axis_get_step_mode(uint8_t axis) {
+    if (axis == STEPPER_AXIS_ROTATION) {
+        return stepper_motor_get_step_mode();
+    }
+    return (axis < STEPPER_AXIS_COUNT) ? axes[axis].step_mode : STEP_MODE_HALF;
+}
+
+/**
+ * 获取轴的绝对位置（单位随该轴的步进模式）
+ */
+int32_t stepper_axis_get_position(uint8_t axis) {
+    if (axis == STEPPER_AXIS_ROTATION) {
+        return stepper_motor_get_position();
+    }
+    if (axis >= STEPPER_AXIS_COUNT) {
+        return 0;
+    }
+
+    int32_t position;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        position = axes[axis].position;
+    }
+    return position;
+}
+
+/**
+ * 设置轴的绝对位置（不转动电机，仅修改坐标）
+ */
+void stepper_axis_set_position(uint8_t axis, int32_t position) {
+    if (axis == STEPPER_AXIS_ROTATION) {
+        stepper_motor_set_position(position);
+        return;
+    }
+    if (axis >= STEPPER_AXIS_COUNT) {
+        return;
+    }
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        axes[axis].position = position;
+    }
+}
@@ -0,0 +1,193 @@
+#include "stepper_gear.h"
+
+/**
+ * 计算 a×b÷c 的商和余数，只用32位运算（逐位累加，余数始终小于c）
+ * 要求 c < 2^31，且商不超过32位
+ * @param remainder 余数输出，可为nullptr
+ */
+uint32_t stepper_gear_muldiv(uint32_t a, uint32_t b, uint32_t c, uint32_t* remainder) {
+    uint32_t a_quot = a / c;
+    uint32_t a_rem = a % c;
+    uint32_t quot = 0;
+    uint32_t rem = 0;
+
+    for (int8_t bit = 31; bit >= 0; bit--) {
+        quot <<= 1;
+        rem <<= 1;
+        if (rem >= c) {
+            rem -= c;
+            quot++;
+        }
+        if (b & (1UL << bit)) {
+            quot += a_quot;
+            rem += a_rem;
+            if (rem >= c) {
+                rem -= c;
+                quot++;
+            }
+        }
+    }
+
+    if (remainder != nullptr) {
+        *remainder = rem;
+    }
+    return quot;
+}
+
+/**
+ * 最大公约数
+ */
+static uint32_t stepper_gear_gcd(uint32_t a, uint32_t b) {
+    while (b != 0) {
+        uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/**
+ * 计算转台每转步数
+ * @param units_per_full 每全步的步数（全步1，半步2，细分4/8/16）
+ * @param driven_teeth 转台（从动轮）齿数，直接驱动时为1
+ * @param drive_teeth 电机轴（主动轮）齿数，直接驱动时为1
+ */
+void stepper_gear_make_ratio(stepper_gear_ratio_t* ratio, uint8_t units_per_full, uint8_t driven_teeth, uint8_t drive_teeth) {
+    if (driven_teeth == 0 || driven_teeth > STEPPER_GEAR_TEETH_MAX) driven_teeth = 1;
+    if (drive_teeth == 0 || drive_teeth > STEPPER_GEAR_TEETH_MAX) drive_teeth = 1;
+
+    uint32_t num = STEPPER_GEAR_FULL_STEPS_NUM * units_per_full * driven_teeth;
+    uint32_t den = STEPPER_GEAR_FULL_STEPS_DEN * drive_teeth;
+    uint32_t divisor = stepper_gear_gcd(num, den);
+
+    ratio->num = num / divisor;
+    ratio->den = den / divisor;
+}
+
+/**
+ * 每转步数（四舍五入到整数，只用于速度换算、超时判断等不累积的场合）
+ */
+uint32_t stepper_gear_steps_per_revolution(const stepper_gear_ratio_t* ratio) {
+    return (ratio->num + ratio->den / 2) / ratio->den;
+}
+
+/**
+ * 换算余数的初值：半步，使第一次换算按四舍五入取整
+ */
+uint32_t stepper_gear_carry_init(const stepper_gear_ratio_t* ratio) {
+    return 180UL * ratio->den;
+}
+
+/**
+ * 角度换算为步数，余数（以1/(360×den)步为单位）带到下一次换算
+ * 同一个carry连续换算时，累计步数始终等于累计角度的精确步数四舍五入
+ * @param carry 余数，初值由stepper_gear_carry_init()给出
+ */
+uint32_t stepper_gear_degrees_to_steps(const stepper_gear_ratio_t* ratio, uint32_t degrees, uint32_t* carry) {
+    uint32_t scale = 360UL * ratio->den;
+    uint32_t rem;
+    uint32_t steps = stepper_gear_muldiv(degrees, ratio->num, scale, &rem);
+
+    rem += *carry;
+    if (rem >= scale) {
+        rem -= scale;
+        steps++;
+    }
+    *carry = rem;
+    return steps;
+}
+
+/**
+ * 步数换算为角度（四舍五入）
+ */
+uint32_t stepper_gear_steps_to_degrees(const stepper_gear_ratio_t* ratio, uint32_t steps) {
+    uint32_t rem;
+    uint32_t degrees = stepper_gear_muldiv(steps, 360UL * ratio->den, ratio->num, &rem);
+
+    if (rem >= ratio->num - rem) {
+        degrees++;
+    }
+    return degrees;
+}
+
+/**
+ * 绝对位置所在的圈数（向下取整）
+ * @param fraction 圈内位置，以1/den步为单位（0 ~ num-1），可为nullptr
+ */
+int32_t stepper_gear_revolution_of(const stepper_gear_ratio_t* ratio, int32_t position, uint32_t* fraction) {
+    uint32_t rem;
+    int32_t revolution;
+
+    if (position >= 0) {
+        revolution = (int32_t)stepper_gear_muldiv((uint32_t)position, ratio->den, ratio->num, &rem);
+    } else {
+        revolution = -(int32_t)stepper_gear_muldiv((uint32_t)(-position), ratio->den, ratio->num, &rem);
+        if (rem > 0) {
+            revolution--;
+            rem = ratio->num - rem;
+        }
+    }
+
+    if (fraction != nullptr) {
+        *fraction = rem;
+    }
+    return revolution;
+}
+
+/**
+ * 第revolution圈内degrees角度对应的绝对位置（四舍五入）
+ */
+int32_t stepper_gear_angle_position(const stepper_gear_ratio_t* ratio, int32_t revolution, uint16_t degrees) {
+    int32_t angle = revolution * 360L + degrees;
+    uint32_t scale = 360UL * ratio->den;
+    uint32_t magnitude = (uint32_t)(angle < 0 ? -angle : angle);
+    uint32_t rem;
+    uint32_t steps = stepper_gear_muldiv(magnitude, ratio->num, scale, &rem);
+
+    if (rem >= scale - rem) {
+        steps++;
+    }
+    return angle < 0 ? -(int32_t)steps : (int32_t)steps;
+}
+
+/**
+ * 累计转动量加上steps步（整圈进位到turns，不足一圈的余数留在offset）
+ * 每次只做一次32位乘除，步数任意大都不会溢出，累计结果与总步数÷每转步数完全相等
+ */
+void stepper_gear_travel_add(const stepper_gear_ratio_t* ratio, stepper_gear_travel_t* travel, uint32_t steps) {
+    uint32_t rem;
+    uint32_t turns = stepper_gear_muldiv(steps, ratio->den, ratio->num, &rem);
+
+    travel->offset += rem;
+    if (travel->offset >= ratio->num) {
+        travel->offset -= ratio->num;
+        turns++;
+    }
+    travel->turns += turns;
+}
+
+/**
+ * 每转步数改变（切换步进模式或齿数比）时换算圈内偏移，圈数不变
+ * 圈内比例四舍五入到新单位，误差小于1/num圈且不累积
+ */
+void stepper_gear_travel_rescale(const stepper_gear_ratio_t* from, const stepper_gear_ratio_t* to, stepper_gear_travel_t* travel) {
+    uint32_t rem;
+    uint32_t offset = stepper_gear_muldiv(travel->offset, to->num, from->num, &rem);
+
+    if (rem >= from->num - rem) {
+        offset++;
+    }
+    if (offset >= to->num) {
+        offset -= to->num;
+        travel->turns++;
+    }
+    travel->offset = offset;
+}
+
+/**
+ * 当前圈已转过的部分，按scale等分向下取整（scale=360为整度数，scale=100为百分之一圈）
+ * 与turns一起构成精确的累计量：向下取整保证不会显示成下一圈的0
+ */
+uint32_t stepper_gear_travel_fraction(const stepper_gear_ratio_t* ratio, const stepper_gear_travel_t* travel, uint32_t scale) {
+    return stepper_gear_muldiv(travel->offset, scale, ratio->num, nullptr);
+}
@@ -0,0 +1,340 @@
+#include <util/atomic.h>
+#include "stepper_home.h"
+
+// 索引边沿（引脚变化中断写入，主循环取走）
+static volatile bool index_pending = false;
+static volatile int32_t index_position = 0;
+static volatile motor_direction_t index_direction = CLOCKWISE;
+
+// 上一个有效边沿的位置，用于去抖
+static volatile bool sensor_active = false;
+static volatile bool edge_valid = false;
+static volatile int32_t edge_position = 0;
+
+// 归零状态
+static home_state_t home_state = HOME_STATE_IDLE;
+static motor_direction_t home_direction = CLOCKWISE;
+static bool home_motion_issued = false;
+static int32_t seek_start = 0;
+static bool backoff_cleared = false;        // 反向退出时传感器是否已释放
+static int32_t backoff_clear_position = 0;  // 传感器释放时的位置
+
+// 索引跟踪：索引在绝对坐标中的位置（按方向区分，传感器有宽度，两个方向触发的边沿不同）
+static bool tracking = false;
+static bool reference_valid = false;
+static int32_t reference_position = 0;
+static motor_direction_t reference_direction = CLOCKWISE;
+static stepper_gear_ratio_t reference_ratio = {0, 1};
+static int32_t last_error = 0;
+static uint16_t correction_count = 0;
+
+static void stepper_home_rearm();
+static bool stepper_home_seek_exceeded();
+static uint32_t stepper_home_backoff_shortfall();
+
+/**
+ * 计算索引边沿相对参考位置的误差
+ * 索引每圈出现一次，取与captured最近的 reference + k×每转步数 作为期望位置；
+ * 每转步数按精确分数计算，多圈后期望位置不漂移
+ * @param captured 边沿触发时的绝对位置
+ * @param reference 索引的参考位置
+ * @param ratio 每转步数
+ * @return captured - 期望位置（约 -半圈 ~ +半圈，四舍五入到整步）
+ */
+int32_t stepper_home_index_error(int32_t captured, int32_t reference, const stepper_gear_ratio_t* ratio) {
+    uint32_t fraction;
+    stepper_gear_revolution_of(ratio, captured - reference, &fraction);
+
+    if (fraction > ratio->num / 2) {
+        return -(int32_t)((ratio->num - fraction + ratio->den / 2) / ratio->den);
+    }
+    return (int32_t)((fraction + ratio->den / 2) / ratio->den);
+}
+
+/**
+ * 初始化索引传感器（上拉输入 + 引脚变化中断）
+ */
+void stepper_home_init() {
+#if HOME_SENSOR_ENABLED
+    pinMode(HOME_SENSOR_PIN, INPUT_PULLUP);
+    sensor_active = stepper_home_is_triggered();
+
+    *digitalPinToPCMSK(HOME_SENSOR_PIN) |= (1 << digitalPinToPCMSKbit(HOME_SENSOR_PIN));
+    PCICR |= (1 << digitalPinToPCICRbit(HOME_SENSOR_PIN));
+#endif
+}
+
+/**
+ * 检查传感器当前是否处于触发状态
+ */
+bool stepper_home_is_triggered() {
+    return digitalRead(HOME_SENSOR_PIN) == HOME_SENSOR_ACTIVE_LEVEL;
+}
+
+/**
+ * 开始归零（非阻塞，由stepper_home_update()推进）
+ * @param direction 寻找方向，应与之后运动的方向一致，跟踪修正只在同方向经过索引时进行
+ * @return 未安装传感器时返回false
+ */
+bool stepper_home_start(motor_direction_t direction) {
+#if HOME_SENSOR_ENABLED
+    stepper_motor_halt();
+    home_direction = direction;
+    home_motion_issued = false;
+    reference_valid = false;
+    stepper_home_rearm();
+
+    if (stepper_home_is_triggered()) {
+        // 已停在索引上，先退出再慢速逼近
+        home_state = HOME_STATE_BACKOFF;
+    } else {
+        stepper_motor_set_direction(direction);
+        stepper_motor_set_custom_speed(STEPPER_HOME_FAST_MS);
+        seek_start = stepper_motor_get_position();
+        stepper_motor_start();
+        home_state = HOME_STATE_SEEK_FAST;
+    }
+    return true;
+#else
+    (void)direction;
+    return false;
+#endif
+}
+
+/**
+ * 取消归零并停止电机
+ */
+void stepper_home_cancel() {
+    if (stepper_home_is_busy()) {
+        stepper_motor_halt();
+        home_state = HOME_STATE_IDLE;
+    }
+}
+
+/**
+ * 获取归零状态
+ */
+home_state_t stepper_home_get_state() {
+    return home_state;
+}
+
+/**
+ * 检查是否正在归零
+ */
+bool stepper_home_is_busy() {
+    return home_state != HOME_STATE_IDLE && home_state != HOME_STATE_DONE && home_state != HOME_STATE_FAILED;
+}
+
+/**
+ * 启用/关闭索引跟踪修正
+ */
+void stepper_home_enable_tracking(bool enable) {
+    tracking = enable;
+}
+
+/**
+ * 清除索引参考位置（调用方重设了绝对坐标原点时），下一次经过索引时重新记录
+ */
+void stepper_home_clear_reference() {
+    reference_valid = false;
+    stepper_home_rearm();
+}
+
+/**
+ * 获取最近一次修正的误差（步，正数表示计数比实际位置多）
+ */
+int32_t stepper_home_get_last_error() {
+    return last_error;
+}
+
+/**
+ * 获取累计修正次数
+ */
+uint16_t stepper_home_get_correction_count() {
+    return correction_count;
+}
+
+/**
+ * 更新归零和索引跟踪，在主循环中调用
+ */
+void stepper_home_update() {
+    bool pending;
+    int32_t captured;
+    motor_direction_t direction;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        pending = index_pending;
+        captured = index_position;
+        direction = index_direction;
+        index_pending = false;
+    }
+
+    switch (home_state) {
+        case HOME_STATE_SEEK_FAST:
+            if (pending) {
+                stepper_motor_stop();
+                home_motion_issued = false;
+                home_state = HOME_STATE_BACKOFF;
+            } else if (stepper_home_seek_exceeded()) {
+                stepper_motor_halt();
+                home_state = HOME_STATE_FAILED;
+            }
+            return;
+
+        case HOME_STATE_BACKOFF:
+            if (!home_motion_issued) {
+                if (stepper_motor_is_running()) return;
+                // 反向转动直到传感器释放，传感器宽度（磁铁大小、安装距离）不需要预先知道
+                stepper_motor_set_direction(home_direction == CLOCKWISE ? COUNTER_CLOCKWISE : CLOCKWISE);
+                stepper_motor_set_custom_speed(STEPPER_HOME_FAST_MS);
+                seek_start = stepper_motor_get_position();
+                backoff_cleared = false;
+                stepper_motor_start();
+                home_motion_issued = true;
+                return;
+            }
+            if (!backoff_cleared) {
+                if (stepper_home_is_triggered()) {
+                    if (stepper_home_seek_exceeded()) {
+                        // 转过一圈多仍未释放：传感器常触发或接线短路
+                        stepper_motor_halt();
+                        home_state = HOME_STATE_FAILED;
+                    }
+                    return;
+                }
+                backoff_cleared = true;
+                backoff_clear_position = stepper_motor_get_position();
+                stepper_motor_stop();
+                return;
+            }
+            if (stepper_motor_is_running()) return;
+            if (stepper_home_backoff_shortfall() > 0) {
+                // 减速停止的距离不够余量时补足，慢速逼近前确保离开边沿
+                stepper_motor_rotate_steps(stepper_home_backoff_shortfall());
+                return;
+            }
+            // 退出完成，慢速逼近同一边沿
+            stepper_home_rearm();
+            stepper_motor_set_direction(home_direction);
+            stepper_motor_set_custom_speed(STEPPER_HOME_SLOW_MS);
+            seek_start = stepper_motor_get_position();
+            stepper_motor_start();
+            home_state = HOME_STATE_SEEK_SLOW;
+            return;
+
+        case HOME_STATE_SEEK_SLOW:
+            if (pending) {
+                // 慢速下立即停止只多走几步，以边沿处的位置为原点
+                stepper_motor_halt();
+                stepper_motor_set_position(stepper_motor_get_position() - captured);
+                home_motion_issued = false;
+                home_state = HOME_STATE_CENTER;
+            } else if (stepper_home_seek_exceeded()) {
+                stepper_motor_halt();
+                home_state = HOME_STATE_FAILED;
+            }
+            return;
+
+        case HOME_STATE_CENTER:
+            if (stepper_motor_is_running()) return;
+            if (!home_motion_issued) {
+                stepper_motor_move_to_position(0);
+                home_motion_issued = true;
+                return;
+            }
+            reference_valid = true;
+            reference_position = 0;
+            reference_direction = home_direction;
+            stepper_motor_get_gear_ratio(&reference_ratio);
+            home_state = HOME_STATE_DONE;
+            return;
+
+        default:
+            break;
+    }
+
+    if (!pending || !tracking) {
+        return;
+    }
+
+    // 跟踪：首次经过索引时记录参考位置，之后同方向经过时修正绝对位置
+    stepper_gear_ratio_t ratio;
+    stepper_motor_get_gear_ratio(&ratio);
+    if (!reference_valid || reference_ratio.num != ratio.num || reference_ratio.den != ratio.den) {
+        reference_valid = true;
+        reference_position = captured;
+        reference_direction = direction;
+        reference_ratio = ratio;
+        return;
+    }
+    if (direction != reference_direction) {
+        return;
+    }
+
+    int32_t error = stepper_home_index_error(captured, reference_position, &ratio);
+    if ((uint32_t)labs(error) > stepper_gear_steps_per_revolution(&ratio) / STEPPER_HOME_MAX_CORRECTION_DIVISOR) {
+        return;
+    }
+    if (error != 0) {
+        stepper_motor_adjust_position(-error);
+    }
+    last_error = error;
+    correction_count++;
+}
+
+/**
+ * 清除去抖记录和未处理的边沿，下一个边沿立即生效
+ */
+static void stepper_home_rearm() {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        edge_valid = false;
+        index_pending = false;
+    }
+}
+
+/**
+ * 寻找索引时转过一圈多仍未触发
+ */
+static bool stepper_home_seek_exceeded() {
+    uint32_t limit = stepper_motor_get_steps_per_revolution() * 5 / 4;
+    return (uint32_t)labs(stepper_motor_get_position() - seek_start) > limit;
+}
+
+/**
+ * 传感器释放后已退出的距离距余量还差的步数
+ */
+static uint32_t stepper_home_backoff_shortfall() {
+    stepper_gear_ratio_t ratio;
+    stepper_motor_get_gear_ratio(&ratio);
+    uint32_t carry = stepper_gear_carry_init(&ratio);
+    uint32_t margin = stepper_gear_degrees_to_steps(&ratio, STEPPER_HOME_BACKOFF_MARGIN_DEGREES, &carry);
+    uint32_t travelled = (uint32_t)labs(stepper_motor_get_position() - backoff_clear_position);
+    return (travelled < margin) ? margin - travelled : 0;
+}
+
+#if HOME_SENSOR_ENABLED
+/**
+ * 引脚变化中断：PD5在端口D的PCINT2组，同组的按键引脚未启用中断屏蔽位
+ * 只取进入触发状态的边沿，锁存此刻的绝对位置和方向
+ */
+ISR(PCINT2_vect) {
+    bool active = stepper_home_is_triggered();
+    if (!active || sensor_active) {
+        sensor_active = active;
+        return;
+    }
+    sensor_active = true;
+
+    int32_t position = stepper_motor_get_position();
+    int32_t debounce = (int32_t)(stepper_motor_get_steps_per_revolution() / STEPPER_HOME_DEBOUNCE_DIVISOR);
+    if (edge_valid && labs(position - edge_position) < debounce) {
+        return;
+    }
+
+    edge_valid = true;
+    edge_position = position;
+    index_position = position;
+    index_direction = stepper_motor_get_direction();
+    index_pending = true;
+}
+#endif
@@ -0,0 +1,165 @@
+#include <util/atomic.h>
+#include "stepper_microstep.h"
+#include "stepper_axis.h"
+
+// 细分只驱动旋转轴，与全步/半步共用同一个端口和引脚绑定
+typedef stepper_rotation_coils microstep_coils;
+
+// Timer3比较值：F_CPU / 32kHz = 500个时钟一个时隙
+#define STEPPER_PWM_OCR  ((uint16_t)(F_CPU / STEPPER_PWM_SLOT_FREQ - 1))
+
+// 四分之一周期正弦表：round(32 × sin(k × 90° / 16))，k = 0..16
+static const uint8_t sine_quarter[STEPPER_MICROSTEP_PHASES_PER_FULL + 1] PROGMEM = {
+    0, 3, 6, 9, 12, 15, 18, 20, 23, 25, 27, 28, 30, 31, 31, 32, 32
+};
+
+// 各线圈占空比（0 ~ STEPPER_PWM_LEVELS），由步进中断写入，PWM中断读取
+static volatile uint8_t coil_duty[4];
+
+// 当前PWM时隙
+static volatile uint8_t pwm_slot = 0;
+
+// PWM定时器是否已开启
+static bool pwm_running = false;
+
+/**
+ * 初始化Timer3（CTC模式，暂不启动时钟）
+ */
+void stepper_microstep_init() {
+    TCCR3A = 0;
+    TCCR3B = (1 << WGM32);
+    TIMSK3 &= ~(1 << OCIE3A);
+    OCR3A = STEPPER_PWM_OCR;
+
+    for (uint8_t i = 0; i < 4; i++) {
+        coil_duty[i] = 0;
+    }
+    pwm_running = false;
+}
+
+/**
+ * 检查细分数是否有效（4、8、16）
+ */
+bool stepper_microstep_is_valid_resolution(uint8_t microsteps) {
+    return microsteps == 4 || microsteps == 8 || microsteps == 16;
+}
+
+/**
+ * 正弦值（带符号占空比），相位单位为1/16全步
+ */
+static int8_t microstep_sine(uint8_t phase) {
+    uint8_t quadrant = (phase / STEPPER_MICROSTEP_PHASES_PER_FULL) & 0x03;
+    uint8_t offset = phase % STEPPER_MICROSTEP_PHASES_PER_FULL;
+
+    // 第2、4象限镜像取表
+    if (quadrant & 0x01) {
+        offset = STEPPER_MICROSTEP_PHASES_PER_FULL - offset;
+    }
+
+    int8_t value = (int8_t)pgm_read_byte(&sine_quarter[offset]);
+    return (quadrant & 0x02) ? -value : value;
+}
+
+/**
+ * 写入四个线圈的占空比并确保PWM运行
+ */
+static void microstep_apply(uint8_t duty0, uint8_t duty1, uint8_t duty2, uint8_t duty3) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        coil_duty[0] = duty0;
+        coil_duty[1] = duty1;
+        coil_duty[2] = duty2;
+        coil_duty[3] = duty3;
+
+        if (!pwm_running) {
+            pwm_slot = 0;
+            TCNT3 = 0;
+            TIFR3 = (1 << OCF3A);
+            TIMSK3 |= (1 << OCIE3A);
+            TCCR3B = (1 << WGM32) | (1 << CS30);  // 不分频启动
+            pwm_running = true;
+        }
+    }
+}
+
+/**
+ * 按电角度设置线圈电流并确保PWM运行
+ * 线圈对应关系与全步/半步序列一致：相位0为INT1单独通电（半步序列第0步），
+ * INT1/INT3为cos正负半周，INT2/INT4为sin正负半周
+ * @param phase 电角度（0 ~ 63，1/16全步）
+ * @param amplitude 电流幅值（0 ~ STEPPER_PWM_LEVELS），运转时为满幅，保持时降低
+ */
+void stepper_microstep_set_phase(uint8_t phase, uint8_t amplitude) {
+    phase %= STEPPER_MICROSTEP_PHASES;
+    int8_t sine = microstep_sine(phase);
+    int8_t cosine = microstep_sine(phase + STEPPER_MICROSTEP_PHASES_PER_FULL);
+    uint8_t sine_abs = (uint8_t)((sine < 0) ? -sine : sine);
+    uint8_t cosine_abs = (uint8_t)((cosine < 0) ? -cosine : cosine);
+
+    if (amplitude < STEPPER_PWM_LEVELS) {
+        sine_abs = (uint16_t)sine_abs * amplitude / STEPPER_PWM_LEVELS;
+        cosine_abs = (uint16_t)cosine_abs * amplitude / STEPPER_PWM_LEVELS;
+    }
+
+    microstep_apply((cosine > 0) ? cosine_abs : 0,
+                    (sine > 0) ? sine_abs : 0,
+                    (cosine < 0) ? cosine_abs : 0,
+                    (sine < 0) ? sine_abs : 0);
+}
+
+/**
+ * 以指定占空比保持全步/半步序列中的线圈组合
+ * @param step_pattern 线圈组合（bit0-3对应INT1-INT4）
+ * @param duty 占空比（0 ~ STEPPER_PWM_LEVELS）
+ */
+void stepper_microstep_hold_pattern(uint8_t step_pattern, uint8_t duty) {
+    microstep_apply((step_pattern & 0x01) ? duty : 0,
+                    (step_pattern & 0x02) ? duty : 0,
+                    (step_pattern & 0x04) ? duty : 0,
+                    (step_pattern & 0x08) ? duty : 0);
+}
+
+/**
+ * 停止PWM并断开所有线圈
+ */
+void stepper_microstep_release() {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        TCCR3B = (1 << WGM32);
+        TIMSK3 &= ~(1 << OCIE3A);
+        pwm_running = false;
+
+        for (uint8_t i = 0; i < 4; i++) {
+            coil_duty[i] = 0;
+        }
+        microstep_coils::release();
+    }
+}
+
+/**
+ * 获取线圈当前占空比（0 ~ STEPPER_PWM_LEVELS）
+ * @param coil 线圈编号（0-3，对应INT1-INT4）
+ */
+uint8_t stepper_microstep_get_duty(uint8_t coil) {
+    return (coil < 4) ? coil_duty[coil] : 0;
+}
+
+/**
+ * Timer3比较匹配中断：软件PWM时隙
+ * 时隙号小于占空比的线圈通电，32个时隙构成一个PWM周期
+ * 约60个时钟（含入栈出栈），32kHz下占用约12%的CPU
+ */
+ISR(TIMER3_COMPA_vect) {
+    uint8_t slot = pwm_slot;
+    uint8_t output = 0;
+
+    if (slot < coil_duty[0]) output |= 0x01;
+    if (slot < coil_duty[1]) output |= 0x02;
+    if (slot < coil_duty[2]) output |= 0x04;
+    if (slot < coil_duty[3]) output |= 0x08;
+
+    microstep_coils::write_pattern(output);
+
+    if (++slot >= STEPPER_PWM_LEVELS) {
+        slot = 0;
+    }
+    pwm_slot = slot;
+}
@@ -1,8 +1,17 @@
 #include <Arduino.h>
+#include <util/atomic.h>
 #include "stepper_motor.h"
+#include "stepper_ramp.h"
+#include "stepper_microstep.h"
+#include "stepper_queue.h"
+#include "stepper_timing.h"
+#include "stepper_stall.h"
 
-// 步进电机全局状态
-static stepper_motor_t motor_state;
+// 步进电机全局状态（与Timer1中断共享）
+static volatile stepper_motor_t motor_state;
+
+// 加减速曲线状态（仅在Timer1中断或ATOMIC_BLOCK内访问）
+static stepper_ramp_t ramp;
 
 // 速度延时配置 (微秒) - 优化为平滑运行和降低发热
 static const unsigned long speed_delays[] = {
@@ -10,35 +19,174 @@ static const unsigned long speed_delays[] = {
     2000    // SPEED_HIGH: 2ms延时 (1250步/秒，快速但平滑)
 };
 
-// 自定义速度延时 (微秒)
-static unsigned long custom_speed_delay = 4000;  // 默认4ms
+// 自定义每全步间隔（定时器tick的Q8定点数，低8位为1/256 tick），0表示使用预设速度
+// 按全步保存，切换步进模式时转速不变
+static uint32_t custom_interval_q8 = (uint32_t)STEPPER_US_TO_TICKS(4000) << 8;  // 默认4ms
+
+// 自动步进模式：当前是否以全步驱动（只在奇数半步位置，即双线圈组合处更新线圈）
+static volatile bool full_drive = false;
+
+// 切换步进模式时绝对位置换算余下的不足一步部分（1/16全步），换回更细的模式时补回，往返换算不丢步
+static uint8_t position_fraction = 0;
+
+// 自动步进模式的驱动切换间隔（半步间隔，tick）
+#define AUTO_FULL_ENTER_TICKS  ((uint16_t)(STEPPER_TIMER_FREQ / (2UL * STEPPER_AUTO_FULL_ENTER_SPS)))
+#define AUTO_FULL_EXIT_TICKS   ((uint16_t)(STEPPER_TIMER_FREQ / (2UL * STEPPER_AUTO_FULL_EXIT_SPS)))
 
-// 步数计数器
+static_assert(STEPPER_THERMAL_DERATE_FSPS < STEPPER_AUTO_FULL_EXIT_SPS, "thermal derating must keep auto mode in half drive");
+
+static void stepper_motor_refresh_interval();
+static void stepper_timer_start(uint16_t first_delay);
+static void stepper_timer_stop();
+static uint8_t stepper_motor_units_per_full(step_mode_t mode, uint8_t microsteps);
+static uint8_t stepper_motor_phase_of(step_mode_t mode, uint8_t microsteps, int step);
+static int stepper_motor_step_of(step_mode_t mode, uint8_t microsteps, uint8_t phase);
+static void stepper_motor_rescale_position(uint8_t old_units, uint8_t new_units);
+
+// 步数计数器：中断只累加未结算的步数，主循环结算为圈数+圈内偏移（单位随当前每转步数）
 static volatile uint32_t step_counter = 0;
+static stepper_gear_travel_t travel = {0, 0};
 
-// 28BYJ-48 半步序列 (8步，平滑但扭矩较小)
-static const uint8_t step_sequence_half[STEP_SEQUENCE_LENGTH_HALF] = {
-    0b0001,  // 0001
-    0b0011,  // 0011
-    0b0010,  // 0010
-    0b0110,  // 0110
-    0b0100,  // 0100
-    0b1100,  // 1100
-    0b1000,  // 1000
-    0b1001   // 1001
-};
+// 转台每转步数（精确分数，随步进模式和皮带齿数比更新）
+static stepper_gear_ratio_t gear_ratio = {STEPPER_GEAR_FULL_STEPS_NUM, STEPPER_GEAR_FULL_STEPS_DEN};
+static uint8_t belt_driven_teeth = 1;
+static uint8_t belt_drive_teeth = 1;
 
-// 28BYJ-48 全步序列 (4步，扭矩更大)
-static const uint8_t step_sequence_full[STEP_SEQUENCE_LENGTH_FULL] = {
-    0b0011,  // 线圈1+2同时通电
-    0b0110,  // 线圈2+3同时通电
-    0b1100,  // 线圈3+4同时通电
-    0b1001   // 线圈4+1同时通电
-};
+static void stepper_motor_refresh_gear();
+static void stepper_motor_settle_travel();
 
 // 高扭矩模式标志
 static bool high_torque_mode = false;
 
+// 减流保持参数（占空比为PWM级数，0表示运动结束后直接断电）
+static uint8_t hold_duty_level = 0;
+static uint16_t hold_timeout_ms = 0;
+
+// 减流保持状态（由Timer1中断进入，主循环超时释放）
+static volatile bool hold_active = false;
+static volatile unsigned long hold_start_time = 0;
+
+static void stepper_motor_finish_move();
+static void stepper_motor_enter_hold();
+static void stepper_motor_end_hold();
+
+// 队列停留段状态（dwell_ticks为当前比较周期之后还需等待的tick数）
+static volatile bool dwelling = false;
+static volatile uint32_t dwell_ticks = 0;
+
+// 前瞻衔接：当前加减速曲线已覆盖的后续转动段数，这些段之间不减速
+static volatile uint8_t blended_segments = 0;
+
+// 齿轮间隙补偿：换向后先以固定速率空转backlash步消除间隙，不计入绝对位置
+static uint8_t backlash_full_steps = 0;
+static bool backlash_side_known = false;
+static motor_direction_t backlash_side = CLOCKWISE;
+static volatile uint16_t takeup_remaining = 0;
+static volatile uint16_t takeup_next_delay = 0;
+
+// 起步预励磁：线圈是否以满电流输出当前相位（断电、减流保持后为false）
+static volatile bool coils_locked = false;
+static uint16_t lock_in_ticks = (uint16_t)(STEPPER_LOCK_IN_MS * STEPPER_TICKS_PER_MS);
+static volatile uint16_t lock_in_next_delay = 0;    // 锁定周期结束后的第一个间隔，0表示不在锁定中
+
+static_assert((uint32_t)STEPPER_LOCK_IN_MAX_MS * STEPPER_TICKS_PER_MS <= 0xFFFF, "lock-in must fit one Timer1 compare period");
+
+// 共振禁区（全步/秒），按当前步进模式换算为步进间隔后交给加减速曲线
+static uint16_t band_min_fsps[STEPPER_RAMP_MAX_BANDS];
+static uint16_t band_max_fsps[STEPPER_RAMP_MAX_BANDS];
+
+static void stepper_motor_apply_bands();
+
+// 供电电压调速曲线（电压mV升序；最高转速为全步/秒，最高加速度为全步/秒²）
+// 默认值按5V供电的28BYJ-48：5.0V时不限制2ms预设和默认加速度，电压下降时按比例收紧
+static uint16_t governor_mv[STEPPER_GOVERNOR_POINTS]    = { 4300, 4700, 5000, 5300 };
+static uint16_t governor_fsps[STEPPER_GOVERNOR_POINTS]  = {  250,  380,  500,  600 };
+static uint16_t governor_accel[STEPPER_GOVERNOR_POINTS] = {  800, 1400, 2000, 2500 };
+
+// 当前电压对应的限制（0表示未测得电压，不限制）
+static uint16_t supply_mv = 0;
+static uint16_t governor_limit_fsps = 0;
+static uint16_t governor_limit_accel = 0;
+
+// 用户设置的加速度（步/秒²），实际加速度取它和电压限制中较小的一个
+static uint16_t user_acceleration = STEPPER_DEFAULT_ACCELERATION;
+
+static volatile bool acceleration_pending = false;
+
+// 运行中设置的加加速度和速度曲线，在下一次运动开始时（或停止后）写入加减速曲线
+static volatile bool jerk_pending = false;
+static uint16_t pending_jerk = STEPPER_DEFAULT_JERK;
+static volatile bool profile_pending = false;
+static motion_profile_t pending_profile = PROFILE_TRAPEZOID;
+
+// 运行中设置的方向在当前运动停止后生效，不在转动中途换向
+static volatile bool direction_pending = false;
+static volatile motor_direction_t pending_direction = CLOCKWISE;
+
+// 运行中收到的运动命令：当前运动减速停止后由中断从静止开始执行
+static volatile bool deferred_pending = false;
+static bool deferred_absolute = false;      // true表示移动到绝对位置deferred_target
+static uint32_t deferred_steps = 0;         // 相对运动步数，STEPPER_RAMP_UNLIMITED表示连续转动
+static int32_t deferred_target = 0;
+
+// 线圈温升模型（°C×256），按主循环测得的通电量积分
+static int32_t thermal_rise_q8 = 0;
+static int32_t thermal_rest = 0;                // 温升积分的除法余数，累积到下一周期以消除截断误差
+static uint32_t thermal_energy = 0;             // 本周期内的通电量累计（线圈数Q8×毫秒）
+static unsigned long thermal_last_sample = 0;
+static uint32_t thermal_period_ms = 0;          // 本周期已累计的时长（毫秒）
+static bool thermal_derated = false;
+static bool thermal_cooling = false;
+
+// 运动事件：中断中置位，主循环取走后调用回调
+static volatile uint8_t pending_events = 0;
+static stepper_event_callback_t event_callback = nullptr;
+
+static void stepper_motor_update_thermal();
+static uint16_t stepper_motor_coil_load();
+
+static void stepper_motor_evaluate_governor();
+static void stepper_motor_apply_acceleration();
+static uint16_t stepper_motor_governed_acceleration();
+
+// 多轴联动：每次中断为一个插补节拍，步数最多的轴每拍走一步，
+// 其余轴由Bresenham累加器决定是否走步（步数单位随各轴的步进模式）
+static volatile bool coordinated = false;
+static uint16_t coord_steps[STEPPER_AXIS_COUNT];
+static int16_t coord_error[STEPPER_AXIS_COUNT];
+static bool coord_forward[STEPPER_AXIS_COUNT];
+static uint16_t coord_events = 0;
+static volatile uint16_t coord_rotation_done = 0;   // 联动中旋转轴已走的步数（插补节拍数另计）
+
+static void stepper_motor_step_axes();
+static void stepper_motor_release_axes();
+
+static uint16_t stepper_motor_begin_move(uint16_t first_delay);
+static bool stepper_motor_defer_move(uint32_t steps, bool absolute, int32_t target);
+static uint16_t stepper_motor_start_deferred();
+static void stepper_motor_apply_pending();
+static inline void stepper_motor_take_direction();
+static uint16_t stepper_motor_takeup_interval();
+static uint16_t stepper_motor_lock_in(uint16_t first_delay);
+static void stepper_motor_advance_sequence();
+static void stepper_motor_bind_output();
+
+// 当前步进模式的线圈输出函数和序列长度掩码（序列长度都是2的幂）
+// 只在切换步进模式或细分数时选定，步进中断内不再判断模式
+typedef void (*stepper_output_t)(uint8_t step);
+static volatile stepper_output_t coil_output;
+static volatile uint8_t sequence_mask = STEP_SEQUENCE_LENGTH_FULL - 1;
+static inline void stepper_motor_select_drive(uint16_t next_delay);
+static inline uint8_t stepper_motor_pattern_class();
+
+static uint16_t stepper_motor_load_next_segment();
+static uint8_t stepper_motor_plan_junctions(const motion_segment_t* first, uint32_t* total_steps);
+static uint8_t stepper_motor_scan_junctions(uint8_t profile, uint8_t skip, uint32_t* total_steps);
+static void stepper_motor_extend_blend();
+static bool stepper_motor_continue_blended();
+static uint16_t stepper_motor_next_dwell_chunk();
+static bool stepper_motor_queue_segment(uint8_t type, uint8_t arg, uint32_t value);
+
 /**
  * 初始化步进电机
  */
@@ -47,26 +195,56 @@ void stepper_motor_init() {
     MCUSR = 0xff;
     MCUSR = 0xff;
 
-    // 设置PE0-PE3为输出模式
-    DDRE |= (1 << PE0) | (1 << PE1) | (1 << PE2) | (1 << PE3);
+    // 设置所有轴的线圈引脚为输出模式并初始化为低电平（旋转轴PE0-PE3，俯仰轴PB2-PB5）
+    stepper_axis_init();
+
+    // Timer1: CTC模式，暂不启动时钟，由stepper_timer_start()开启
+    TCCR1A = 0;
+    TCCR1B = (1 << WGM12);
+    TIMSK1 &= ~(1 << OCIE1A);
+
+    // Timer3: 细分模式的线圈PWM
+    stepper_microstep_init();
 
-    // 初始化所有引脚为低电平
-    PORTE &= ~((1 << PE0) | (1 << PE1) | (1 << PE2) | (1 << PE3));
+    // Timer1比较B + ADC: 步进同步的电流采样
+    stepper_stall_init();
 
     // 初始化电机状态
     motor_state.current_step = 0;
+    motor_state.position = 0;
+    position_fraction = 0;
     motor_state.direction = CLOCKWISE;
     motor_state.speed = SPEED_LOW;
     motor_state.step_mode = STEP_MODE_FULL;
+    motor_state.microsteps = STEPPER_MICROSTEP_DEFAULT;
+    stepper_motor_bind_output();
+    stepper_motor_refresh_gear();
     motor_state.is_running = false;
-    motor_state.last_step_time = 0;
     motor_state.target_steps = 0;
     motor_state.remaining_steps = 0;
 
+    // 上电时齿轮间隙的状态未知，第一次运动不补偿
+    backlash_side_known = false;
+
     // 禁用高扭矩模式以降低发热
     high_torque_mode = false;
+    stepper_motor_refresh_interval();
+
+    ramp.phase = RAMP_STOP;
+    stepper_ramp_set_acceleration(&ramp, STEPPER_DEFAULT_ACCELERATION);
+    stepper_ramp_set_jerk(&ramp, STEPPER_DEFAULT_JERK);
+    stepper_ramp_set_profile(&ramp, PROFILE_TRAPEZOID);
 
-    stepper_motor_stop();
+    // 线圈温升模型从环境温度开始
+    thermal_rise_q8 = 0;
+    thermal_rest = 0;
+    thermal_energy = 0;
+    thermal_last_sample = millis();
+    thermal_period_ms = 0;
+    thermal_derated = false;
+    thermal_cooling = false;
+
+    stepper_motor_halt();
 }
 
 /**
@@ -74,26 +252,336 @@ void stepper_motor_init() {
  */
 void stepper_motor_set_speed(motor_speed_t speed) {
     motor_state.speed = speed;
+    stepper_motor_refresh_interval();
 }
 
 /**
  * 设置自定义电机速度
- * @param delay_ms 步进间隔时间（毫秒）
+ * @param delay_ms 每全步间隔时间（毫秒），半步/自动/细分模式按每全步步数折算
  */
 void stepper_motor_set_custom_speed(uint8_t delay_ms) {
     // 限制范围在2-100ms之间
     if (delay_ms < 2) delay_ms = 2;
     if (delay_ms > 100) delay_ms = 100;
 
-    // 转换为微秒
-    custom_speed_delay = (unsigned long)delay_ms * 1000;
+    // 转换为定时器tick（Q8）
+    custom_interval_q8 = (uint32_t)STEPPER_US_TO_TICKS((unsigned long)delay_ms * 1000) << 8;
+    stepper_motor_refresh_interval();
+}
+
+/**
+ * 按步/秒设置电机速度（DDA小数步进）
+ * 间隔的小数部分由巡航相位累加器分摊到各步，平均速度精确到1/256 tick
+ * @param sps_q8 速度（步/秒×256，步的含义随当前步进模式）
+ */
+void stepper_motor_set_speed_sps(uint32_t sps_q8) {
+    if (sps_q8 > (uint32_t)STEPPER_MAX_SPEED_SPS << 8) sps_q8 = (uint32_t)STEPPER_MAX_SPEED_SPS << 8;
+    if (sps_q8 < (uint32_t)STEPPER_MIN_SPEED_SPS << 8) sps_q8 = (uint32_t)STEPPER_MIN_SPEED_SPS << 8;
+
+    // interval_q8 = F × 65536 / sps_q8，分两次除法避免32位溢出
+    uint32_t dividend = STEPPER_TIMER_FREQ * 256UL;
+    uint32_t quotient = dividend / sps_q8;
+    uint32_t remainder = dividend % sps_q8;
+    uint32_t interval_q8 = (quotient << 8) + (remainder << 8) / sps_q8;
+
+    // 16位比较寄存器上限
+    if (interval_q8 > 0xFFFFUL << 8) interval_q8 = 0xFFFFUL << 8;
+
+    // 换算为每全步间隔保存
+    custom_interval_q8 = interval_q8 * stepper_motor_units_per_full(motor_state.step_mode, motor_state.microsteps);
+    stepper_motor_refresh_interval();
+}
+
+/**
+ * 按角速度设置电机速度
+ * @param deg_per_s_x10 输出轴角速度（度/秒×10）
+ */
+void stepper_motor_set_angular_speed(uint16_t deg_per_s_x10) {
+    if (deg_per_s_x10 > 3600) deg_per_s_x10 = 3600;
+
+    // sps × 256 = deg_x10 / 3600 × (num/den) × 256 = deg_x10 × 32 × num / (450 × den)
+    uint32_t sps_q8 = stepper_gear_muldiv((uint32_t)deg_per_s_x10 * 32UL, gear_ratio.num, 450UL * gear_ratio.den, nullptr);
+    stepper_motor_set_speed_sps(sps_q8);
+}
+
+/**
+ * 根据速度配置重新计算步进间隔（定时器tick）
+ * 运行中调用时，新间隔从下一步开始生效
+ */
+static void stepper_motor_refresh_interval() {
+    // 优先使用自定义速度，如果没有设置则使用预设速度
+    uint32_t interval_q8 = (custom_interval_q8 > 0) ?
+        custom_interval_q8 : (uint32_t)STEPPER_US_TO_TICKS(speed_delays[motor_state.speed]) << 8;
+
+    // 每全步间隔折算为当前步进模式的每步间隔
+    uint8_t units = stepper_motor_units_per_full(motor_state.step_mode, motor_state.microsteps);
+    interval_q8 /= units;
+
+    // 供电电压和线圈温升限制的最高转速
+    uint16_t limit_fsps = governor_limit_fsps;
+    if (thermal_derated && (limit_fsps == 0 || limit_fsps > STEPPER_THERMAL_DERATE_FSPS)) {
+        limit_fsps = STEPPER_THERMAL_DERATE_FSPS;
+    }
+    uint32_t limit_q8 = 0;
+    if (limit_fsps > 0) {
+        limit_q8 = (STEPPER_TIMER_FREQ << 8) / ((uint32_t)limit_fsps * units);
+        if (interval_q8 < limit_q8) interval_q8 = limit_q8;
+    }
+
+    if (interval_q8 > 0xFFFFUL << 8) interval_q8 = 0xFFFFUL << 8;
+    if (interval_q8 < 1UL << 8) interval_q8 = 1UL << 8;
+
+    uint16_t interval = (uint16_t)(interval_q8 >> 8);
+    uint8_t fraction = (uint8_t)interval_q8;
+
+    // 巡航速度不允许落在共振禁区内，移到较近的禁区边缘；快侧边缘超过转速上限时取慢侧
+    uint16_t avoided = stepper_ramp_avoid_bands(&ramp, interval, 0);
+    if (avoided < interval && ((uint32_t)avoided << 8) < limit_q8) {
+        avoided = stepper_ramp_avoid_bands(&ramp, interval, 1);
+    }
+    if (avoided != interval) {
+        interval = avoided;
+        fraction = 0;
+    }
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        motor_state.step_interval = interval;
+        stepper_ramp_set_cruise_fraction(&ramp, fraction);
+        if (motor_state.is_running) {
+            if (stepper_ramp_set_cruise(&ramp, interval)) {
+                stepper_stall_begin_move(); // 巡航速度改变，电流基线需要重新学习
+            }
+        }
+    }
+}
+
+/**
+ * 设置共振禁区
+ * 巡航速度落在禁区内时移到较近的边缘，加减速经过禁区时直接跳过
+ * @param index 禁区编号（0 ~ STEPPER_RAMP_MAX_BANDS-1）
+ * @param min_full_sps 禁区下限（全步/秒），与上限都为0表示关闭
+ * @param max_full_sps 禁区上限（全步/秒）
+ */
+void stepper_motor_set_resonance_band(uint8_t index, uint16_t min_full_sps, uint16_t max_full_sps) {
+    if (index >= STEPPER_RAMP_MAX_BANDS) return;
+    if (min_full_sps > max_full_sps || (min_full_sps == 0 && max_full_sps != 0)) return;
+
+    band_min_fsps[index] = min_full_sps;
+    band_max_fsps[index] = max_full_sps;
+    stepper_motor_apply_bands();
+    stepper_motor_refresh_interval();
+}
+
+/**
+ * 按当前步进模式把共振禁区换算为步进间隔（tick）
+ */
+static void stepper_motor_apply_bands() {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        uint32_t units = stepper_motor_units_per_full(motor_state.step_mode, motor_state.microsteps);
+
+        for (uint8_t i = 0; i < STEPPER_RAMP_MAX_BANDS; i++) {
+            if (band_max_fsps[i] == 0) {
+                stepper_ramp_set_band(&ramp, i, 0, 0);
+                continue;
+            }
+            uint32_t low_delay = STEPPER_TIMER_FREQ / ((uint32_t)band_max_fsps[i] * units);
+            uint32_t high_delay = STEPPER_TIMER_FREQ / ((uint32_t)band_min_fsps[i] * units);
+            if (high_delay > 0xFFFF) high_delay = 0xFFFF;
+            stepper_ramp_set_band(&ramp, i, (uint16_t)low_delay, (uint16_t)high_delay);
+        }
+    }
+}
+
+/**
+ * 设置加减速度
+ * @param acceleration 加速度（步/秒²），运行中设置时从下一次启动开始生效
+ */
+void stepper_motor_set_acceleration(uint16_t acceleration) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        user_acceleration = acceleration;
+    }
+    stepper_motor_apply_acceleration();
+}
+
+/**
+ * 更新供电电压（主循环每次采样后调用），重新计算限制并立即作用于巡航速度
+ * 连续转动中按新的巡航速度加减速；计数运动只立即降速，提速和加速度的限制从下一次运动开始生效
+ * @param millivolts 电机供电电压（mV），低于STEPPER_GOVERNOR_MIN_MV表示未知，不限制
+ */
+void stepper_motor_set_supply_voltage(uint16_t millivolts) {
+    supply_mv = (millivolts < STEPPER_GOVERNOR_MIN_MV) ? 0 : millivolts;
+    stepper_motor_evaluate_governor();
+}
+
+/**
+ * 设置调速曲线的一个点
+ * @param index 曲线点编号（0 ~ STEPPER_GOVERNOR_POINTS-1），各点电压需升序
+ * @param millivolts 电压（mV）
+ * @param max_full_sps 该电压下的最高转速（全步/秒）
+ * @param max_full_accel 该电压下的最高加速度（全步/秒²）
+ */
+void stepper_motor_set_governor_point(uint8_t index, uint16_t millivolts, uint16_t max_full_sps, uint16_t max_full_accel) {
+    if (index >= STEPPER_GOVERNOR_POINTS || max_full_sps == 0 || max_full_accel == 0) return;
+
+    governor_mv[index] = millivolts;
+    governor_fsps[index] = max_full_sps;
+    governor_accel[index] = max_full_accel;
+    stepper_motor_evaluate_governor();
+}
+
+/**
+ * 获取当前电压下的最高转速限制（全步/秒），0表示不限制
+ */
+uint16_t stepper_motor_get_governor_limit() {
+    return governor_limit_fsps;
+}
+
+/**
+ * 按当前电压在曲线上插值，得到最高转速和加速度限制
+ */
+static void stepper_motor_evaluate_governor() {
+    uint16_t limit_fsps = 0;
+    uint16_t limit_accel = 0;
+
+    if (supply_mv > 0) {
+        if (supply_mv <= governor_mv[0]) {
+            limit_fsps = governor_fsps[0];
+            limit_accel = governor_accel[0];
+        } else if (supply_mv >= governor_mv[STEPPER_GOVERNOR_POINTS - 1]) {
+            limit_fsps = governor_fsps[STEPPER_GOVERNOR_POINTS - 1];
+            limit_accel = governor_accel[STEPPER_GOVERNOR_POINTS - 1];
+        } else {
+            uint8_t i = 1;
+            while (supply_mv > governor_mv[i]) i++;
+
+            // 在第i-1点和第i点之间线性插值
+            uint16_t span = governor_mv[i] - governor_mv[i - 1];
+            uint16_t offset = supply_mv - governor_mv[i - 1];
+            limit_fsps = governor_fsps[i - 1] +
+                         (int32_t)((int32_t)governor_fsps[i] - governor_fsps[i - 1]) * offset / span;
+            limit_accel = governor_accel[i - 1] +
+                          (int32_t)((int32_t)governor_accel[i] - governor_accel[i - 1]) * offset / span;
+        }
+    }
+
+    if (limit_fsps == governor_limit_fsps && limit_accel == governor_limit_accel) {
+        return;
+    }
+
+    governor_limit_fsps = limit_fsps;
+    governor_limit_accel = limit_accel;
+    stepper_motor_refresh_interval();
+
+    stepper_motor_apply_acceleration();
+}
+
+/**
+ * 把实际加速度写入加减速曲线，电机运行中则等停止后由stepper_motor_update()或下一次起步时写入
+ */
+static void stepper_motor_apply_acceleration() {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (motor_state.is_running) {
+            acceleration_pending = true;
+        } else {
+            stepper_ramp_set_acceleration(&ramp, stepper_motor_governed_acceleration());
+            acceleration_pending = false;
+        }
+    }
+}
+
+/**
+ * 实际使用的加速度（步/秒²）：用户设置与电压限制中较小的一个
+ */
+static uint16_t stepper_motor_governed_acceleration() {
+    if (governor_limit_accel == 0) {
+        return user_acceleration;
+    }
+
+    uint32_t limit = (uint32_t)governor_limit_accel *
+                     stepper_motor_units_per_full(motor_state.step_mode, motor_state.microsteps);
+    return (limit < user_acceleration) ? (uint16_t)limit : user_acceleration;
+}
+
+/**
+ * 设置S曲线加加速度
+ * @param jerk 加加速度（步/秒³），从下一次启动开始生效
+ */
+void stepper_motor_set_jerk(uint16_t jerk) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (motor_state.is_running) {
+            pending_jerk = jerk;
+            jerk_pending = true;
+        } else {
+            stepper_ramp_set_jerk(&ramp, jerk);
+            jerk_pending = false;
+        }
+    }
+}
+
+/**
+ * 设置速度曲线类型（梯形/S曲线），从下一次启动开始生效
+ */
+void stepper_motor_set_motion_profile(motion_profile_t profile) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (motor_state.is_running) {
+            pending_profile = profile;
+            profile_pending = true;
+        } else {
+            stepper_ramp_set_profile(&ramp, profile);
+            profile_pending = false;
+        }
+    }
+}
+
+/**
+ * 获取速度曲线类型
+ */
+motion_profile_t stepper_motor_get_motion_profile() {
+    return ramp.profile;
+}
+
+/**
+ * 获取加减速度（步/秒²）
+ */
+uint16_t stepper_motor_get_acceleration() {
+    uint16_t acceleration;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        acceleration = ramp.acceleration;
+    }
+    return acceleration;
 }
 
 /**
  * 设置电机转动方向
+ * 运行中设置时不立即换向，当前运动停止后（或下一条运动命令减速停止后）生效
  */
 void stepper_motor_set_direction(motor_direction_t direction) {
-    motor_state.direction = direction;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (motor_state.is_running && !dwelling) {
+            pending_direction = direction;
+            direction_pending = (direction != motor_state.direction);
+        } else {
+            motor_state.direction = direction;
+            direction_pending = false;
+        }
+    }
+}
+
+/**
+ * 运动停止后写入运行中设置的方向（在中断或ATOMIC_BLOCK内调用）
+ */
+static inline void stepper_motor_take_direction() {
+    if (direction_pending) {
+        motor_state.direction = pending_direction;
+        direction_pending = false;
+    }
+}
+
+/**
+ * 获取转动方向
+ */
+motor_direction_t stepper_motor_get_direction() {
+    return motor_state.direction;
 }
 
 /**
@@ -102,169 +590,1447 @@ void stepper_motor_set_direction(motor_direction_t direction) {
  */
 void stepper_motor_rotate_angle(float angle) {
     // 根据步进模式计算需要的步数
-    int steps_per_rev = (motor_state.step_mode == STEP_MODE_FULL) ?
-                        STEPS_PER_REVOLUTION_FULL : STEPS_PER_REVOLUTION_HALF;
-    int steps = (int)((angle / 360.0) * steps_per_rev);
+    long steps_per_rev = stepper_motor_get_steps_per_revolution();
+    int32_t steps = (int32_t)((angle / 360.0) * steps_per_rev);
 
     // 根据角度符号设置方向
     if (steps < 0) {
-        motor_state.direction = COUNTER_CLOCKWISE;
+        stepper_motor_set_direction(COUNTER_CLOCKWISE);
         steps = -steps;
     } else {
-        motor_state.direction = CLOCKWISE;
+        stepper_motor_set_direction(CLOCKWISE);
     }
 
     stepper_motor_rotate_steps(steps);
 }
 
 /**
- * 旋转指定步数
+ * 旋转指定步数（梯形加减速）
+ * 运行中调用时先按加速度减速停止，再从静止开始新的运动
  */
-void stepper_motor_rotate_steps(int steps) {
+void stepper_motor_rotate_steps(int32_t steps) {
     if (steps <= 0) return;
 
-    motor_state.target_steps = steps;
-    motor_state.remaining_steps = steps;
-    motor_state.is_running = true;
-    motor_state.last_step_time = micros();
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        // 直接运动命令取消运动段队列
+        stepper_queue_clear();
+        blended_segments = 0;
+
+        if (stepper_motor_defer_move((uint32_t)steps, false, 0)) {
+            return;
+        }
+
+        if (coordinated) {
+            stepper_motor_release_axes();
+        }
+        stepper_motor_take_direction();
+        stepper_motor_apply_pending();
+
+        motor_state.target_steps = steps;
+        motor_state.remaining_steps = steps;
+        uint16_t first_delay = stepper_ramp_plan(&ramp, steps, motor_state.step_interval);
+        stepper_motor_end_hold();
+        dwelling = false;
+        motor_state.is_running = true;
+        stepper_timer_start(stepper_motor_begin_move(first_delay));
+    }
 }
 
 /**
- * 启动电机连续转动
+ * 启动电机连续转动（加速到设定速度）
  */
 void stepper_motor_start() {
-    motor_state.is_running = true;
-    motor_state.remaining_steps = -1; // -1表示连续转动
-    motor_state.last_step_time = micros();
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        stepper_queue_clear();
+        blended_segments = 0;
+
+        // 换向或正在减速停止：停止后再从静止开始连续转动
+        if (direction_pending || ramp.phase == RAMP_DECEL) {
+            if (stepper_motor_defer_move(STEPPER_RAMP_UNLIMITED, false, 0)) {
+                return;
+            }
+        }
+
+        motor_state.remaining_steps = -1; // -1表示连续转动
+        if (!motor_state.is_running || dwelling || direction_pending) {
+            if (coordinated) {
+                stepper_motor_release_axes();
+            }
+            stepper_motor_take_direction();
+            stepper_motor_apply_pending();
+            uint16_t first_delay = stepper_ramp_plan(&ramp, STEPPER_RAMP_UNLIMITED, motor_state.step_interval);
+            stepper_motor_end_hold();
+            dwelling = false;
+            motor_state.is_running = true;
+            stepper_timer_start(stepper_motor_begin_move(first_delay));
+        } else {
+            // 正在执行计数运动，取消其减速点，转为连续转动
+            coordinated = false;
+            ramp.decel_start = STEPPER_RAMP_UNLIMITED;
+        }
+    }
 }
 
 /**
- * 停止电机
+ * 运行中收到新的运动命令（在ATOMIC_BLOCK内调用）
+ * 从c0重新规划会让巡航中的电机突然降到起步速度，换向更是在高速下直接反转，都会失步。
+ * 改为按加速度减速停止，停止后由中断从静止开始新的运动（换向时先消除间隙）
+ * @param steps 相对运动步数，STEPPER_RAMP_UNLIMITED表示连续转动
+ * @param absolute true表示移动到绝对位置target，步数和方向在停止后按实际位置计算
+ * @return false 表示电机静止或当前速度无需减速，调用方直接从静止起步
  */
-void stepper_motor_stop() {
-    motor_state.is_running = false;
-    motor_state.remaining_steps = 0;
+static bool stepper_motor_defer_move(uint32_t steps, bool absolute, int32_t target) {
+    if (!motor_state.is_running || dwelling || takeup_remaining > 0 || !stepper_ramp_begin_stop(&ramp)) {
+        return false;
+    }
+
+    stepper_queue_clear();
+    blended_segments = 0;
+    motor_state.remaining_steps = -1;   // 由加减速曲线决定停止点
 
-    // 关闭所有引脚
-    PORTE &= ~((1 << PE0) | (1 << PE1) | (1 << PE2) | (1 << PE3));
+    deferred_steps = steps;
+    deferred_absolute = absolute;
+    deferred_target = target;
+    deferred_pending = true;
+    if (absolute) {
+        direction_pending = false;
+    }
+    return true;
 }
 
 /**
- * 检查电机是否正在运行
+ * 减速停止后开始运行中收到的运动命令（在中断内调用，方向已由stepper_motor_take_direction写入）
+ * @return 第一步间隔（tick），0表示没有待执行的命令或已在目标位置
  */
-bool stepper_motor_is_running() {
-    return motor_state.is_running;
+static uint16_t stepper_motor_start_deferred() {
+    if (!deferred_pending) {
+        return 0;
+    }
+    deferred_pending = false;
+
+    uint32_t steps = deferred_steps;
+    if (deferred_absolute) {
+        int32_t offset = deferred_target - motor_state.position;
+        if (offset == 0) {
+            return 0;
+        }
+        motor_state.direction = (offset > 0) ? CLOCKWISE : COUNTER_CLOCKWISE;
+        steps = (uint32_t)(offset > 0 ? offset : -offset);
+    }
+
+    stepper_motor_apply_pending();
+    if (steps == STEPPER_RAMP_UNLIMITED) {
+        motor_state.remaining_steps = -1;
+    } else {
+        motor_state.target_steps = (int32_t)steps;
+        motor_state.remaining_steps = (int32_t)steps;
+    }
+    return stepper_motor_begin_move(stepper_ramp_plan(&ramp, steps, motor_state.step_interval));
 }
 
 /**
- * 获取当前步进模式
+ * 运行中修改的参数在下一次从静止起步、规划加减速之前写入（在中断或ATOMIC_BLOCK内调用）
  */
-step_mode_t stepper_motor_get_step_mode() {
-    return motor_state.step_mode;
+static void stepper_motor_apply_pending() {
+    if (acceleration_pending) {
+        stepper_ramp_set_acceleration(&ramp, stepper_motor_governed_acceleration());
+        acceleration_pending = false;
+    }
+    if (jerk_pending) {
+        stepper_ramp_set_jerk(&ramp, pending_jerk);
+        jerk_pending = false;
+    }
+    if (profile_pending) {
+        stepper_ramp_set_profile(&ramp, pending_profile);
+        profile_pending = false;
+    }
 }
 
 /**
- * 获取步数计数器
+ * 停止电机（按加速度减速后停止）
+ * 低速运行时无需减速，立即停止；间隙空转中不打断空转（否则间隙状态未知），空转完成后停止
  */
-uint32_t stepper_motor_get_step_count() {
-    return step_counter;
+void stepper_motor_stop() {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        stepper_queue_clear();
+        deferred_pending = false;
+        if (takeup_remaining > 0) {
+            takeup_next_delay = 0;
+        } else if (!motor_state.is_running || dwelling || !stepper_ramp_begin_stop(&ramp)) {
+            // 低速无需减速，立即停止也算运动结束
+            if (motor_state.is_running) {
+                pending_events |= STEPPER_EVENT_MOVE_DONE;
+            }
+            stepper_motor_halt();
+        } else if (blended_segments > 0) {
+            // 当前段可能不足以减速，由加减速曲线决定停止点
+            blended_segments = 0;
+            motor_state.remaining_steps = -1;
+        }
+    }
 }
 
 /**
- * 重置步数计数器
+ * 立即停止电机并断开所有线圈
  */
-void stepper_motor_reset_step_count() {
-    step_counter = 0;
+void stepper_motor_halt() {
+    stepper_timer_stop();
+    stepper_queue_clear();
+    deferred_pending = false;
+    dwelling = false;
+    blended_segments = 0;
+    takeup_remaining = 0;
+    lock_in_next_delay = 0;
+    full_drive = false;
+    ramp.phase = RAMP_STOP;
+    motor_state.is_running = false;
+    motor_state.remaining_steps = 0;
+    stepper_motor_take_direction();
+
+    // 停止细分PWM并关闭所有引脚
+    hold_active = false;
+    coils_locked = false;
+    stepper_microstep_release();
+    stepper_motor_release_axes();
 }
 
 /**
- * 获取当前旋转的已完成步数
+ * 运动正常结束（到达目标步数或减速停止完成）
+ * 设置了减流保持时保持最后的线圈组合，否则断开所有线圈
  */
-uint32_t stepper_motor_get_current_rotation_steps() {
-    if (motor_state.target_steps > 0) {
-        return motor_state.target_steps - motor_state.remaining_steps;
+static void stepper_motor_finish_move() {
+    pending_events |= STEPPER_EVENT_MOVE_DONE;
+
+    if (hold_duty_level == 0) {
+        stepper_motor_halt();
+        return;
     }
-    return 0;
+
+    stepper_timer_stop();
+    ramp.phase = RAMP_STOP;
+    full_drive = false;
+    motor_state.is_running = false;
+    motor_state.remaining_steps = 0;
+    stepper_motor_take_direction();
+    stepper_motor_enter_hold();
+    stepper_motor_release_axes();
 }
 
 /**
- * 获取当前累计角度（基于总步数计数器）
+ * 设置减流保持
+ * 之后每次运动结束都以该占空比保持位置，直到超时、下一次运动或stepper_motor_release()
+ * @param duty_percent 保持占空比（%），0表示运动结束后直接断电
+ * @param timeout_ms 保持超时（毫秒），0表示不超时
  */
-uint16_t stepper_motor_get_current_angle() {
-    // 根据当前步进模式获取正确的每圈步数
-    uint16_t steps_per_revolution = (motor_state.step_mode == STEP_MODE_FULL) ?
-                                   STEPS_PER_REVOLUTION_FULL : STEPS_PER_REVOLUTION_HALF;
+void stepper_motor_set_hold(uint8_t duty_percent, uint16_t timeout_ms) {
+    if (duty_percent > STEPPER_HOLD_MAX_DUTY) duty_percent = STEPPER_HOLD_MAX_DUTY;
 
-    // 计算当前累计角度，使用四舍五入
-    uint32_t total_angle_steps = step_counter;
-    uint32_t angle_calculation = total_angle_steps * 360;
-    uint16_t current_angle = (uint16_t)((angle_calculation + steps_per_revolution / 2) / steps_per_revolution);
-
-    return current_angle;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        hold_duty_level = (uint8_t)(((uint16_t)duty_percent * STEPPER_PWM_LEVELS + 50) / 100);
+        hold_timeout_ms = timeout_ms;
+    }
 }
 
 /**
- * 更新电机状态 (需要在主循环中调用)
+ * 电机停止时立即进入减流保持（例如第一张照片前锁定原点）
  */
-void stepper_motor_update() {
-    if (!motor_state.is_running) return;
-
-    unsigned long current_time = micros();
-    // 优先使用自定义速度，如果没有设置则使用预设速度
-    unsigned long delay_time = (custom_speed_delay > 0) ? custom_speed_delay : speed_delays[motor_state.speed];
-    // 检查是否到了下一步的时间
-    if (current_time - motor_state.last_step_time >= delay_time) {
-        stepper_motor_step();
-        motor_state.last_step_time = current_time;
+void stepper_motor_hold() {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (!motor_state.is_running && hold_duty_level > 0) {
+            stepper_motor_enter_hold();
+        }
+    }
+}
 
-        // 如果不是连续转动，检查是否完成目标步数
-        if (motor_state.remaining_steps > 0) {
-            motor_state.remaining_steps--;
-            if (motor_state.remaining_steps == 0) {
-                stepper_motor_stop();
-            }
+/**
+ * 结束减流保持并断开所有线圈（运行中调用无效）
+ */
+void stepper_motor_release() {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (!motor_state.is_running) {
+            hold_active = false;
+            coils_locked = false;
+            stepper_microstep_release();
         }
     }
 }
 
 /**
- * 执行一步
+ * 检查是否处于减流保持状态
  */
-void stepper_motor_step() {
-    // 获取当前步进模式的序列长度
-    int sequence_length = (motor_state.step_mode == STEP_MODE_FULL) ?
-                         STEP_SEQUENCE_LENGTH_FULL : STEP_SEQUENCE_LENGTH_HALF;
+bool stepper_motor_is_holding() {
+    return hold_active;
+}
 
-    // 根据方向更新步数
-    if (motor_state.direction == CLOCKWISE) {
-        motor_state.current_step++;
-        if (motor_state.current_step >= sequence_length) {
-            motor_state.current_step = 0;
-        }
+/**
+ * 设置起步预励磁的锁定时间
+ * 线圈断电或减流保持后，转子可能偏离最后的相位；开始运动前先以满电流输出该相位，
+ * 等转子被拉回到已知的电气位置再发出第一步，起步不再丢步，无需额外补偿步数
+ * @param lock_in_ms 锁定时间（毫秒），0表示不预励磁，超过STEPPER_LOCK_IN_MAX_MS按上限
+ */
+void stepper_motor_set_lock_in(uint16_t lock_in_ms) {
+    if (lock_in_ms > STEPPER_LOCK_IN_MAX_MS) lock_in_ms = STEPPER_LOCK_IN_MAX_MS;
+    lock_in_ticks = (uint16_t)(lock_in_ms * STEPPER_TICKS_PER_MS);
+}
+
+/**
+ * 以保持占空比重新输出当前线圈组合（在中断或ATOMIC_BLOCK内调用）
+ */
+static void stepper_motor_enter_hold() {
+    if (motor_state.step_mode == STEP_MODE_MICRO) {
+        stepper_microstep_set_phase(stepper_motor_phase_of(STEP_MODE_MICRO, motor_state.microsteps,
+                                                           motor_state.current_step), hold_duty_level);
+    } else if (motor_state.step_mode == STEP_MODE_FULL) {
+        stepper_microstep_hold_pattern(stepper_sequence_full::pattern(motor_state.current_step), hold_duty_level);
     } else {
-        motor_state.current_step--;
-        if (motor_state.current_step < 0) {
-            motor_state.current_step = sequence_length - 1;
-        }
+        stepper_microstep_hold_pattern(stepper_sequence_half::pattern(motor_state.current_step), hold_duty_level);
     }
 
-    // 根据步进模式选择序列并设置引脚状态
-    if (motor_state.step_mode == STEP_MODE_FULL) {
-        stepper_motor_set_pins(step_sequence_full[motor_state.current_step]);
-    } else {
-        stepper_motor_set_pins(step_sequence_half[motor_state.current_step]);
+    hold_active = true;
+    coils_locked = false;
+    hold_start_time = millis();
+}
+
+/**
+ * 开始运动前结束保持（在ATOMIC_BLOCK内调用）
+ * 全步/半步模式由步进中断直接写引脚，需先停止PWM；细分模式下一步会恢复满幅
+ */
+static void stepper_motor_end_hold() {
+    if (!hold_active) return;
+
+    hold_active = false;
+    if (motor_state.step_mode != STEP_MODE_MICRO) {
+        stepper_microstep_release();
     }
+}
 
-    // 增加步数计数器
-    step_counter++;
+/**
+ * 追加转动段：按指定速度曲线转动steps步（方向由之前的方向段或当前方向决定）
+ * 电机空闲时立即开始执行队列
+ * @return 队列已满或步数超出范围时返回false
+ */
+bool stepper_motor_queue_move(uint32_t steps, motion_profile_t profile) {
+    if (steps == 0) return true;
+    if (steps > STEPPER_QUEUE_MAX_MOVE_STEPS) return false;
+    return stepper_motor_queue_segment(MOTION_SEGMENT_MOVE, (uint8_t)profile, steps);
 }
 
 /**
- * 设置步进模式
+ * 追加停留段：原地停留指定微秒，期间线圈保持当前组合
  */
-void stepper_motor_set_step_mode(step_mode_t mode) {
-    motor_state.step_mode = mode;
-    motor_state.current_step = 0;  // 重置步数位置
+bool stepper_motor_queue_dwell(uint32_t dwell_us) {
+    if (dwell_us == 0) return true;
+    return stepper_motor_queue_segment(MOTION_SEGMENT_DWELL, 0, dwell_us);
+}
+
+/**
+ * 追加方向段：之后的转动段按该方向执行
+ */
+bool stepper_motor_queue_direction(motor_direction_t direction) {
+    return stepper_motor_queue_segment(MOTION_SEGMENT_DIRECTION, direction == CLOCKWISE ? 1 : 0, 0);
+}
+
+/**
+ * 取消所有未执行的运动段（当前段继续执行完）
+ * 当前段已与后续段衔接（不在段尾减速）时改为按加速度减速停止
+ */
+void stepper_motor_queue_clear() {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (blended_segments > 0) {
+            stepper_motor_stop();
+        } else {
+            stepper_queue_clear();
+        }
+    }
+}
+
+/**
+ * 获取运动段队列剩余空位
+ */
+uint8_t stepper_motor_queue_free() {
+    return stepper_queue_free();
+}
+
+/**
+ * 写入一个运动段，电机空闲时启动定时器开始消费队列
+ */
+static bool stepper_motor_queue_segment(uint8_t type, uint8_t arg, uint32_t value) {
+    motion_segment_t segment;
+    segment.type = type;
+    segment.arg = arg;
+    segment.value = value;
+
+    if (!stepper_queue_push(&segment)) {
+        return false;
+    }
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (!motor_state.is_running) {
+            // 先结束保持，装载转动段时的预励磁才不会被随后关闭PWM清除
+            stepper_motor_end_hold();
+            uint16_t first_delay = stepper_motor_load_next_segment();
+            if (first_delay > 0) {
+                motor_state.is_running = true;
+                stepper_timer_start(first_delay);
+            }
+        } else if (type != MOTION_SEGMENT_DWELL) {
+            stepper_motor_extend_blend();
+        }
+    }
+    return true;
+}
+
+/**
+ * 从队列装载下一个运动段（在Timer1中断或ATOMIC_BLOCK内调用）
+ * 方向段立即生效并继续装载，直到遇到转动段或停留段
+ * @return 距离下一次中断的tick数，0表示队列已空
+ */
+static uint16_t stepper_motor_load_next_segment() {
+    motion_segment_t segment;
+
+    while (stepper_queue_pop(&segment)) {
+        switch (segment.type) {
+            case MOTION_SEGMENT_DIRECTION:
+                motor_state.direction = segment.arg ? CLOCKWISE : COUNTER_CLOCKWISE;
+                break;
+
+            case MOTION_SEGMENT_DWELL:
+                dwell_ticks = segment.value / (1000000UL / STEPPER_TIMER_FREQ);
+                if (dwell_ticks == 0) {
+                    break;
+                }
+                dwelling = true;
+                ramp.phase = RAMP_STOP;
+                motor_state.remaining_steps = 0;
+                return stepper_motor_next_dwell_chunk();
+
+            case MOTION_SEGMENT_MOVE: {
+                // 前瞻：把后续可衔接的转动段合并为一条加减速曲线
+                uint32_t total_steps = segment.value;
+                blended_segments = stepper_motor_plan_junctions(&segment, &total_steps);
+
+                stepper_motor_apply_pending();
+                stepper_ramp_set_profile(&ramp, (motion_profile_t)segment.arg);
+                motor_state.target_steps = (int32_t)segment.value;
+                motor_state.remaining_steps = (int32_t)segment.value;
+                return stepper_motor_begin_move(stepper_ramp_plan(&ramp, total_steps, motor_state.step_interval));
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * 前瞻规划段间衔接速度
+ * 所有转动段共用同一巡航速度，同向且速度曲线相同的相邻转动段之间可以保持当前速度通过，
+ * 因此衔接速度取合并后整条曲线在该点的速度，只在停留段、换向或队列末尾减速到零
+ * @param first 刚取出的转动段
+ * @param total_steps 输入为该段步数，输出为合并后的总步数
+ * @return 合并进来的后续转动段数
+ */
+static uint8_t stepper_motor_plan_junctions(const motion_segment_t* first, uint32_t* total_steps) {
+    return stepper_motor_scan_junctions(first->arg, 0, total_steps);
+}
+
+/**
+ * 从队列头开始统计可以与当前转动段衔接的转动段
+ * @param profile 当前转动段的速度曲线
+ * @param skip 前skip个可衔接段已经合并，不再累加步数
+ * @param total_steps 累加第skip个之后的可衔接段步数
+ * @return 可衔接的转动段总数
+ */
+static uint8_t stepper_motor_scan_junctions(uint8_t profile, uint8_t skip, uint32_t* total_steps) {
+    motion_segment_t next;
+    uint8_t direction = (motor_state.direction == CLOCKWISE) ? 1 : 0;
+    uint8_t blended = 0;
+
+    for (uint8_t index = 0; stepper_queue_peek(index, &next); index++) {
+        if (next.type == MOTION_SEGMENT_DIRECTION) {
+            if (next.arg != direction) break;       // 换向必须停止
+            continue;
+        }
+        if (next.type != MOTION_SEGMENT_MOVE || next.arg != profile) break;
+        if (blended >= skip) {
+            if (*total_steps + next.value > STEPPER_RAMP_UNLIMITED - 1) break;
+            *total_steps += next.value;
+        }
+        blended++;
+    }
+    return blended;
+}
+
+/**
+ * 运行中追加转动段后补充衔接（在ATOMIC_BLOCK内调用）
+ * 装载时的前瞻只能看到已在队列中的段；电机空闲时第一段一写入就开始执行，
+ * 紧接着写入的段要在这里并入当前的加减速曲线，否则每段都会减速到零再起步
+ */
+static void stepper_motor_extend_blend() {
+    if (!motor_state.is_running || dwelling || coordinated || motor_state.remaining_steps <= 0) {
+        return;
+    }
+
+    uint32_t extra_steps = 0;
+    uint8_t blended = stepper_motor_scan_junctions((uint8_t)ramp.profile, blended_segments, &extra_steps);
+    if (blended > blended_segments && stepper_ramp_extend(&ramp, extra_steps)) {
+        blended_segments = blended;
+    }
+}
+
+/**
+ * 当前段结束后直接进入已合并的下一个转动段，不重新规划加减速
+ * @return false 表示合并的段已被取消，需要按正常流程装载
+ */
+static bool stepper_motor_continue_blended() {
+    motion_segment_t segment;
+
+    while (stepper_queue_pop(&segment)) {
+        if (segment.type == MOTION_SEGMENT_DIRECTION) {
+            continue;   // 前瞻时已确认与当前方向相同
+        }
+        blended_segments--;
+        motor_state.target_steps = (int32_t)segment.value;
+        motor_state.remaining_steps = (int32_t)segment.value;
+        return true;
+    }
+
+    blended_segments = 0;
+    return false;
+}
+
+/**
+ * 取出下一段停留时间，超过16位比较寄存器的停留分多次等待
+ */
+static uint16_t stepper_motor_next_dwell_chunk() {
+    uint16_t chunk = (dwell_ticks > 0xFFFFUL) ? 0xFFFF : (uint16_t)dwell_ticks;
+    dwell_ticks -= chunk;
+    return chunk;
+}
+
+/**
+ * 设置齿轮间隙补偿步数
+ * @param full_steps 间隙对应的全步数，0表示不补偿
+ */
+void stepper_motor_set_backlash(uint8_t full_steps) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        backlash_full_steps = full_steps;
+    }
+}
+
+/**
+ * 获取齿轮间隙补偿步数（全步）
+ */
+uint8_t stepper_motor_get_backlash() {
+    return backlash_full_steps;
+}
+
+/**
+ * 开始一次从静止出发的运动（在中断或ATOMIC_BLOCK内调用）
+ * 方向与上次消除间隙的方向相反时，先插入间隙空转步；上电后第一次运动的间隙状态未知，不补偿
+ * @param first_delay 加减速曲线给出的第一步间隔
+ * @return 距离第一次中断的tick数
+ */
+static uint16_t stepper_motor_begin_move(uint16_t first_delay) {
+    bool reversed = backlash_side_known && motor_state.direction != backlash_side;
+
+    backlash_side = motor_state.direction;
+    backlash_side_known = true;
+
+    if (reversed && backlash_full_steps > 0) {
+        takeup_remaining = (uint16_t)backlash_full_steps *
+                           stepper_motor_units_per_full(motor_state.step_mode, motor_state.microsteps);
+    }
+    if (takeup_remaining > 0) {
+        takeup_next_delay = first_delay;
+        first_delay = stepper_motor_takeup_interval();
+    }
+
+    return stepper_motor_lock_in(first_delay);
+}
+
+/**
+ * 起步预励磁：线圈未以满电流锁定时，输出当前相位并先等待锁定时间
+ * 锁定时间单独占一个比较周期（与停留段的分段相同），不与第一步间隔相加，不会被16位比较寄存器截断
+ * @return 距离第一次中断的tick数
+ */
+static uint16_t stepper_motor_lock_in(uint16_t first_delay) {
+    if (coils_locked) {
+        return first_delay;
+    }
+
+    coil_output((uint8_t)motor_state.current_step);
+    coils_locked = true;
+
+    if (lock_in_ticks == 0) {
+        return first_delay;
+    }
+    lock_in_next_delay = first_delay;
+    return lock_in_ticks;
+}
+
+/**
+ * 间隙空转的步进间隔：以固定的全步速率空转，与步进模式无关
+ */
+static uint16_t stepper_motor_takeup_interval() {
+    return STEPPER_BACKLASH_FULL_STEP_TICKS /
+           stepper_motor_units_per_full(motor_state.step_mode, motor_state.microsteps);
+}
+
+/**
+ * 检查电机是否正在运行
+ */
+bool stepper_motor_is_running() {
+    return motor_state.is_running;
+}
+
+/**
+ * 获取当前步进模式
+ */
+step_mode_t stepper_motor_get_step_mode() {
+    return motor_state.step_mode;
+}
+
+/**
+ * 把中断累加的步数结算到累计转动量（主循环调用）
+ */
+static void stepper_motor_settle_travel() {
+    uint32_t steps;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        steps = step_counter;
+        step_counter = 0;
+    }
+    stepper_gear_travel_add(&gear_ratio, &travel, steps);
+}
+
+/**
+ * 获取累计转动量（圈数 + 圈内偏移，偏移以1/den步为单位，配合stepper_motor_get_gear_ratio()换算）
+ */
+void stepper_motor_get_travel(stepper_gear_travel_t* result) {
+    stepper_motor_settle_travel();
+    *result = travel;
+}
+
+/**
+ * 重置步数计数器
+ */
+void stepper_motor_reset_step_count() {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        step_counter = 0;
+    }
+    travel.turns = 0;
+    travel.offset = 0;
+}
+
+/**
+ * 获取当前旋转的已完成步数
+ */
+uint32_t stepper_motor_get_current_rotation_steps() {
+    uint32_t done = 0;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (coordinated) {
+            // 联动运动的remaining_steps是插补节拍数，旋转轴步数单独计数
+            done = coord_rotation_done;
+        } else if (motor_state.target_steps > 0) {
+            done = motor_state.target_steps - motor_state.remaining_steps;
+        }
+    }
+    return done;
+}
+
+/**
+ * 获取累计转动量在当前圈内的角度（0 ~ 359，向下取整），整圈数由stepper_motor_get_travel()给出
+ */
+uint16_t stepper_motor_get_current_angle() {
+    stepper_motor_settle_travel();
+    return (uint16_t)stepper_gear_travel_fraction(&gear_ratio, &travel, 360);
+}
+
+/**
+ * 获取绝对位置（步，单位随当前步进模式）
+ */
+int32_t stepper_motor_get_position() {
+    int32_t position;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        position = motor_state.position;
+    }
+    return position;
+}
+
+/**
+ * 设置绝对位置（不转动电机，仅修改坐标）
+ */
+void stepper_motor_set_position(int32_t position) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        motor_state.position = position;
+        position_fraction = 0;
+    }
+}
+
+/**
+ * 修正绝对位置（运行中也可调用，与步进中断的位置更新互斥）
+ * @param delta 加到当前位置上的步数
+ */
+void stepper_motor_adjust_position(int32_t delta) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        motor_state.position += delta;
+    }
+}
+
+/**
+ * 将当前位置设为原点
+ */
+void stepper_motor_set_home() {
+    stepper_motor_set_position(0);
+}
+
+/**
+ * 获取当前步进模式下的每圈步数（四舍五入，精确值见stepper_motor_get_gear_ratio()）
+ */
+uint32_t stepper_motor_get_steps_per_revolution() {
+    return stepper_gear_steps_per_revolution(&gear_ratio);
+}
+
+/**
+ * 获取转台每转步数的精确分数（单位随当前步进模式）
+ */
+void stepper_motor_get_gear_ratio(stepper_gear_ratio_t* ratio) {
+    *ratio = gear_ratio;
+}
+
+/**
+ * 设置转台皮带/齿轮齿数比，电机直接驱动转台时为1:1
+ * @param driven_teeth 转台（从动轮）齿数，1 ~ STEPPER_GEAR_TEETH_MAX
+ * @param drive_teeth 电机轴（主动轮）齿数，1 ~ STEPPER_GEAR_TEETH_MAX
+ */
+void stepper_motor_set_belt_ratio(uint8_t driven_teeth, uint8_t drive_teeth) {
+    if (driven_teeth == 0 || driven_teeth > STEPPER_GEAR_TEETH_MAX) return;
+    if (drive_teeth == 0 || drive_teeth > STEPPER_GEAR_TEETH_MAX) return;
+
+    belt_driven_teeth = driven_teeth;
+    belt_drive_teeth = drive_teeth;
+    stepper_motor_refresh_gear();
+}
+
+/**
+ * 按步进模式和皮带齿数比重新计算每转步数
+ */
+static void stepper_motor_refresh_gear() {
+    // 未结算的步数属于旧的每转步数，先结算再换算圈内偏移
+    stepper_gear_ratio_t previous = gear_ratio;
+    stepper_motor_settle_travel();
+
+    stepper_gear_make_ratio(&gear_ratio,
+                            stepper_motor_units_per_full(motor_state.step_mode, motor_state.microsteps),
+                            belt_driven_teeth, belt_drive_teeth);
+    stepper_gear_travel_rescale(&previous, &gear_ratio, &travel);
+}
+
+/**
+ * 获取圈内位置（0 ~ 每圈步数-1），负位置按整圈取模
+ * 每圈步数不是整数，按精确分数取模，多圈后圈内位置不漂移
+ */
+uint32_t stepper_motor_get_position_in_revolution() {
+    uint32_t fraction;
+    stepper_gear_revolution_of(&gear_ratio, stepper_motor_get_position(), &fraction);
+    return fraction / gear_ratio.den;
+}
+
+/**
+ * 计算从当前位置到圈内目标位置的最短带符号偏移
+ * @param target_in_revolution 圈内目标位置（步）
+ * @return 偏移步数，范围(-半圈, +半圈]，正数顺时针
+ */
+int32_t stepper_motor_get_shortest_offset(uint32_t target_in_revolution) {
+    // 以1/den步为单位计算，num小于2^31
+    uint32_t fraction;
+    stepper_gear_revolution_of(&gear_ratio, stepper_motor_get_position(), &fraction);
+
+    int32_t num = (int32_t)gear_ratio.num;
+    int32_t den = (int32_t)gear_ratio.den;
+    int32_t offset = (int32_t)((target_in_revolution * gear_ratio.den) % gear_ratio.num) - (int32_t)fraction;
+
+    if (offset > num / 2) {
+        offset -= num;
+    } else if (offset <= -num / 2) {
+        offset += num;
+    }
+    return (offset >= 0) ? (offset + den / 2) / den : -((-offset + den / 2) / den);
+}
+
+/**
+ * 按最短路径转到圈内指定角度（相对原点）
+ * 目标按所在圈数换算成精确的绝对位置，多圈后同一角度仍对应同一位置
+ * @param angle 目标角度（度），超过360按整圈取模
+ */
+void stepper_motor_move_to(uint16_t angle) {
+    int32_t position = stepper_motor_get_position();
+    int32_t revolution = stepper_gear_revolution_of(&gear_ratio, position, nullptr);
+    int32_t target = stepper_gear_angle_position(&gear_ratio, revolution, angle % 360);
+    int32_t half = (int32_t)(gear_ratio.num / gear_ratio.den / 2);
+
+    // 取相邻圈中最近的一个，范围(-半圈, +半圈]
+    if (target - position > half) {
+        target = stepper_gear_angle_position(&gear_ratio, revolution - 1, angle % 360);
+    } else if (target - position <= -half) {
+        target = stepper_gear_angle_position(&gear_ratio, revolution + 1, angle % 360);
+    }
+
+    stepper_motor_move_to_position(target);
+}
+
+/**
+ * 转到指定的绝对位置（不按整圈取模，按实际差值转动）
+ * 运行中调用时先减速停止，再按停止位置计算步数和方向
+ */
+void stepper_motor_move_to_position(int32_t position) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        // 运行中：减速停止后再按停止位置计算步数和方向
+        stepper_queue_clear();
+        if (stepper_motor_defer_move(0, true, position)) {
+            return;
+        }
+
+        int32_t offset = position - motor_state.position;
+        if (offset == 0) {
+            return;
+        }
+
+        motor_state.direction = (offset > 0) ? CLOCKWISE : COUNTER_CLOCKWISE;
+        direction_pending = false;
+        stepper_motor_rotate_steps(offset > 0 ? offset : -offset);
+    }
+}
+
+/**
+ * 多轴联动相对运动：各轴沿Bresenham直线同时起停，共用旋转轴的加减速曲线
+ * 插补节拍数为步数最多的轴的步数，总耗时取决于该轴，而不是各轴耗时之和
+ * @param steps 各轴步数（正数为正方向，单位随各轴的步进模式），绝对值不超过STEPPER_QUEUE_MAX_MOVE_STEPS
+ */
+void stepper_motor_move_axes(const int steps[STEPPER_AXIS_COUNT]) {
+    uint16_t events = 0;
+
+    for (uint8_t i = 0; i < STEPPER_AXIS_COUNT; i++) {
+        if (steps[i] > STEPPER_QUEUE_MAX_MOVE_STEPS || steps[i] < -STEPPER_QUEUE_MAX_MOVE_STEPS) return;
+        uint16_t count = (uint16_t)(steps[i] < 0 ? -steps[i] : steps[i]);
+        if (count > events) events = count;
+    }
+    if (events == 0) return;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        // 联动运动必须从静止开始
+        if (motor_state.is_running && !dwelling) {
+            return;
+        }
+        stepper_queue_clear();
+        blended_segments = 0;
+        direction_pending = false;
+        stepper_motor_apply_pending();
+
+        // 误差从半个节拍开始，各轴的步均匀分布在直线上
+        for (uint8_t i = 0; i < STEPPER_AXIS_COUNT; i++) {
+            coord_forward[i] = steps[i] > 0;
+            coord_steps[i] = (uint16_t)(steps[i] < 0 ? -steps[i] : steps[i]);
+            coord_error[i] = -(int16_t)(events / 2);
+        }
+        coord_events = events;
+        coord_rotation_done = 0;
+        coordinated = true;
+
+        motor_state.direction = coord_forward[STEPPER_AXIS_ROTATION] ? CLOCKWISE : COUNTER_CLOCKWISE;
+        motor_state.target_steps = coord_steps[STEPPER_AXIS_ROTATION];
+        motor_state.remaining_steps = events;
+        uint16_t first_delay = stepper_ramp_plan(&ramp, events, motor_state.step_interval);
+
+        stepper_motor_end_hold();
+        dwelling = false;
+        motor_state.is_running = true;
+
+        // 只有旋转轴参与时才需要消除间隙
+        if (coord_steps[STEPPER_AXIS_ROTATION] > 0) {
+            first_delay = stepper_motor_begin_move(first_delay);
+        }
+        stepper_timer_start(first_delay);
+    }
+}
+
+/**
+ * 一个插补节拍：累加各轴误差，溢出的轴走一步（在Timer1中断内调用）
+ */
+static void stepper_motor_step_axes() {
+    for (uint8_t i = 0; i < STEPPER_AXIS_COUNT; i++) {
+        coord_error[i] += coord_steps[i];
+        if (coord_error[i] <= 0) {
+            continue;
+        }
+        coord_error[i] -= coord_events;
+
+        if (i == STEPPER_AXIS_ROTATION) {
+            stepper_motor_step();
+            coord_rotation_done++;
+        } else {
+            stepper_axis_step(i, coord_forward[i]);
+        }
+    }
+}
+
+/**
+ * 联动结束后断开辅助轴线圈（减速箱自锁，静止时无需通电）
+ */
+static void stepper_motor_release_axes() {
+    coordinated = false;
+    stepper_axis_release_auxiliary();
+}
+
+/**
+ * 取走中断中产生的运动事件并调用回调（主循环调用，回调中可以直接发起下一次运动）
+ * 两次调用之间产生的多个事件合并为一个位掩码
+ */
+static void stepper_motor_dispatch_events() {
+    uint8_t events;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        events = pending_events;
+        pending_events = 0;
+    }
+    if (stepper_stall_take_event()) {
+        events |= STEPPER_EVENT_STALL;
+    }
+
+    if (events != 0 && event_callback != nullptr) {
+        event_callback(events);
+    }
+}
+
+/**
+ * 连续转动时绝对位置按整数圈回绕，避免int32溢出
+ * num步正好是den圈，回绕后圈内位置和索引误差都不变
+ */
+static void stepper_motor_wrap_position() {
+    int32_t position = stepper_motor_get_position();
+
+    if (position > STEPPER_POSITION_WRAP) {
+        stepper_motor_adjust_position(-(int32_t)gear_ratio.num);
+    } else if (position < -STEPPER_POSITION_WRAP) {
+        stepper_motor_adjust_position((int32_t)gear_ratio.num);
+    }
+}
+
+/**
+ * 更新电机状态 (在主循环中调用)
+ * 步进时序已由Timer1比较匹配中断产生，不再依赖主循环的调用频率，
+ * 这里只处理电压调速的加速度更新、线圈温升模型、步数结算和减流保持超时
+ */
+void stepper_motor_update() {
+    // 运行中电压变化后的加速度限制，以及运行中修改的加加速度和速度曲线，在电机停止后生效
+    if (acceleration_pending || jerk_pending || profile_pending) {
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            if (!motor_state.is_running) {
+                stepper_motor_apply_pending();
+            }
+        }
+    }
+
+    stepper_motor_update_thermal();
+    stepper_motor_settle_travel();
+    stepper_motor_wrap_position();
+
+    stepper_motor_dispatch_events();
+
+    if (!hold_active || hold_timeout_ms == 0) return;
+
+    unsigned long start_time;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        start_time = hold_start_time;
+    }
+
+    if (millis() - start_time >= hold_timeout_ms) {
+        stepper_motor_release();
+    }
+}
+
+/**
+ * 当前线圈通电量（以持续通电的线圈数计，Q8）
+ * 全步2个线圈，半步交替1/2个平均1.5个，细分为|sin|+|cos|的平均值4/π≈1.27个；减流保持按占空比折算
+ */
+static uint16_t stepper_motor_coil_load() {
+    uint16_t load;
+
+    switch (motor_state.step_mode) {
+        case STEP_MODE_FULL:  load = 512; break;
+        case STEP_MODE_HALF:  load = 384; break;
+        case STEP_MODE_AUTO:  load = full_drive ? 512 : 384; break;
+        default:              load = 326; break;
+    }
+
+    if (motor_state.is_running) {
+        return load;
+    }
+    if (hold_active) {
+        return (uint16_t)((uint32_t)load * hold_duty_level / STEPPER_PWM_LEVELS);
+    }
+    return 0;
+}
+
+/**
+ * 线圈温升模型（主循环调用）
+ * 一阶模型：温升按时间常数趋向"通电量×每线圈稳态温升"，每个积分周期用周期内的平均通电量更新一次。
+ * 温升超过降速阈值时限制最高转速（自动模式随之保持半步驱动，通电量减少1/4），
+ * 超过冷却阈值时由拍照模式在旋转之间停留断电，降到恢复阈值以下后解除
+ */
+static void stepper_motor_update_thermal() {
+    unsigned long now = millis();
+
+    // 先限制采样间隔再乘：通电量最多512×61000，温升差×周期最多15360×61000，都在32位范围内
+    unsigned long gap = now - thermal_last_sample;
+    if (gap > STEPPER_THERMAL_MAX_GAP_MS) {
+        gap = STEPPER_THERMAL_MAX_GAP_MS;
+    }
+    thermal_energy += (uint32_t)stepper_motor_coil_load() * gap;
+    thermal_period_ms += gap;
+    thermal_last_sample = now;
+
+    uint32_t elapsed = thermal_period_ms;
+    if (elapsed < STEPPER_THERMAL_PERIOD_MS) {
+        return;
+    }
+
+    // 周期内平均通电量对应的稳态温升（°C×256）
+    // 每周期的变化量常小于1（温差低于约3.5°C时），余数累积到下一周期，温升才能趋近稳态值
+    int32_t target_q8 = (int32_t)(thermal_energy / elapsed) * STEPPER_THERMAL_RISE_PER_COIL;
+    int32_t numer = (target_q8 - thermal_rise_q8) * (int32_t)elapsed + thermal_rest;
+    thermal_rise_q8 += numer / (STEPPER_THERMAL_TAU_S * 1000L);
+    thermal_rest = numer % (STEPPER_THERMAL_TAU_S * 1000L);
+    thermal_energy = 0;
+    thermal_period_ms = 0;
+
+    int32_t rise = thermal_rise_q8 >> 8;
+    bool derated = thermal_derated;
+    if (rise >= STEPPER_THERMAL_DERATE_RISE) {
+        derated = true;
+    } else if (rise <= STEPPER_THERMAL_RESUME_RISE) {
+        derated = false;
+    }
+    if (rise >= STEPPER_THERMAL_DWELL_RISE) {
+        thermal_cooling = true;
+    } else if (rise <= STEPPER_THERMAL_RESUME_RISE) {
+        thermal_cooling = false;
+    }
+
+    if (derated != thermal_derated) {
+        thermal_derated = derated;
+        stepper_motor_refresh_interval();
+    }
+}
+
+/**
+ * 获取估算的线圈温升（0.1°C，高于环境温度）
+ */
+uint16_t stepper_motor_get_temperature_rise() {
+    return (thermal_rise_q8 > 0) ? (uint16_t)(thermal_rise_q8 * 10 / 256) : 0;
+}
+
+/**
+ * 检查是否需要冷却停留（温升超过冷却阈值，直到降到恢复阈值以下）
+ */
+bool stepper_motor_needs_cooldown() {
+    return thermal_cooling;
+}
+
+/**
+ * 启用/关闭堵转检测
+ * 每次运动进入巡航后先学习各线圈组合的电流基线，之后连续多步偏离基线即触发堵转回调
+ */
+void stepper_motor_enable_stall_detection(bool enable) {
+    stepper_stall_enable(enable);
+}
+
+/**
+ * 设置运动事件回调（STEPPER_EVENT_*位掩码），在主循环的stepper_motor_update()中执行
+ * 堵转时由调用方决定重试或中止（堵转后绝对位置已不可信）
+ */
+void stepper_motor_set_event_callback(stepper_event_callback_t callback) {
+    event_callback = callback;
+}
+
+/**
+ * 启动步进定时器，第一步在first_delay之后发出
+ */
+static void stepper_timer_start(uint16_t first_delay) {
+    TCCR1B = (1 << WGM12);                      // 先停止时钟
+    TCNT1 = 0;
+    OCR1A = first_delay - 1;
+    TIFR1 = (1 << OCF1A);                       // 清除挂起的比较匹配标志
+    TIMSK1 |= (1 << OCIE1A);
+    TCCR1B = (1 << WGM12) | (1 << CS11) | (1 << CS10);  // 64分频启动
+
+    // 新的运动开始，丢弃上一次运动还没被取走的结束事件
+    pending_events &= (uint8_t)~STEPPER_EVENT_MOVE_DONE;
+    stepper_stall_begin_move();
+
+#ifdef STEPPER_TIMING_STATS
+    stepper_timing_begin_move();
+#endif
+}
+
+/**
+ * 停止步进定时器
+ */
+static void stepper_timer_stop() {
+    TCCR1B = (1 << WGM12);
+    TIMSK1 &= ~((1 << OCIE1A) | (1 << OCIE1B));
+}
+
+/**
+ * Timer1比较匹配中断：每次匹配发出一步，并由加减速曲线给出下一步间隔
+ * CTC模式下TCNT1在匹配时已清零，此处写入的OCR1A作用于下一个间隔
+ */
+ISR(TIMER1_COMPA_vect) {
+    uint16_t next_delay;
+
+#ifdef STEPPER_TIMING_STATS
+    // 入口处的计数值即本步的超时，OCR1A此时仍是本步的预定间隔
+    uint16_t timing_overrun = TCNT1;
+    uint16_t timing_scheduled = OCR1A + 1;
+#endif
+
+    // 预励磁锁定结束：本次中断不走步，装载第一步（或间隙空转）的间隔
+    if (lock_in_next_delay > 0) {
+        OCR1A = lock_in_next_delay - 1;
+        lock_in_next_delay = 0;
+        return;
+    }
+
+    // 间隙空转：只推进线圈序列，不计入绝对位置和步数，空转完成后开始正常的加减速曲线
+    if (takeup_remaining > 0) {
+        stepper_motor_advance_sequence();
+        takeup_remaining--;
+        if (takeup_remaining > 0) {
+            OCR1A = stepper_motor_takeup_interval() - 1;
+        } else if (takeup_next_delay == 0) {
+            // 空转期间收到停止命令
+            stepper_motor_finish_move();
+        } else {
+            OCR1A = takeup_next_delay - 1;
+        }
+        return;
+    }
+
+    // 停留段：等待下一段停留时间，停留结束后装载下一个运动段
+    if (dwelling) {
+        if (dwell_ticks > 0) {
+            next_delay = stepper_motor_next_dwell_chunk();
+        } else {
+            dwelling = false;
+            next_delay = stepper_motor_load_next_segment();
+        }
+        if (next_delay == 0) {
+            stepper_motor_finish_move();
+            return;
+        }
+        OCR1A = next_delay - 1;
+        return;
+    }
+
+#ifdef STEPPER_TIMING_STATS
+    stepper_timing_record(timing_overrun, timing_scheduled);
+#endif
+
+    if (coordinated) {
+        stepper_motor_step_axes();
+    } else {
+        stepper_motor_step();
+    }
+
+    // 如果不是连续转动，检查是否完成目标步数，完成后直接衔接队列中的下一段
+    if (motor_state.remaining_steps > 0) {
+        motor_state.remaining_steps--;
+        if (motor_state.remaining_steps == 0) {
+            if (coordinated) {
+                stepper_motor_release_axes();
+            }
+            if (blended_segments > 0 && stepper_motor_continue_blended()) {
+                // 衔接段：沿同一条加减速曲线继续，不在段间减速
+                next_delay = stepper_ramp_next_delay(&ramp);
+                if (next_delay == 0) {
+                    stepper_motor_finish_move();
+                    return;
+                }
+                stepper_motor_select_drive(next_delay);
+                OCR1A = next_delay - 1;
+                return;
+            }
+            next_delay = stepper_motor_load_next_segment();
+            if (next_delay == 0) {
+                stepper_motor_finish_move();
+                return;
+            }
+            stepper_motor_select_drive(next_delay);
+            OCR1A = next_delay - 1;
+            return;
+        }
+    }
+
+    ramp_phase_t previous_phase = ramp.phase;
+    next_delay = stepper_ramp_next_delay(&ramp);
+    if (next_delay == 0) {
+        // 减速停止完成；运行中收到的新运动命令从静止开始执行
+        if (coordinated) {
+            stepper_motor_release_axes();
+        }
+        stepper_motor_take_direction();
+        next_delay = stepper_motor_start_deferred();
+        if (next_delay == 0) {
+            stepper_motor_finish_move();
+            return;
+        }
+        stepper_motor_select_drive(next_delay);
+        OCR1A = next_delay - 1;
+        return;
+    }
+    if (ramp.phase == RAMP_RUN && previous_phase == RAMP_ACCEL) {
+        pending_events |= STEPPER_EVENT_CRUISE;
+    }
+
+    stepper_motor_select_drive(next_delay);
+    OCR1A = next_delay - 1;
+
+    // 巡航阶段在本步后的固定时刻采样电流（加减速时电流随速度变化，不作判断）
+    if (ramp.phase == RAMP_RUN && !coordinated) {
+        stepper_stall_arm(stepper_motor_pattern_class(), next_delay);
+    }
+}
+
+/**
+ * 当前线圈组合分类：0为单线圈（或细分），1为双线圈
+ */
+static inline uint8_t stepper_motor_pattern_class() {
+    switch (motor_state.step_mode) {
+        case STEP_MODE_FULL:  return 1;
+        case STEP_MODE_HALF:  return motor_state.current_step & 0x01;
+        case STEP_MODE_AUTO:  return full_drive ? 1 : (motor_state.current_step & 0x01);
+        default:              return 0;
+    }
+}
+
+/**
+ * 执行一步
+ */
+void stepper_motor_step() {
+    stepper_motor_advance_sequence();
+
+    // 根据方向更新绝对位置
+    if (motor_state.direction == CLOCKWISE) {
+        motor_state.position++;
+    } else {
+        motor_state.position--;
+    }
+
+    // 增加步数计数器
+    step_counter++;
+}
+
+/**
+ * 按当前方向推进线圈序列并输出
+ */
+static void stepper_motor_advance_sequence() {
+    // 根据方向更新序列位置（序列长度为2的幂，按掩码回绕）
+    int step = motor_state.current_step + ((motor_state.direction == CLOCKWISE) ? 1 : -1);
+    motor_state.current_step = step & sequence_mask;
+
+    coil_output((uint8_t)motor_state.current_step);
+}
+
+/**
+ * 全步模式：输出全步序列
+ */
+static void stepper_output_full(uint8_t step) {
+    stepper_rotation_full_coils::write(step);
+}
+
+/**
+ * 半步模式：输出半步序列
+ */
+static void stepper_output_half(uint8_t step) {
+    stepper_rotation_coils::write(step);
+}
+
+/**
+ * 自动模式：全步驱动时偶数半步位置（单线圈组合）不更新线圈，线圈始终为双线圈组合
+ */
+static void stepper_output_auto(uint8_t step) {
+    if (!full_drive || (step & 0x01)) {
+        stepper_rotation_coils::write(step);
+    }
+}
+
+/**
+ * 细分模式：按电角度设置线圈PWM占空比
+ */
+static void stepper_output_micro(uint8_t step) {
+    stepper_microstep_set_phase(stepper_motor_phase_of(STEP_MODE_MICRO, motor_state.microsteps, step),
+                                STEPPER_PWM_LEVELS);
+}
+
+/**
+ * 按当前步进模式选定线圈输出函数和序列长度（在ATOMIC_BLOCK内或电机初始化时调用）
+ */
+static void stepper_motor_bind_output() {
+    switch (motor_state.step_mode) {
+        case STEP_MODE_FULL:  coil_output = stepper_output_full;  break;
+        case STEP_MODE_HALF:  coil_output = stepper_output_half;  break;
+        case STEP_MODE_AUTO:  coil_output = stepper_output_auto;  break;
+        default:              coil_output = stepper_output_micro; break;
+    }
+
+    // 一个电周期的步数（细分模式为16/32/64个微步）
+    sequence_mask = 4 * stepper_motor_units_per_full(motor_state.step_mode, motor_state.microsteps) - 1;
+}
+
+/**
+ * 自动步进模式：按下一步间隔选择半步或全步驱动（带回差）
+ * 线圈序列位置始终以半步计，切换时电角度连续，不会失步
+ */
+static inline void stepper_motor_select_drive(uint16_t next_delay) {
+    if (motor_state.step_mode != STEP_MODE_AUTO) {
+        return;
+    }
+    if (full_drive) {
+        if (next_delay > AUTO_FULL_EXIT_TICKS) full_drive = false;
+    } else if (next_delay < AUTO_FULL_ENTER_TICKS) {
+        full_drive = true;
+    }
+}
+
+/**
+ * 设置步进模式
+ */
+void stepper_motor_set_step_mode(step_mode_t mode) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        step_mode_t old_mode = motor_state.step_mode;
+        uint8_t microsteps = motor_state.microsteps;
+
+        // 绝对位置换算到新步进模式的单位（全步1步 = 半步2步 = 细分N步）
+        stepper_motor_rescale_position(stepper_motor_units_per_full(old_mode, microsteps),
+                                       stepper_motor_units_per_full(mode, microsteps));
+
+        // 序列位置按电角度换算，避免切换模式时转子跳动
+        uint8_t phase = stepper_motor_phase_of(old_mode, microsteps, motor_state.current_step);
+        motor_state.current_step = stepper_motor_step_of(mode, microsteps, phase);
+        motor_state.step_mode = mode;
+        stepper_motor_bind_output();
+
+        // 离开细分模式时停止线圈PWM
+        if (old_mode == STEP_MODE_MICRO && mode != STEP_MODE_MICRO) {
+            stepper_microstep_release();
+        }
+        full_drive = false;
+    }
+
+    stepper_motor_refresh_gear();
+    stepper_motor_apply_bands();
+    stepper_motor_refresh_interval();
+    if (governor_limit_accel > 0) {
+        stepper_motor_apply_acceleration();
+    }
+}
+
+/**
+ * 设置细分数（每全步微步数）
+ * @param microsteps 4、8或16，其他值忽略；在细分模式下立即换算位置
+ */
+void stepper_motor_set_microsteps(uint8_t microsteps) {
+    if (!stepper_microstep_is_valid_resolution(microsteps)) return;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (motor_state.step_mode == STEP_MODE_MICRO) {
+            uint8_t phase = stepper_motor_phase_of(STEP_MODE_MICRO, motor_state.microsteps,
+                                                   motor_state.current_step);
+            stepper_motor_rescale_position(motor_state.microsteps, microsteps);
+            motor_state.current_step = stepper_motor_step_of(STEP_MODE_MICRO, microsteps, phase);
+        }
+        motor_state.microsteps = microsteps;
+        stepper_motor_bind_output();
+    }
+
+    stepper_motor_refresh_gear();
+    stepper_motor_apply_bands();
+    stepper_motor_refresh_interval();
+    if (governor_limit_accel > 0) {
+        stepper_motor_apply_acceleration();
+    }
+}
+
+/**
+ * 绝对位置换算到新的每全步步数（在ATOMIC_BLOCK内调用）
+ * 按1/16全步精确换算：向下取整（负数同样向负方向），余数存入position_fraction，
+ * 以后换回更细的单位时补回。只用32位运算：先按旧单位拆成整全步和余下的1/16全步，
+ * 整全步乘新单位，超出32位时饱和
+ */
+static void stepper_motor_rescale_position(uint8_t old_units, uint8_t new_units) {
+    if (old_units == new_units) {
+        return;
+    }
+
+    int32_t full = motor_state.position / old_units;
+    int32_t part = motor_state.position % old_units;
+    if (part < 0) {
+        part += old_units;
+        full--;
+    }
+
+    // 不足一全步的部分（1/16全步，0 ~ 15）
+    uint8_t sixteenths = (uint8_t)(part * (STEPPER_MICROSTEP_PHASES_PER_FULL / old_units) + position_fraction);
+    uint8_t per_step = STEPPER_MICROSTEP_PHASES_PER_FULL / new_units;
+
+    const int32_t position_max = 0x7FFFFFFFL;
+    if (full > (position_max - new_units) / new_units) {
+        motor_state.position = position_max;
+    } else if (full < (-position_max - 1) / new_units) {
+        motor_state.position = -position_max - 1;
+    } else {
+        motor_state.position = full * new_units + sixteenths / per_step;
+    }
+    position_fraction = sixteenths % per_step;
+}
+
+/**
+ * 每全步对应的步数（全步1，半步和自动模式2，细分为细分数）
+ */
+static uint8_t stepper_motor_units_per_full(step_mode_t mode, uint8_t microsteps) {
+    switch (mode) {
+        case STEP_MODE_FULL:  return 1;
+        case STEP_MODE_HALF:
+        case STEP_MODE_AUTO:  return 2;
+        default:              return microsteps;
+    }
+}
+
+/**
+ * 序列位置对应的电角度（0 ~ 63，1/16全步）
+ * 半步序列第0步（仅PE0通电）为相位0，全步序列第0步（PE0+PE1）为相位8
+ */
+static uint8_t stepper_motor_phase_of(step_mode_t mode, uint8_t microsteps, int step) {
+    switch (mode) {
+        case STEP_MODE_FULL:  return 8 + step * 16;
+        case STEP_MODE_HALF:
+        case STEP_MODE_AUTO:  return step * 8;
+        default:              return step * (STEPPER_MICROSTEP_PHASES_PER_FULL / microsteps);
+    }
+}
+
+/**
+ * 电角度对应的最近序列位置
+ */
+static int stepper_motor_step_of(step_mode_t mode, uint8_t microsteps, uint8_t phase) {
+    switch (mode) {
+        case STEP_MODE_FULL:
+            return phase / 16;
+        case STEP_MODE_HALF:
+        case STEP_MODE_AUTO:
+            return ((phase + 4) / 8) % STEP_SEQUENCE_LENGTH_HALF;
+        default: {
+            uint8_t stride = STEPPER_MICROSTEP_PHASES_PER_FULL / microsteps;
+            return ((phase + stride / 2) / stride) % (4 * microsteps);
+        }
+    }
 }
 
 /**
@@ -298,17 +2064,11 @@ void stepper_motor_enable_low_heat_mode() {
 }
 
 /**
- * 设置引脚状态
+ * 设置引脚状态（C接口，步进中断内直接使用模板驱动）
  */
 void stepper_motor_set_pins(uint8_t step_pattern) {
-    // 清除所有引脚 - 确保完全断电
-    PORTE &= ~((1 << PE0) | (1 << PE1) | (1 << PE2) | (1 << PE3));
-
-    // 根据步进模式设置引脚
-    if (step_pattern & 0x01) PORTE |= (1 << PE0);  // INT1
-    if (step_pattern & 0x02) PORTE |= (1 << PE1);  // INT2
-    if (step_pattern & 0x04) PORTE |= (1 << PE2);  // INT3
-    if (step_pattern & 0x08) PORTE |= (1 << PE3);  // INT4
+    // 4个线圈一次写入旋转轴端口
+    stepper_axis_write(STEPPER_AXIS_ROTATION, step_pattern);
 
     if (high_torque_mode) {
         delayMicroseconds(50);
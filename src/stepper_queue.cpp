@@ -0,0 +1,88 @@
+#include <util/atomic.h>
+#include "stepper_queue.h"
+
+// 环形缓冲区：head只由生产者写，tail只由消费者写，单字节读写在AVR上是原子的
+static volatile motion_segment_t queue_buffer[STEPPER_QUEUE_SIZE];
+static volatile uint8_t queue_head = 0;
+static volatile uint8_t queue_tail = 0;
+
+/**
+ * 追加一个运动段（主循环调用）
+ * 先写入数据再移动head，中断看到新的head时数据已经完整
+ * @return 队列已满时返回false
+ */
+bool stepper_queue_push(const motion_segment_t* segment) {
+    uint8_t head = queue_head;
+    uint8_t next = (head + 1) & STEPPER_QUEUE_MASK;
+
+    if (next == queue_tail) {
+        return false;
+    }
+
+    queue_buffer[head].type = segment->type;
+    queue_buffer[head].arg = segment->arg;
+    queue_buffer[head].value = segment->value;
+    queue_head = next;
+    return true;
+}
+
+/**
+ * 取出一个运动段（Timer1中断调用）
+ * @return 队列为空时返回false
+ */
+bool stepper_queue_pop(motion_segment_t* segment) {
+    uint8_t tail = queue_tail;
+
+    if (tail == queue_head) {
+        return false;
+    }
+
+    segment->type = queue_buffer[tail].type;
+    segment->arg = queue_buffer[tail].arg;
+    segment->value = queue_buffer[tail].value;
+    queue_tail = (tail + 1) & STEPPER_QUEUE_MASK;
+    return true;
+}
+
+/**
+ * 查看队列中第index个等待执行的段但不取出（Timer1中断调用，用于前瞻规划）
+ * 已写入的段在被消费前不会再被生产者修改，无需关中断
+ * @return 队列中没有第index段时返回false
+ */
+bool stepper_queue_peek(uint8_t index, motion_segment_t* segment) {
+    uint8_t tail = queue_tail;
+
+    if (index >= ((queue_head - tail) & STEPPER_QUEUE_MASK)) {
+        return false;
+    }
+
+    uint8_t slot = (tail + index) & STEPPER_QUEUE_MASK;
+    segment->type = queue_buffer[slot].type;
+    segment->arg = queue_buffer[slot].arg;
+    segment->value = queue_buffer[slot].value;
+    return true;
+}
+
+/**
+ * 取消所有未执行的运动段
+ * 同时修改head和tail，需要关中断
+ */
+void stepper_queue_clear() {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        queue_tail = queue_head;
+    }
+}
+
+/**
+ * 获取队列中等待执行的段数
+ */
+uint8_t stepper_queue_count() {
+    return (queue_head - queue_tail) & STEPPER_QUEUE_MASK;
+}
+
+/**
+ * 获取队列剩余空位
+ */
+uint8_t stepper_queue_free() {
+    return STEPPER_QUEUE_MASK - stepper_queue_count();
+}
@@ -0,0 +1,927 @@
+#include "stepper_ramp.h"
+#include "stepper_ramp_table.h"
+
+// Q4速度换算：v(Q4) = STEPPER_RAMP_Q4_FREQ / 间隔(tick)
+#define STEPPER_RAMP_Q4_FREQ     (STEPPER_TIMER_FREQ * 16UL)
+// 速度积分：dv(Q4) = a × c / (f / 16)
+#define STEPPER_RAMP_Q4_DIVISOR  (STEPPER_TIMER_FREQ / 16UL)
+
+static uint16_t trapezoid_plan(stepper_ramp_t* ramp, uint32_t steps, uint16_t cruise_delay);
+static bool trapezoid_set_cruise(stepper_ramp_t* ramp, uint16_t cruise_delay);
+static bool trapezoid_begin_stop(stepper_ramp_t* ramp);
+static uint16_t trapezoid_next_delay(stepper_ramp_t* ramp);
+static uint16_t table_plan(stepper_ramp_t* ramp, uint32_t steps, uint16_t cruise_delay, uint8_t length);
+static bool table_begin_stop(stepper_ramp_t* ramp);
+static uint16_t table_next_delay(stepper_ramp_t* ramp);
+static void table_to_trapezoid(stepper_ramp_t* ramp);
+static bool trapezoid_extend(stepper_ramp_t* ramp, uint32_t steps);
+static uint16_t scurve_plan(stepper_ramp_t* ramp, uint32_t steps, uint16_t cruise_delay);
+static bool scurve_set_cruise(stepper_ramp_t* ramp, uint16_t cruise_delay);
+static bool scurve_begin_stop(stepper_ramp_t* ramp);
+static uint16_t scurve_next_delay(stepper_ramp_t* ramp);
+static inline uint16_t ramp_skip_bands(const stepper_ramp_t* ramp, uint16_t delay);
+
+/**
+ * 32位整数平方根（逐位试商法，无浮点）
+ */
+uint16_t stepper_isqrt32(uint32_t value) {
+    uint32_t result = 0;
+    uint32_t bit = 1UL << 30;
+
+    while (bit > value) {
+        bit >>= 2;
+    }
+
+    while (bit != 0) {
+        if (value >= result + bit) {
+            value -= result + bit;
+            result = (result >> 1) + bit;
+        } else {
+            result >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return (uint16_t)result;
+}
+
+/**
+ * 设置加速度并预计算第一步间隔c0
+ * @param acceleration 加速度（步/秒²），加速和减速共用
+ */
+void stepper_ramp_set_acceleration(stepper_ramp_t* ramp, uint16_t acceleration) {
+    if (acceleration < STEPPER_MIN_ACCELERATION) acceleration = STEPPER_MIN_ACCELERATION;
+    if (acceleration > STEPPER_MAX_ACCELERATION) acceleration = STEPPER_MAX_ACCELERATION;
+
+    ramp->acceleration = acceleration;
+
+    uint32_t c0 = 4UL * stepper_isqrt32(STEPPER_RAMP_C0_SQ_DIV16 / acceleration);
+    ramp->c0 = (c0 > 0xFFFF) ? 0xFFFF : (uint16_t)c0;
+}
+
+/**
+ * 设置S曲线加加速度
+ * @param jerk 加加速度（步/秒³）
+ */
+void stepper_ramp_set_jerk(stepper_ramp_t* ramp, uint16_t jerk) {
+    if (jerk < STEPPER_MIN_JERK) jerk = STEPPER_MIN_JERK;
+    if (jerk > STEPPER_MAX_JERK) jerk = STEPPER_MAX_JERK;
+
+    ramp->jerk = jerk;
+}
+
+/**
+ * 设置巡航间隔的小数部分（1/256 tick），在规划运动或修改巡航速度之前调用
+ */
+void stepper_ramp_set_cruise_fraction(stepper_ramp_t* ramp, uint8_t fraction) {
+    ramp->cruise_frac = fraction;
+    ramp->cruise_phase = 0;
+}
+
+/**
+ * 巡航间隔（DDA相位累加）
+ * 小数部分每步累加到8位相位，溢出时本步多等一个tick，长期平均间隔精确到1/256 tick
+ */
+static inline uint16_t ramp_cruise_delay(stepper_ramp_t* ramp) {
+    uint16_t sum = (uint16_t)ramp->cruise_phase + ramp->cruise_frac;
+    ramp->cruise_phase = (uint8_t)sum;
+    return ramp->min_delay + (sum >> 8);
+}
+
+/**
+ * 设置速度曲线类型，从下一次运动开始生效
+ */
+void stepper_ramp_set_profile(stepper_ramp_t* ramp, motion_profile_t profile) {
+    ramp->profile = profile;
+}
+
+/**
+ * 计算从静止加速到指定步进间隔所需的步数
+ * n = v² / (2a)，v = f / delay
+ */
+uint32_t stepper_ramp_steps_to_speed(const stepper_ramp_t* ramp, uint16_t delay) {
+    if (delay == 0 || delay >= ramp->c0) {
+        return 0;
+    }
+
+    uint32_t speed = (STEPPER_TIMER_FREQ + delay / 2) / delay;
+    return (speed * speed) / (2UL * ramp->acceleration);
+}
+
+/**
+ * 规划一次运动
+ * @param steps 总步数，STEPPER_RAMP_UNLIMITED表示连续转动
+ * @param cruise_delay 巡航步进间隔（tick）
+ * @return 第一步的间隔（tick）
+ */
+uint16_t stepper_ramp_plan(stepper_ramp_t* ramp, uint32_t steps, uint16_t cruise_delay) {
+    ramp->use_table = false;
+
+    if (ramp->profile == PROFILE_SCURVE) {
+        return ramp_skip_bands(ramp, scurve_plan(ramp, steps, cruise_delay));
+    }
+
+    // 默认加速度下的速度预设直接走编译期加速表（单步运动仍走运行时计算）
+    uint8_t length = stepper_ramp_table_lookup(ramp->acceleration, cruise_delay, &ramp->table);
+    if (length > 0 && steps >= 2) {
+        return ramp_skip_bands(ramp, table_plan(ramp, steps, cruise_delay, length));
+    }
+
+    return ramp_skip_bands(ramp, trapezoid_plan(ramp, steps, cruise_delay));
+}
+
+/**
+ * 运行中修改巡航速度
+ * 查表模式先转为运行时计算，从当前间隔继续
+ * @return true 当前运动的巡航速度已改变；false 速度未变或新速度在下次运动生效
+ */
+bool stepper_ramp_set_cruise(stepper_ramp_t* ramp, uint16_t cruise_delay) {
+    if (ramp->profile == PROFILE_SCURVE && !ramp->use_table) {
+        return scurve_set_cruise(ramp, cruise_delay);
+    }
+    if (cruise_delay == ramp->min_delay || (ramp->phase != RAMP_ACCEL && ramp->phase != RAMP_RUN)) {
+        return false;
+    }
+    if (ramp->use_table) {
+        table_to_trapezoid(ramp);
+    }
+    return trapezoid_set_cruise(ramp, cruise_delay);
+}
+
+/**
+ * 开始减速停止
+ * @return true 已进入减速流程；false 当前速度无需减速，可以立即停止
+ */
+bool stepper_ramp_begin_stop(stepper_ramp_t* ramp) {
+    if (ramp->use_table) {
+        return table_begin_stop(ramp);
+    }
+    if (ramp->profile == PROFILE_SCURVE) {
+        return scurve_begin_stop(ramp);
+    }
+    return trapezoid_begin_stop(ramp);
+}
+
+/**
+ * 运行中把计数运动延长steps步，沿同一条曲线继续（前瞻衔接运行中追加的转动段）
+ * 查表模式先转为运行时计算，短距离运动可以继续加速到巡航速度
+ * @return false 表示已开始减速、正在停止或为连续转动，无法延长
+ */
+bool stepper_ramp_extend(stepper_ramp_t* ramp, uint32_t steps) {
+    if (ramp->phase != RAMP_ACCEL && ramp->phase != RAMP_RUN) {
+        return false;
+    }
+    if (ramp->decel_start == STEPPER_RAMP_UNLIMITED || ramp->decel_start <= ramp->step_count + 1) {
+        return false;
+    }
+
+    if (ramp->profile == PROFILE_SCURVE && !ramp->use_table) {
+        // 峰值速度已在起步时按原步数确定，延长部分以该峰值巡航
+        if (ramp->stopping || ramp->total_steps == STEPPER_RAMP_UNLIMITED) {
+            return false;
+        }
+        ramp->total_steps += steps;
+        return true;
+    }
+
+    if (ramp->use_table) {
+        table_to_trapezoid(ramp);
+    }
+    return trapezoid_extend(ramp, steps);
+}
+
+/**
+ * 计算下一步的间隔（每发出一步后调用一次）
+ * @return 下一步间隔（tick），0表示运动结束
+ */
+uint16_t stepper_ramp_next_delay(stepper_ramp_t* ramp) {
+    if (ramp->use_table) {
+        return ramp_skip_bands(ramp, table_next_delay(ramp));
+    }
+    if (ramp->profile == PROFILE_SCURVE) {
+        return ramp_skip_bands(ramp, scurve_next_delay(ramp));
+    }
+    return ramp_skip_bands(ramp, trapezoid_next_delay(ramp));
+}
+
+/**
+ * 设置共振禁区
+ * @param index 禁区编号（0 ~ STEPPER_RAMP_MAX_BANDS-1）
+ * @param low_delay 禁区内最短步进间隔（tick，对应最高步速）
+ * @param high_delay 禁区内最长步进间隔（tick，对应最低步速），low和high都为0表示关闭
+ */
+void stepper_ramp_set_band(stepper_ramp_t* ramp, uint8_t index, uint16_t low_delay, uint16_t high_delay) {
+    if (index >= STEPPER_RAMP_MAX_BANDS) return;
+    if (low_delay > high_delay) {
+        uint16_t swap = low_delay;
+        low_delay = high_delay;
+        high_delay = swap;
+    }
+    ramp->band_low[index] = low_delay;
+    ramp->band_high[index] = high_delay;
+
+    ramp->has_bands = false;
+    for (uint8_t i = 0; i < STEPPER_RAMP_MAX_BANDS; i++) {
+        if (ramp->band_high[i] != 0) {
+            ramp->has_bands = true;
+        }
+    }
+}
+
+/**
+ * 把落在共振禁区内的步进间隔移到禁区边缘
+ * @param prefer 负数取快侧边缘，正数取慢侧边缘，0取较近的边缘
+ */
+uint16_t stepper_ramp_avoid_bands(const stepper_ramp_t* ramp, uint16_t delay, int8_t prefer) {
+    for (uint8_t i = 0; i < STEPPER_RAMP_MAX_BANDS; i++) {
+        uint16_t low = ramp->band_low[i];
+        uint16_t high = ramp->band_high[i];
+        if (high == 0 || delay < low || delay > high) {
+            continue;
+        }
+
+        if (prefer == 0) {
+            prefer = (delay - low <= high - delay) ? -1 : 1;
+        }
+        if (prefer < 0 && low > 1) {
+            return low - 1;
+        }
+        return (high < 0xFFFF) ? high + 1 : high;
+    }
+    return delay;
+}
+
+/**
+ * 加减速经过共振禁区时直接跳到禁区边缘（加速取快侧，减速取慢侧）
+ * 只替换本步的输出间隔，不改动加减速递推状态，因此步数规划不受影响
+ */
+static inline uint16_t ramp_skip_bands(const stepper_ramp_t* ramp, uint16_t delay) {
+    if (delay == 0 || !ramp->has_bands) {
+        return delay;
+    }
+    return stepper_ramp_avoid_bands(ramp, delay, ramp->phase == RAMP_DECEL ? 1 : -1);
+}
+
+/**
+ * 梯形曲线：规划一次运动
+ */
+static uint16_t trapezoid_plan(stepper_ramp_t* ramp, uint32_t steps, uint16_t cruise_delay) {
+    ramp->min_delay = cruise_delay;
+    ramp->step_count = 0;
+    ramp->accel_count = 0;
+    ramp->rest = 0;
+
+    // 巡航速度低于起步速度，无需加减速，走完全部步数后直接停止
+    if (ramp->c0 <= cruise_delay) {
+        ramp->phase = RAMP_RUN;
+        ramp->step_delay = cruise_delay;
+        ramp->last_accel_delay = cruise_delay;
+        ramp->decel_val = 0;
+        ramp->decel_start = steps;
+        return ramp->step_delay;
+    }
+
+    ramp->phase = RAMP_ACCEL;
+    ramp->step_delay = ramp->c0;
+    ramp->last_accel_delay = ramp->c0;
+
+    if (steps == 1) {
+        // 单步运动：以c0走一步后结束
+        ramp->phase = RAMP_RUN;
+        ramp->decel_val = 0;
+        ramp->decel_start = 1;
+        return ramp->step_delay;
+    }
+
+    if (steps == STEPPER_RAMP_UNLIMITED) {
+        // 连续转动：减速点在stepper_ramp_begin_stop()中确定
+        ramp->decel_val = 0;
+        ramp->decel_start = STEPPER_RAMP_UNLIMITED;
+        return ramp->step_delay;
+    }
+
+    // 达到巡航速度所需步数
+    uint32_t max_s_lim = stepper_ramp_steps_to_speed(ramp, cruise_delay);
+    if (max_s_lim == 0) {
+        max_s_lim = 1;
+    }
+
+    // 加减速相同，无法达到巡航速度时在中点开始减速（三角形曲线）
+    uint32_t accel_lim = steps / 2;
+    if (accel_lim == 0) {
+        accel_lim = 1;
+    }
+
+    if (accel_lim <= max_s_lim) {
+        ramp->decel_val = (int32_t)accel_lim - (int32_t)steps;
+    } else {
+        ramp->decel_val = -(int32_t)max_s_lim;
+    }
+    if (ramp->decel_val == 0) {
+        ramp->decel_val = -1;
+    }
+
+    ramp->decel_start = steps + ramp->decel_val;
+    return ramp->step_delay;
+}
+
+/**
+ * 梯形曲线：运行中修改巡航速度
+ * 连续转动时加速到新速度或直接降到新速度；
+ * 计数运动只允许降速（减速点按新速度后移），提速在下次运动生效
+ */
+static bool trapezoid_set_cruise(stepper_ramp_t* ramp, uint16_t cruise_delay) {
+    if (ramp->decel_start == STEPPER_RAMP_UNLIMITED) {
+        ramp->min_delay = cruise_delay;
+        if (ramp->phase == RAMP_RUN && cruise_delay < ramp->step_delay) {
+            // 提速：从当前n继续加速
+            ramp->phase = RAMP_ACCEL;
+            ramp->rest = 0;
+        } else if (cruise_delay >= ramp->step_delay) {
+            // 降速：直接切换到较低速度，不会失步
+            ramp->phase = RAMP_RUN;
+            ramp->step_delay = cruise_delay;
+            ramp->last_accel_delay = cruise_delay;
+            ramp->accel_count = stepper_ramp_steps_to_speed(ramp, cruise_delay);
+        }
+        return true;
+    }
+
+    if (cruise_delay < ramp->min_delay) {
+        return false;
+    }
+    ramp->min_delay = cruise_delay;
+
+    if (cruise_delay >= ramp->step_delay) {
+        // 降到当前速度以下：直接切换，减速段从新速度开始，终点不变
+        uint32_t total = ramp->decel_start - ramp->decel_val;
+        int32_t decel = (int32_t)stepper_ramp_steps_to_speed(ramp, cruise_delay);
+
+        ramp->phase = RAMP_RUN;
+        ramp->step_delay = cruise_delay;
+        ramp->last_accel_delay = cruise_delay;
+        ramp->rest = 0;
+        ramp->decel_val = -decel;
+        ramp->decel_start = total - decel;
+        return true;
+    }
+
+    // 仍在加速且新速度高于当前速度：提前结束加速，按新速度重新确定减速点
+    return trapezoid_extend(ramp, 0);
+}
+
+/**
+ * 梯形曲线：延长计数运动，按新的总步数重新确定减速点
+ */
+static bool trapezoid_extend(stepper_ramp_t* ramp, uint32_t steps) {
+    uint32_t total = ramp->decel_start - ramp->decel_val + steps;
+
+    if (ramp->decel_val == 0) {
+        // 匀速运动（巡航速度不高于起步速度）直接后移终点；单步运动以c0起步，不能直接升到巡航速度
+        if (ramp->c0 > ramp->min_delay) {
+            return false;
+        }
+        ramp->decel_start = total;
+        return true;
+    }
+
+    if (ramp->phase == RAMP_RUN) {
+        // 已在巡航，减速距离不变
+        ramp->decel_start += steps;
+        return true;
+    }
+
+    // 仍在加速：与trapezoid_plan()相同，按新的总步数重新判断能否达到巡航速度
+    uint32_t max_s_lim = stepper_ramp_steps_to_speed(ramp, ramp->min_delay);
+    if (max_s_lim == 0) {
+        max_s_lim = 1;
+    }
+    uint32_t accel_lim = total / 2;
+    ramp->decel_val = (accel_lim <= max_s_lim) ? (int32_t)accel_lim - (int32_t)total : -(int32_t)max_s_lim;
+    if (ramp->decel_val == 0) {
+        ramp->decel_val = -1;
+    }
+    ramp->decel_start = total + ramp->decel_val;
+    return true;
+}
+
+/**
+ * 梯形曲线：开始减速停止
+ */
+static bool trapezoid_begin_stop(stepper_ramp_t* ramp) {
+    switch (ramp->phase) {
+        case RAMP_ACCEL:
+        case RAMP_RUN:
+            if (ramp->accel_count <= 0) {
+                return false;
+            }
+            // 以加速时走过的步数对称减速
+            ramp->decel_val = -ramp->accel_count;
+            ramp->decel_start = ramp->step_count;
+            return true;
+        case RAMP_DECEL:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * 梯形曲线：计算下一步的间隔
+ * 参照AVR446应用笔记：c(n) = c(n-1) - 2·c(n-1) / (4n + 1)，余数累积到下一步
+ */
+static uint16_t trapezoid_next_delay(stepper_ramp_t* ramp) {
+    int32_t new_step_delay = ramp->step_delay;
+
+    switch (ramp->phase) {
+        case RAMP_ACCEL: {
+            ramp->step_count++;
+            ramp->accel_count++;
+            if (ramp->step_count >= ramp->decel_start && ramp->accel_count >= -ramp->decel_val) {
+                // 三角形曲线偶数步或加速中途停止：折返时重复一次当前间隔，不再多加速一步，减速段与加速段对称
+                ramp->accel_count = ramp->decel_val;
+                ramp->phase = RAMP_DECEL;
+                break;
+            }
+            int32_t denom = 4L * ramp->accel_count + 1;
+            int32_t numer = 2L * ramp->step_delay + ramp->rest;
+            new_step_delay = ramp->step_delay - numer / denom;
+            ramp->rest = numer % denom;
+
+            if (ramp->step_count >= ramp->decel_start) {
+                ramp->accel_count = ramp->decel_val;
+                ramp->phase = RAMP_DECEL;
+            } else if (new_step_delay <= ramp->min_delay) {
+                ramp->last_accel_delay = new_step_delay;
+                new_step_delay = ramp_cruise_delay(ramp);
+                ramp->rest = 0;
+                ramp->phase = RAMP_RUN;
+            }
+            break;
+        }
+
+        case RAMP_RUN:
+            ramp->step_count++;
+            new_step_delay = ramp_cruise_delay(ramp);
+            if (ramp->step_count >= ramp->decel_start) {
+                if (ramp->decel_val == 0) {
+                    ramp->phase = RAMP_STOP;
+                    return 0;
+                }
+                ramp->accel_count = ramp->decel_val;
+                new_step_delay = ramp->last_accel_delay;
+                ramp->phase = RAMP_DECEL;
+            }
+            break;
+
+        case RAMP_DECEL: {
+            ramp->step_count++;
+            ramp->accel_count++;
+            if (ramp->accel_count >= 0) {
+                ramp->phase = RAMP_STOP;
+                return 0;
+            }
+            int32_t denom = 4L * ramp->accel_count + 1;
+            int32_t numer = 2L * ramp->step_delay + ramp->rest;
+            new_step_delay = ramp->step_delay - numer / denom;
+            ramp->rest = numer % denom;
+            break;
+        }
+
+        default:
+            return 0;
+    }
+
+    if (new_step_delay > 0xFFFF) new_step_delay = 0xFFFF;
+    if (new_step_delay < 1) new_step_delay = 1;
+    ramp->step_delay = (uint16_t)new_step_delay;
+    return ramp->step_delay;
+}
+
+/**
+ * 查表模式：规划一次运动
+ * 加速段依次读取table[0..n-1]，减速段倒序读取，三角形曲线在中点折返
+ * @param length 加速到巡航速度需要的表项数
+ */
+static uint16_t table_plan(stepper_ramp_t* ramp, uint32_t steps, uint16_t cruise_delay, uint8_t length) {
+    uint8_t accel_len = length;
+    if (steps != STEPPER_RAMP_UNLIMITED && steps / 2 < accel_len) {
+        accel_len = (uint8_t)(steps / 2);
+    }
+
+    ramp->use_table = true;
+    ramp->table_len = accel_len;
+    ramp->table_index = 0;
+    ramp->step_count = 0;
+    ramp->decel_start = (steps == STEPPER_RAMP_UNLIMITED) ? STEPPER_RAMP_UNLIMITED : steps - accel_len;
+    ramp->decel_val = 0;
+
+    // 未达到预设速度的短距离运动，中间多出的一步沿表再前进一项（见table_run_delay()）
+    ramp->table_limit = length;
+    ramp->min_delay = cruise_delay;
+
+    ramp->phase = RAMP_ACCEL;
+    ramp->step_delay = pgm_read_word(&ramp->table[0]);
+    return ramp->step_delay;
+}
+
+/**
+ * 查表模式：加速段之后的匀速间隔
+ * 短距离运动停在表的第table_len项，达到预设速度时按巡航间隔（含小数部分）
+ */
+static inline uint16_t table_run_delay(stepper_ramp_t* ramp) {
+    if (ramp->table_len < ramp->table_limit) {
+        return pgm_read_word(&ramp->table[ramp->table_len]);
+    }
+    return ramp_cruise_delay(ramp);
+}
+
+/**
+ * 查表模式：转为运行时计算（加速或巡航阶段），用于运行中延长运动或修改巡航速度
+ * 表项即AVR446递推的c(n)，下标就是n；递推余数未保存，从0重新累积
+ */
+static void table_to_trapezoid(stepper_ramp_t* ramp) {
+    uint8_t accel_steps = (ramp->phase == RAMP_ACCEL) ? ramp->table_index : ramp->table_len;
+
+    ramp->use_table = false;
+    ramp->rest = 0;
+    ramp->accel_count = accel_steps;
+    ramp->last_accel_delay = ramp->step_delay;
+    ramp->decel_val = (ramp->decel_start == STEPPER_RAMP_UNLIMITED) ? 0 : -(int32_t)ramp->table_len;
+    if (ramp->phase == RAMP_RUN && ramp->table_len < ramp->table_limit) {
+        // 短距离运动的匀速段低于预设速度，延长后从这里继续加速
+        ramp->phase = RAMP_ACCEL;
+    }
+}
+
+/**
+ * 查表模式：开始减速停止
+ * 从当前表下标倒序走回table[0]
+ */
+static bool table_begin_stop(stepper_ramp_t* ramp) {
+    switch (ramp->phase) {
+        case RAMP_ACCEL:
+            if (ramp->table_index == 0) {
+                return false;
+            }
+            // 已排定的下一步之后开始倒序查表
+            ramp->decel_start = ramp->step_count + 1;
+            return true;
+        case RAMP_RUN:
+            ramp->decel_start = ramp->step_count + 1;
+            ramp->table_index = ramp->table_len;
+            return true;
+        case RAMP_DECEL:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * 查表模式：计算下一步的间隔
+ * 热路径只有下标增减和一次Flash读取
+ */
+static uint16_t table_next_delay(stepper_ramp_t* ramp) {
+    ramp->step_count++;
+
+    if (ramp->phase != RAMP_DECEL && ramp->step_count >= ramp->decel_start) {
+        // 从加速段折返时先重复一次当前间隔，保证加减速对称
+        if (ramp->phase == RAMP_ACCEL) {
+            ramp->table_index++;
+        }
+        ramp->phase = RAMP_DECEL;
+    }
+
+    switch (ramp->phase) {
+        case RAMP_ACCEL:
+            ramp->table_index++;
+            if (ramp->table_index >= ramp->table_len) {
+                ramp->phase = RAMP_RUN;
+                ramp->step_delay = table_run_delay(ramp);
+            } else {
+                ramp->step_delay = pgm_read_word(&ramp->table[ramp->table_index]);
+            }
+            break;
+
+        case RAMP_RUN:
+            ramp->step_delay = table_run_delay(ramp);
+            break;
+
+        case RAMP_DECEL:
+            if (ramp->table_index == 0) {
+                ramp->phase = RAMP_STOP;
+                return 0;
+            }
+            ramp->table_index--;
+            ramp->step_delay = pgm_read_word(&ramp->table[ramp->table_index]);
+            break;
+
+        default:
+            return 0;
+    }
+
+    return ramp->step_delay;
+}
+
+/**
+ * S曲线：速度（Q4）转换为步进间隔（tick）
+ */
+static uint16_t scurve_velocity_to_delay(uint32_t velocity) {
+    uint32_t delay = STEPPER_RAMP_Q4_FREQ / velocity;
+    if (delay > 0xFFFF) delay = 0xFFFF;
+    if (delay < 1) delay = 1;
+    return (uint16_t)delay;
+}
+
+/**
+ * S曲线：加速度从0升到峰值再回到0所需时间（毫秒）
+ * 速度增量v（步/秒），返回从静止加速到v的总时间
+ */
+static uint32_t scurve_accel_time_ms(const stepper_ramp_t* ramp, uint32_t speed, uint16_t* peak_accel) {
+    uint32_t accel = ramp->acceleration;
+    uint32_t jerk = ramp->jerk;
+
+    // 步速不超过16位（间隔至少4 tick），下面各乘积都在32位范围内
+    if (speed > 0xFFFF) speed = 0xFFFF;
+
+    if (speed >= (accel * accel + jerk - 1) / jerk) {
+        // v·j ≥ a²，能达到最大加速度：T = v/a + a/j
+        *peak_accel = accel;
+        return (1000UL * speed) / accel + (1000UL * accel) / jerk;
+    }
+
+    // 达不到最大加速度：a_peak = sqrt(v·j)，T = 2·sqrt(v/j)
+    // 此时v·j < a²不会溢出；v×10⁶/j按商和余数分两次乘1000，避免v×10⁶溢出
+    *peak_accel = stepper_isqrt32(speed * jerk);
+    uint32_t scaled = 1000UL * speed;
+    uint32_t ratio = (scaled / jerk) * 1000UL + ((scaled % jerk) * 1000UL) / jerk;
+    return 2UL * stepper_isqrt32(ratio);
+}
+
+/**
+ * S曲线：从起步速度加速到speed所需步数（加速过程速度关于中点对称，平均速度取两端均值）
+ */
+static uint32_t scurve_accel_distance(const stepper_ramp_t* ramp, uint32_t speed, uint32_t floor_speed) {
+    uint16_t peak_accel;
+    uint32_t time_ms = scurve_accel_time_ms(ramp, speed - floor_speed, &peak_accel);
+    uint32_t speed_sum = speed + floor_speed;
+    // 按整秒和余下毫秒分开相乘，高速低加速度时不溢出
+    return (speed_sum * (time_ms / 1000UL)) / 2UL + (speed_sum * (time_ms % 1000UL)) / 2000UL;
+}
+
+/**
+ * S曲线：根据峰值速度和峰值加速度计算分段切换速度
+ * 加速度回落段的速度变化量为 a² / (2j)，Q4下为 8·a² / j
+ */
+static void scurve_update_thresholds(stepper_ramp_t* ramp) {
+    uint32_t jerk_span = (8UL * ramp->peak_accel * ramp->peak_accel) / ramp->jerk;
+
+    ramp->jerk_out_velocity = (ramp->peak_velocity > ramp->floor_velocity + jerk_span) ?
+                              ramp->peak_velocity - jerk_span : ramp->floor_velocity;
+    ramp->jerk_in_velocity = ramp->floor_velocity + jerk_span;
+}
+
+/**
+ * S曲线：规划一次运动
+ * 在起步时一次性求出可达的峰值速度，保证加速段用掉的步数不超过总步数的一半
+ */
+static uint16_t scurve_plan(stepper_ramp_t* ramp, uint32_t steps, uint16_t cruise_delay) {
+    ramp->min_delay = cruise_delay;
+    ramp->step_count = 0;
+    ramp->total_steps = steps;
+    ramp->accel_steps = 0;
+    ramp->accel_now = 0;
+    ramp->rest_accel = 0;
+    ramp->rest_velocity = 0;
+    ramp->accel_done = false;
+    ramp->stopping = false;
+
+    // 起步速度与梯形曲线的第一步相同
+    ramp->floor_velocity = STEPPER_RAMP_Q4_FREQ / ramp->c0;
+    ramp->velocity = ramp->floor_velocity;
+
+    uint32_t floor_speed = STEPPER_TIMER_FREQ / ramp->c0;
+    uint32_t speed = STEPPER_TIMER_FREQ / cruise_delay;
+
+    if (speed <= floor_speed) {
+        // 巡航速度不高于起步速度，直接匀速运行
+        ramp->phase = RAMP_RUN;
+        ramp->segment = SCURVE_CRUISE;
+        ramp->peak_velocity = STEPPER_RAMP_Q4_FREQ / cruise_delay;
+        ramp->velocity = ramp->peak_velocity;
+        ramp->peak_accel = 0;
+        ramp->accel_done = true;
+        ramp->full_cruise = true;
+        ramp->step_delay = ramp_cruise_delay(ramp);
+        return ramp->step_delay;
+    }
+
+    // 短距离运动：二分查找能在一半步数内加速到的最高速度
+    if (steps != STEPPER_RAMP_UNLIMITED && 2UL * scurve_accel_distance(ramp, speed, floor_speed) > steps) {
+        uint32_t low = floor_speed;
+        uint32_t high = speed;
+        while (high - low > 1) {
+            uint32_t mid = (low + high) / 2;
+            if (2UL * scurve_accel_distance(ramp, mid, floor_speed) <= steps) {
+                low = mid;
+            } else {
+                high = mid;
+            }
+        }
+        speed = low;
+        ramp->peak_velocity = speed * 16UL;
+        ramp->full_cruise = false;
+    } else {
+        ramp->peak_velocity = STEPPER_RAMP_Q4_FREQ / cruise_delay;
+        ramp->full_cruise = true;
+    }
+
+    scurve_accel_time_ms(ramp, speed - floor_speed, &ramp->peak_accel);
+    if (ramp->peak_accel == 0) {
+        ramp->peak_accel = 1;
+    }
+    scurve_update_thresholds(ramp);
+
+    ramp->phase = RAMP_ACCEL;
+    ramp->segment = SCURVE_JERK_UP;
+    if (ramp->segment == SCURVE_CRUISE && ramp->full_cruise) {
+        ramp->step_delay = ramp_cruise_delay(ramp);
+    } else {
+        ramp->step_delay = scurve_velocity_to_delay(ramp->velocity);
+    }
+    return ramp->step_delay;
+}
+
+/**
+ * S曲线：运行中修改巡航速度（仅连续转动）
+ */
+static bool scurve_set_cruise(stepper_ramp_t* ramp, uint16_t cruise_delay) {
+    bool changed = cruise_delay != ramp->min_delay;
+    ramp->min_delay = cruise_delay;
+
+    if (!changed || ramp->total_steps != STEPPER_RAMP_UNLIMITED || ramp->stopping || ramp->phase == RAMP_STOP) {
+        return false;
+    }
+
+    uint32_t new_velocity = STEPPER_RAMP_Q4_FREQ / cruise_delay;
+    if (new_velocity <= ramp->velocity) {
+        // 降速：直接切换
+        ramp->peak_velocity = new_velocity;
+        ramp->full_cruise = true;
+        ramp->velocity = new_velocity;
+        ramp->accel_now = 0;
+        ramp->segment = SCURVE_CRUISE;
+        ramp->phase = RAMP_RUN;
+    } else {
+        // 提速：重新进入加速段
+        ramp->peak_velocity = new_velocity;
+        ramp->full_cruise = true;
+        ramp->peak_accel = ramp->acceleration;
+        scurve_update_thresholds(ramp);
+        ramp->segment = SCURVE_JERK_UP;
+        ramp->phase = RAMP_ACCEL;
+        ramp->accel_done = false;
+    }
+    return true;
+}
+
+/**
+ * S曲线：开始减速停止
+ */
+static bool scurve_begin_stop(stepper_ramp_t* ramp) {
+    if (ramp->phase == RAMP_STOP) {
+        return false;
+    }
+    if (ramp->velocity <= ramp->floor_velocity) {
+        return false;
+    }
+
+    ramp->stopping = true;
+    if (ramp->segment < SCURVE_DECEL_JERK_IN) {
+        ramp->segment = SCURVE_DECEL_JERK_IN;
+        ramp->phase = RAMP_DECEL;
+        if (ramp->peak_accel == 0) {
+            ramp->peak_accel = ramp->acceleration;
+            scurve_update_thresholds(ramp);
+        }
+    }
+    return true;
+}
+
+/**
+ * S曲线：计算下一步的间隔
+ * 以上一步的间隔c为时间步长增量积分：a += j·c/f，v += a·c/f，余数累积到下一步
+ */
+static uint16_t scurve_next_delay(stepper_ramp_t* ramp) {
+    if (ramp->phase == RAMP_STOP) {
+        return 0;
+    }
+
+    ramp->step_count++;
+    if (ramp->total_steps != STEPPER_RAMP_UNLIMITED) {
+        if (ramp->step_count >= ramp->total_steps) {
+            ramp->phase = RAMP_STOP;
+            return 0;
+        }
+
+        // 对称减速：剩余步数等于加速段步数时开始减速（未到巡航则在中点）
+        uint32_t remaining = ramp->total_steps - ramp->step_count;
+        uint32_t mirror = ramp->accel_done ? ramp->accel_steps : ramp->step_count;
+        if (ramp->segment < SCURVE_DECEL_JERK_IN && remaining <= mirror) {
+            ramp->segment = SCURVE_DECEL_JERK_IN;
+            ramp->phase = RAMP_DECEL;
+        }
+    }
+
+    uint16_t c = ramp->step_delay;
+
+    // 加速度变化量 |da| = j·c / f
+    uint32_t jerk_term = (uint32_t)ramp->jerk * c + ramp->rest_accel;
+    int32_t delta_accel = jerk_term / STEPPER_TIMER_FREQ;
+    ramp->rest_accel = jerk_term % STEPPER_TIMER_FREQ;
+
+    int32_t peak = ramp->peak_accel;
+    switch (ramp->segment) {
+        case SCURVE_JERK_UP:
+            ramp->accel_now += delta_accel;
+            if (ramp->accel_now >= peak) {
+                ramp->accel_now = peak;
+                ramp->segment = SCURVE_CONST_ACCEL;
+            }
+            break;
+        case SCURVE_JERK_DOWN:
+            ramp->accel_now -= delta_accel;
+            if (ramp->accel_now < 0) {
+                ramp->accel_now = 0;
+            }
+            break;
+        case SCURVE_DECEL_JERK_IN:
+            ramp->accel_now -= delta_accel;
+            if (ramp->accel_now <= -peak) {
+                ramp->accel_now = -peak;
+                ramp->segment = SCURVE_CONST_DECEL;
+            }
+            break;
+        case SCURVE_DECEL_JERK_OUT:
+            ramp->accel_now += delta_accel;
+            if (ramp->accel_now > 0) {
+                ramp->accel_now = 0;
+            }
+            break;
+        case SCURVE_CRUISE:
+            ramp->accel_now = 0;
+            break;
+        default:
+            break;
+    }
+
+    // 速度积分（Q4）
+    int32_t velocity_term = ramp->accel_now * (int32_t)c + ramp->rest_velocity;
+    int32_t delta_velocity = velocity_term / (int32_t)STEPPER_RAMP_Q4_DIVISOR;
+    ramp->rest_velocity = velocity_term % (int32_t)STEPPER_RAMP_Q4_DIVISOR;
+
+    int32_t velocity = (int32_t)ramp->velocity + delta_velocity;
+    if (velocity < (int32_t)ramp->floor_velocity) velocity = ramp->floor_velocity;
+    if (velocity > (int32_t)ramp->peak_velocity) velocity = ramp->peak_velocity;
+    ramp->velocity = velocity;
+
+    // 按速度阈值切换分段，离散误差不会累积到相位切换上
+    switch (ramp->segment) {
+        case SCURVE_JERK_UP:
+        case SCURVE_CONST_ACCEL:
+            if (ramp->velocity >= ramp->jerk_out_velocity) {
+                ramp->segment = SCURVE_JERK_DOWN;
+            }
+            break;
+        case SCURVE_JERK_DOWN:
+            if (ramp->accel_now == 0 || ramp->velocity >= ramp->peak_velocity) {
+                ramp->accel_now = 0;
+                ramp->velocity = ramp->peak_velocity;
+                ramp->rest_velocity = 0;
+                ramp->segment = SCURVE_CRUISE;
+                ramp->phase = RAMP_RUN;
+                ramp->accel_done = true;
+                ramp->accel_steps = ramp->step_count;
+            }
+            break;
+        case SCURVE_DECEL_JERK_IN:
+        case SCURVE_CONST_DECEL:
+            if (ramp->velocity <= ramp->jerk_in_velocity) {
+                ramp->segment = SCURVE_DECEL_JERK_OUT;
+            }
+            break;
+        case SCURVE_DECEL_JERK_OUT:
+            if (ramp->stopping && (ramp->accel_now == 0 || ramp->velocity <= ramp->floor_velocity)) {
+                // 中途停止请求：降到起步速度即结束
+                ramp->phase = RAMP_STOP;
+                return 0;
+            }
+            break;
+        default:
+            break;
+    }
+
+    ramp->step_delay = scurve_velocity_to_delay(ramp->velocity);
+    return ramp->step_delay;
+}
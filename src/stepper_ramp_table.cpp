@@ -0,0 +1,65 @@
+#include "stepper_ramp_table.h"
+#include "config.h"
+
+// 编译期加速表只针对默认加速度生成，截断于最快的速度预设
+// 速度预设是每全步间隔，半步/自动模式下每步间隔减半，表需覆盖到预设间隔的一半
+// 预设值只在常量表达式中使用，不占RAM；运行时从Flash中的MOTOR_SPEED_PRESETS读取
+constexpr uint8_t ramp_table_presets[] = {MOTOR_SPEED_PRESET_LIST};
+static_assert(sizeof(ramp_table_presets) == MOTOR_SPEED_PRESET_COUNT, "MOTOR_SPEED_PRESET_COUNT must match MOTOR_SPEED_PRESET_LIST");
+
+#define RAMP_TABLE_ACCELERATION  STEPPER_DEFAULT_ACCELERATION
+#define RAMP_TABLE_MIN_DELAY     ((uint16_t)(ramp_table_presets[0] * STEPPER_TICKS_PER_MS / 2))
+#define RAMP_TABLE_LENGTH        stepper_ct_ramp_length_for(RAMP_TABLE_ACCELERATION, RAMP_TABLE_MIN_DELAY)
+
+typedef stepper_ramp_table_data<RAMP_TABLE_ACCELERATION,
+                                stepper_ct_make_index_seq<RAMP_TABLE_LENGTH>::type> ramp_table;
+
+// 每个速度预设在共用表中的截断长度（Divisor为1：每全步间隔；为2：半步间隔）
+template<uint8_t Divisor, typename Seq> struct ramp_table_lengths;
+template<uint8_t Divisor, size_t... I> struct ramp_table_lengths<Divisor, stepper_ct_index_seq<I...> > {
+    static const uint8_t values[sizeof...(I)] PROGMEM;
+};
+template<uint8_t Divisor, size_t... I>
+const uint8_t ramp_table_lengths<Divisor, stepper_ct_index_seq<I...> >::values[sizeof...(I)] PROGMEM = {
+    stepper_ct_ramp_length_for(RAMP_TABLE_ACCELERATION, ramp_table_presets[I] * STEPPER_TICKS_PER_MS / Divisor)...
+};
+
+typedef ramp_table_lengths<1, stepper_ct_make_index_seq<MOTOR_SPEED_PRESET_COUNT>::type> preset_lengths;
+typedef ramp_table_lengths<2, stepper_ct_make_index_seq<MOTOR_SPEED_PRESET_COUNT>::type> preset_half_lengths;
+
+static_assert(RAMP_TABLE_LENGTH > 0, "fastest motor speed preset must need a ramp at the default acceleration");
+static_assert(RAMP_TABLE_LENGTH < 255, "ramp table must reach the fastest half-step preset delay");
+
+/**
+ * 查找速度预设对应的加速表
+ * @param acceleration 当前加速度，只有默认加速度有编译期表
+ * @param cruise_delay 巡航间隔（tick），必须正好等于某个速度预设或其一半（半步/自动模式）
+ * @param table 输出：Flash中的加速表首地址
+ * @return 需要查表的加速步数，0表示没有可用的表（走运行时计算或无需加速）
+ */
+uint8_t stepper_ramp_table_lookup(uint16_t acceleration, uint16_t cruise_delay, const uint16_t** table) {
+    if (acceleration != RAMP_TABLE_ACCELERATION) {
+        return 0;
+    }
+
+    for (uint8_t i = 0; i < MOTOR_SPEED_PRESET_COUNT; i++) {
+        uint16_t preset_delay = config_get_motor_speed_preset(i) * STEPPER_TICKS_PER_MS;
+        if (cruise_delay == preset_delay) {
+            *table = ramp_table::values;
+            return pgm_read_byte(&preset_lengths::values[i]);
+        }
+        if (cruise_delay == preset_delay / 2) {
+            *table = ramp_table::values;
+            return pgm_read_byte(&preset_half_lengths::values[i]);
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * 加速表占用的Flash字节数（表本身加每个预设的全步/半步长度）
+ */
+uint16_t stepper_ramp_table_flash_bytes() {
+    return sizeof(ramp_table::values) + sizeof(preset_lengths::values) + sizeof(preset_half_lengths::values);
+}
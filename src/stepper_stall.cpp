@@ -0,0 +1,184 @@
+#include <util/atomic.h>
+#include "stepper_stall.h"
+
+// 检测器状态（ADC中断写入，主循环在ATOMIC_BLOCK内复位）
+static stepper_stall_detector_t detector;
+
+// 是否启用检测
+static volatile bool stall_enabled = false;
+
+// 主循环正在用analogRead()读取其他通道，暂停采样
+static volatile bool adc_locked = false;
+
+// 检测到异常后待主循环处理的事件
+static volatile bool stall_event = false;
+
+// 本次采样的线圈组合分类
+static volatile uint8_t sample_class = 0;
+
+/**
+ * 复位检测器，重新学习基线
+ */
+void stepper_stall_detector_reset(stepper_stall_detector_t* d) {
+    for (uint8_t i = 0; i < STEPPER_STALL_CLASSES; i++) {
+        d->baseline_q4[i] = 0;
+        d->learned[i] = 0;
+    }
+    d->anomalies = 0;
+    d->stalled = false;
+}
+
+/**
+ * 输入一个电流样本
+ * 前STEPPER_STALL_LEARN_SAMPLES个样本取平均作为基线；之后偏离基线超过阈值的样本计为异常，
+ * 正常样本以1/64的速度跟踪基线（电压和温度缓慢变化）。连续异常达到阈值即判定堵转，直到复位
+ * @param pattern_class 线圈组合分类（0 ~ STEPPER_STALL_CLASSES-1）
+ * @param sample ADC值（0 ~ 1023）
+ * @return 是否已判定堵转
+ */
+bool stepper_stall_detector_feed(stepper_stall_detector_t* d, uint8_t pattern_class, uint16_t sample) {
+    if (d->stalled) {
+        return true;
+    }
+    if (pattern_class >= STEPPER_STALL_CLASSES) {
+        pattern_class = STEPPER_STALL_CLASSES - 1;
+    }
+
+    int32_t value = (int32_t)sample << 4;
+    int32_t baseline = d->baseline_q4[pattern_class];
+
+    // 学习阶段：累积平均
+    if (d->learned[pattern_class] < STEPPER_STALL_LEARN_SAMPLES) {
+        d->learned[pattern_class]++;
+        d->baseline_q4[pattern_class] = (uint16_t)(baseline + (value - baseline) / d->learned[pattern_class]);
+        return false;
+    }
+
+    int32_t deviation = value - baseline;
+    if (deviation < 0) deviation = -deviation;
+
+    if (deviation * 100 > baseline * STEPPER_STALL_THRESHOLD_PCT) {
+        if (++d->anomalies >= STEPPER_STALL_CONSECUTIVE) {
+            d->stalled = true;
+        }
+    } else {
+        d->anomalies = 0;
+        d->baseline_q4[pattern_class] = (uint16_t)(baseline + ((value - baseline) >> STEPPER_STALL_TRACK_SHIFT));
+    }
+    return d->stalled;
+}
+
+/**
+ * 初始化电流采样输入
+ */
+void stepper_stall_init() {
+    pinMode(CURRENT_SENSE_PIN, INPUT);
+    stepper_stall_detector_reset(&detector);
+}
+
+/**
+ * 启用/关闭堵转检测（未安装采样电阻时不要启用）
+ */
+void stepper_stall_enable(bool enable) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        stall_enabled = enable;
+        stall_event = false;
+        stepper_stall_detector_reset(&detector);
+    }
+}
+
+/**
+ * 检查是否启用堵转检测
+ */
+bool stepper_stall_is_enabled() {
+    return stall_enabled;
+}
+
+/**
+ * 运动开始或巡航速度改变时重新学习基线
+ */
+void stepper_stall_begin_move() {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        stepper_stall_detector_reset(&detector);
+    }
+}
+
+/**
+ * 安排本步的电流采样（Timer1中断内调用，只在巡航阶段调用）
+ * Timer1在比较匹配A时清零，比较B在清零后STEPPER_STALL_SAMPLE_TICKS触发，即每步后的固定时刻
+ * @param pattern_class 本步输出的线圈组合分类
+ * @param next_delay 到下一步的间隔，太短时不采样
+ */
+void stepper_stall_arm(uint8_t pattern_class, uint16_t next_delay) {
+    if (!stall_enabled || adc_locked || detector.stalled || next_delay < STEPPER_STALL_MIN_INTERVAL_TICKS) {
+        return;
+    }
+
+    sample_class = pattern_class;
+    OCR1B = STEPPER_STALL_SAMPLE_TICKS;
+    TIFR1 = (1 << OCF1B);
+    TIMSK1 |= (1 << OCIE1B);
+}
+
+/**
+ * 取走待处理的堵转事件（主循环调用）
+ */
+bool stepper_stall_take_event() {
+    bool event;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        event = stall_event;
+        stall_event = false;
+    }
+    return event;
+}
+
+/**
+ * 主循环占用ADC：暂停采样并等待进行中的转换结束
+ */
+void stepper_stall_adc_lock() {
+    adc_locked = true;
+    while (ADCSRA & (1 << ADSC)) {
+    }
+    // 转换结束的ADC中断（若有）在这里已执行完，之后不会再启用ADIE
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        ADCSRA &= ~(1 << ADIE);
+    }
+}
+
+/**
+ * 主循环释放ADC
+ */
+void stepper_stall_adc_unlock() {
+    adc_locked = false;
+}
+
+/**
+ * Timer1比较匹配B中断：步进后固定时刻启动电流采样
+ */
+ISR(TIMER1_COMPB_vect) {
+    TIMSK1 &= ~(1 << OCIE1B);   // 每步只采样一次
+
+    if (adc_locked || (ADCSRA & (1 << ADSC))) {
+        return;
+    }
+
+    ADMUX = (ADMUX & 0xF0) | CURRENT_SENSE_ADC_CHANNEL;
+    ADCSRA |= (1 << ADSC) | (1 << ADIE);
+}
+
+/**
+ * ADC转换完成中断：把电流样本交给检测器
+ */
+ISR(ADC_vect) {
+    ADCSRA &= ~(1 << ADIE);
+
+    uint16_t sample = ADC;
+    if (adc_locked || !stall_enabled) {
+        return;
+    }
+
+    bool was_stalled = detector.stalled;
+    if (stepper_stall_detector_feed(&detector, sample_class, sample) && !was_stalled) {
+        stall_event = true;
+    }
+}
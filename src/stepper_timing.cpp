@@ -0,0 +1,163 @@
+#include "stepper_timing.h"
+
+#ifdef STEPPER_TIMING_STATS
+
+#include <util/atomic.h>
+#include "stepper_motor.h"
+
+// 统计数据（由Timer1中断写入，主循环在ATOMIC_BLOCK内读取）
+static volatile stepper_timing_stats_t stats;
+
+// 上一步的超时，用于推算实际步距；运动开始时清零
+static volatile uint16_t last_overrun = 0;
+
+// 当前主循环分段
+static volatile uint8_t current_section = TIMING_SECTION_IDLE;
+
+/**
+ * 对数桶号：0 tick为第0桶，其余为二进制位数
+ */
+static uint8_t timing_bucket(uint16_t ticks) {
+    uint8_t bucket = 0;
+    while (ticks > 0 && bucket < STEPPER_TIMING_BUCKETS - 1) {
+        ticks >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+/**
+ * 运动从静止开始（启动定时器时调用），第一步没有上一步可比
+ */
+void stepper_timing_begin_move() {
+    last_overrun = 0;
+}
+
+/**
+ * 记录一步（Timer1中断内调用）
+ * @param overrun 中断入口处的TCNT1，即本步比预定时刻晚的tick数
+ * @param scheduled 本步的预定间隔（tick）
+ */
+void stepper_timing_record(uint16_t overrun, uint16_t scheduled) {
+    uint16_t interval = scheduled + overrun - last_overrun;
+    last_overrun = overrun;
+
+    if (stats.samples == 0xFFFFFFFFUL) {
+        return;
+    }
+    stats.samples++;
+    stats.overrun_sum += overrun;
+
+    uint8_t bucket = timing_bucket(interval);
+    if (stats.interval_histogram[bucket] < 0xFFFF) stats.interval_histogram[bucket]++;
+    bucket = timing_bucket(overrun);
+    if (stats.overrun_histogram[bucket] < 0xFFFF) stats.overrun_histogram[bucket]++;
+
+    if (overrun > stats.worst_overrun) stats.worst_overrun = overrun;
+    if (overrun > stats.section_worst[current_section]) stats.section_worst[current_section] = overrun;
+}
+
+/**
+ * 标记主循环当前运行的分段
+ */
+void stepper_timing_set_section(uint8_t section) {
+    if (section < STEPPER_TIMING_SECTIONS) {
+        current_section = section;
+    }
+}
+
+/**
+ * 读取统计数据快照
+ */
+void stepper_timing_get(stepper_timing_stats_t* out) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        for (uint8_t i = 0; i < STEPPER_TIMING_BUCKETS; i++) {
+            out->interval_histogram[i] = stats.interval_histogram[i];
+            out->overrun_histogram[i] = stats.overrun_histogram[i];
+        }
+        for (uint8_t i = 0; i < STEPPER_TIMING_SECTIONS; i++) {
+            out->section_worst[i] = stats.section_worst[i];
+        }
+        out->worst_overrun = stats.worst_overrun;
+        out->overrun_sum = stats.overrun_sum;
+        out->samples = stats.samples;
+    }
+}
+
+/**
+ * 清空统计数据
+ */
+void stepper_timing_reset() {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        for (uint8_t i = 0; i < STEPPER_TIMING_BUCKETS; i++) {
+            stats.interval_histogram[i] = 0;
+            stats.overrun_histogram[i] = 0;
+        }
+        for (uint8_t i = 0; i < STEPPER_TIMING_SECTIONS; i++) {
+            stats.section_worst[i] = 0;
+        }
+        stats.worst_overrun = 0;
+        stats.overrun_sum = 0;
+        stats.samples = 0;
+    }
+}
+
+/**
+ * 打印一个对数直方图：每行为桶的tick下限和计数
+ */
+static void timing_print_histogram(const uint16_t* histogram) {
+    for (uint8_t i = 0; i < STEPPER_TIMING_BUCKETS; i++) {
+        if (histogram[i] == 0) continue;
+        Serial.print(F("  >="));
+        Serial.print(i == 0 ? 0U : (1U << (i - 1)));
+        Serial.print(F(" ticks: "));
+        Serial.println(histogram[i]);
+    }
+}
+
+/**
+ * 通过串口输出统计数据（tick为4μs）
+ */
+void stepper_timing_dump() {
+    stepper_timing_stats_t snapshot;
+    stepper_timing_get(&snapshot);
+
+    Serial.println(F("=== Stepper Timing ==="));
+    Serial.print(F("Steps: "));
+    Serial.println(snapshot.samples);
+    Serial.print(F("Worst overrun (ticks): "));
+    Serial.println(snapshot.worst_overrun);
+    Serial.print(F("Mean overrun (ticks x100): "));
+    Serial.println(snapshot.samples > 0 ? snapshot.overrun_sum * 100 / snapshot.samples : 0);
+
+    Serial.println(F("Interval histogram:"));
+    timing_print_histogram(snapshot.interval_histogram);
+    Serial.println(F("Overrun histogram:"));
+    timing_print_histogram(snapshot.overrun_histogram);
+
+    Serial.println(F("Worst overrun by loop section:"));
+    for (uint8_t i = 0; i < STEPPER_TIMING_SECTIONS; i++) {
+        Serial.print(F("  section "));
+        Serial.print(i);
+        Serial.print(F(": "));
+        Serial.println(snapshot.section_worst[i]);
+    }
+    Serial.println(F("======================"));
+}
+
+/**
+ * 串口命令：'t'输出统计，'r'清空统计（在主循环中调用）
+ */
+void stepper_timing_poll_serial() {
+    while (Serial.available() > 0) {
+        int command = Serial.read();
+        if (command == 't') {
+            stepper_timing_dump();
+        } else if (command == 'r') {
+            stepper_timing_reset();
+            Serial.println(F("Stepper timing reset"));
+        }
+    }
+}
+
+#endif // STEPPER_TIMING_STATS
@@ -7,9 +7,8 @@ extern float battery_voltage;
 // UI状态变量
 static ui_state_t ui_state;
 
-// 电机速度预设值数组
-static const uint8_t motor_speed_values[] = {2, 4, 6, 8, 10, 15, 30, 60, 100};
-static const uint8_t motor_speed_count = sizeof(motor_speed_values) / sizeof(motor_speed_values[0]);
+// 电机速度预设个数（预设值在Flash中，用config_get_motor_speed_preset()读取）
+static const uint8_t motor_speed_count = MOTOR_SPEED_PRESET_COUNT;
 
 /**
  * 初始化UI显示系统
@@ -276,7 +275,7 @@ void ui_draw_photo_running(uint8_t current_photo, uint8_t total_photos,
 /**
  * 绘制3D扫描运行界面
  */
-void ui_draw_scan_running(float turns, unsigned long elapsed_seconds) {
+void ui_draw_scan_running(uint32_t turns, uint8_t hundredths, unsigned long elapsed_seconds) {
     display.setTextSize(1);
     display.setTextColor(SSD1306_WHITE);
 
@@ -285,7 +284,10 @@ void ui_draw_scan_running(float turns, unsigned long elapsed_seconds) {
     // 显示旋转圈数
     display.setCursor(0, y);
     display.print(F("Scan: "));
-    display.print(turns, 2);  // 保留2位小数
+    display.print(turns);     // 整数圈数和百分位分开打印，不经过浮点，圈数再大也精确
+    display.print(F("."));
+    if (hundredths < 10) display.print(F("0"));
+    display.print(hundredths);
     display.print(F(" turns"));
 
     // 显示运行时间
@@ -389,13 +391,13 @@ void ui_config_exit_edit(void) {
  */
 static uint8_t find_motor_speed_index(uint8_t speed) {
     for (uint8_t i = 0; i < motor_speed_count; i++) {
-        if (motor_speed_values[i] == speed) {
+        if (config_get_motor_speed_preset(i) == speed) {
             return i;
         }
     }
     // 如果没找到，返回最接近的值的索引
     for (uint8_t i = 0; i < motor_speed_count - 1; i++) {
-        if (speed < motor_speed_values[i + 1]) {
+        if (speed < config_get_motor_speed_preset(i + 1)) {
             return i;
         }
     }
@@ -421,7 +423,22 @@ void ui_config_increase_value(void) {
                 uint8_t current_index = find_motor_speed_index(current_speed);
                 // 循环到下一个速度值，到最后一个时回到第一个
                 uint8_t next_index = (current_index + 1) % motor_speed_count;
-                config_set_motor_speed(motor_speed_values[next_index]);
+                config_set_motor_speed(config_get_motor_speed_preset(next_index));
+            }
+            break;
+        case CONFIG_ITEM_MOTION_PROFILE:
+            // 循环切换：梯形 -> S曲线 -> 梯形
+            if (config_get_motion_profile() == MOTION_PROFILE_TRAPEZOID) {
+                config_set_motion_profile(MOTION_PROFILE_SCURVE);
+            } else {
+                config_set_motion_profile(MOTION_PROFILE_TRAPEZOID);
+            }
+            break;
+        case CONFIG_ITEM_BACKLASH:
+            {
+                // 循环增加：0 -> 2 -> ... -> 32 -> 0
+                uint8_t current = config_get_backlash_steps();
+                config_set_backlash_steps(current >= BACKLASH_STEPS_MAX ? BACKLASH_STEPS_MIN : current + BACKLASH_STEPS_STEP);
             }
             break;
         case CONFIG_ITEM_ROTATION_ANGLE:
@@ -468,7 +485,22 @@ void ui_config_decrease_value(void) {
                 uint8_t current_index = find_motor_speed_index(current_speed);
                 // 循环到上一个速度值，到第一个时回到最后一个
                 uint8_t prev_index = (current_index + motor_speed_count - 1) % motor_speed_count;
-                config_set_motor_speed(motor_speed_values[prev_index]);
+                config_set_motor_speed(config_get_motor_speed_preset(prev_index));
+            }
+            break;
+        case CONFIG_ITEM_MOTION_PROFILE:
+            // 循环切换：S曲线 -> 梯形 -> S曲线
+            if (config_get_motion_profile() == MOTION_PROFILE_SCURVE) {
+                config_set_motion_profile(MOTION_PROFILE_TRAPEZOID);
+            } else {
+                config_set_motion_profile(MOTION_PROFILE_SCURVE);
+            }
+            break;
+        case CONFIG_ITEM_BACKLASH:
+            {
+                // 循环减少：32 -> 30 -> ... -> 0 -> 32
+                uint8_t current = config_get_backlash_steps();
+                config_set_backlash_steps(current <= BACKLASH_STEPS_MIN ? BACKLASH_STEPS_MAX : current - BACKLASH_STEPS_STEP);
             }
             break;
         case CONFIG_ITEM_ROTATION_ANGLE:
@@ -503,6 +535,8 @@ const char* ui_get_config_item_name(config_item_t item) {
     switch (item) {
         case CONFIG_ITEM_MOTOR_DIRECTION: return "Motor Dir";
         case CONFIG_ITEM_MOTOR_SPEED: return "Motor Speed";
+        case CONFIG_ITEM_MOTION_PROFILE: return "Profile";
+        case CONFIG_ITEM_BACKLASH: return "Backlash";
         case CONFIG_ITEM_ROTATION_ANGLE: return "Rotation";
         case CONFIG_ITEM_PHOTO_INTERVAL: return "Photo Int";
         default: return "Unknown";
@@ -521,6 +555,13 @@ void ui_print_config_item_value(config_item_t item) {
             display.print(config_get_motor_speed());
             display.print(F(" ms"));
             break;
+        case CONFIG_ITEM_MOTION_PROFILE:
+            display.print(config_get_motion_profile_string());
+            break;
+        case CONFIG_ITEM_BACKLASH:
+            display.print(config_get_backlash_steps());
+            display.print(F(" steps"));
+            break;
         case CONFIG_ITEM_ROTATION_ANGLE:
             display.print(config_get_rotation_angle_string());
             break;
@@ -4,6 +4,8 @@
 #include <Wire.h>
 #include "voltage.h"
 #include "camera.h"
+#include "stepper_motor.h"
+#include "stepper_stall.h"
 
 // 外部显示对象声明
 extern Adafruit_SSD1306 display;
@@ -19,8 +21,10 @@ void voltage_sensor_init() {
 
 // 读取电池电压函数
 float read_battery_voltage() {
-  // 读取ADC值 (0-1023)
+  // 读取ADC值 (0-1023)，期间暂停步进同步的电流采样
+  stepper_stall_adc_lock();
   int adc_value = analogRead(VOLTAGE_SENSOR_PIN);
+  stepper_stall_adc_unlock();
 
   // 计算实际电压
   // ADC参考电压为5V，10位ADC (0-1023)
@@ -46,5 +50,8 @@ void update_voltage_reading() {
   if (current_time - last_voltage_check >= 500) {
     battery_voltage = read_battery_voltage();
     last_voltage_check = current_time;
+
+    // 按供电电压限制步进速度和加速度
+    stepper_motor_set_supply_voltage((uint16_t)(battery_voltage * 1000.0));
   }
 }
\ No newline at end of file
@@ -0,0 +1,142 @@
+#ifndef NATIVE_ARDUINO_STUB_H
+#define NATIVE_ARDUINO_STUB_H
+
+// 主机测试用的Arduino/AVR替身：寄存器是普通变量，中断向量是普通函数，
+// 测试直接调用TIMER1_COMPA_vect()等函数模拟中断，由stub_millis_value推进时间
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+#ifndef F_CPU
+#define F_CPU 16000000UL
+#endif
+
+#define PROGMEM
+#define pgm_read_byte(address) (*(const uint8_t*)(address))
+
+// Flash字读取次数（查表开销基准用）
+inline uint32_t stub_pgm_word_reads = 0;
+#define pgm_read_word(address) (stub_pgm_word_reads++, *(const uint16_t*)(address))
+
+#define LOW     0
+#define HIGH    1
+#define INPUT   0
+#define OUTPUT  1
+#define INPUT_PULLUP 2
+
+// 端口位号
+#define PB0 0
+#define PB1 1
+#define PB2 2
+#define PB3 3
+#define PB4 4
+#define PB5 5
+#define PC0 0
+#define PC1 1
+#define PC2 2
+#define PC3 3
+#define PC4 4
+#define PC5 5
+#define PD2 2
+#define PD3 3
+#define PD4 4
+#define PD5 5
+#define PE0 0
+#define PE1 1
+#define PE2 2
+#define PE3 3
+#define PE4 4
+#define PE5 5
+
+// 寄存器位号
+#define WGM12   3
+#define CS10    0
+#define CS11    1
+#define WGM32   3
+#define CS30    0
+#define OCIE1A  1
+#define OCIE1B  2
+#define OCF1A   1
+#define OCF1B   2
+#define OCIE3A  1
+#define OCF3A   1
+#define ADSC    6
+#define ADIE    3
+
+// 寄存器
+inline volatile uint8_t MCUSR;
+inline volatile uint8_t PORTB;
+inline volatile uint8_t DDRB;
+inline volatile uint8_t PORTE;
+inline volatile uint8_t DDRE;
+inline volatile uint8_t TCCR1A;
+inline volatile uint8_t TCCR1B;
+inline volatile uint8_t TIMSK1;
+inline volatile uint8_t TIFR1;
+inline volatile uint16_t TCNT1;
+inline volatile uint16_t OCR1A;
+inline volatile uint16_t OCR1B;
+inline volatile uint8_t TCCR3A;
+inline volatile uint8_t TCCR3B;
+inline volatile uint8_t TIMSK3;
+inline volatile uint8_t TIFR3;
+inline volatile uint16_t TCNT3;
+inline volatile uint16_t OCR3A;
+inline volatile uint8_t ADCSRA;
+inline volatile uint8_t ADMUX;
+inline volatile uint16_t ADC;
+inline volatile uint8_t PCICR;
+inline volatile uint8_t PCMSK2;
+
+// 中断向量
+#define ISR(vector) extern "C" void vector(void)
+extern "C" void TIMER1_COMPA_vect(void);
+extern "C" void TIMER1_COMPB_vect(void);
+extern "C" void TIMER3_COMPA_vect(void);
+extern "C" void ADC_vect(void);
+extern "C" void PCINT2_vect(void);
+
+// 时间（由测试推进）
+inline unsigned long stub_millis_value = 0;
+inline unsigned long millis() { return stub_millis_value; }
+inline unsigned long micros() { return stub_millis_value * 1000UL; }
+inline void delay(unsigned long ms) { stub_millis_value += ms; }
+inline void delayMicroseconds(unsigned int us) { (void)us; }
+
+// 引脚（由测试设置电平）
+inline int stub_pin_level[32];
+inline void pinMode(uint8_t pin, uint8_t mode) { (void)pin; (void)mode; }
+inline int digitalRead(uint8_t pin) { return stub_pin_level[pin & 31]; }
+inline void digitalWrite(uint8_t pin, uint8_t value) { stub_pin_level[pin & 31] = value; }
+inline int analogRead(uint8_t pin) { (void)pin; return 0; }
+
+// 串口：输出追加到stub_serial_output，输入从stub_serial_input依次读出
+#define F(string_literal) (string_literal)
+
+inline std::string stub_serial_output;
+inline std::string stub_serial_input;
+
+class StubSerial {
+public:
+    int available() { return (int)stub_serial_input.size(); }
+    int read() {
+        if (stub_serial_input.empty()) return -1;
+        int c = (unsigned char)stub_serial_input[0];
+        stub_serial_input.erase(0, 1);
+        return c;
+    }
+    void print(const char* text) { stub_serial_output += text; }
+    void print(unsigned long value) { stub_serial_output += std::to_string(value); }
+    void print(unsigned int value) { print((unsigned long)value); }
+    void print(int value) { stub_serial_output += std::to_string(value); }
+    template <typename T> void println(T value) { print(value); stub_serial_output += "\r\n"; }
+};
+inline StubSerial Serial;
+
+#define digitalPinToPCMSK(pin)      (&PCMSK2)
+#define digitalPinToPCMSKbit(pin)   ((pin) & 7)
+#define digitalPinToPCICRbit(pin)   2
+
+#endif // NATIVE_ARDUINO_STUB_H
@@ -0,0 +1,22 @@
+#ifndef NATIVE_EEPROM_STUB_H
+#define NATIVE_EEPROM_STUB_H
+
+#include <Arduino.h>
+
+// 主机测试用的EEPROM替身：1KB内存数组
+struct EEPROMClass {
+    uint8_t data[1024];
+
+    template<typename T> T& get(int address, T& value) {
+        memcpy(&value, &data[address], sizeof(T));
+        return value;
+    }
+    template<typename T> const T& put(int address, const T& value) {
+        memcpy(&data[address], &value, sizeof(T));
+        return value;
+    }
+};
+
+inline EEPROMClass EEPROM;
+
+#endif // NATIVE_EEPROM_STUB_H
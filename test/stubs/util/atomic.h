@@ -0,0 +1,9 @@
+#ifndef NATIVE_ATOMIC_STUB_H
+#define NATIVE_ATOMIC_STUB_H
+
+// 主机测试单线程执行，中断由测试显式调用，ATOMIC_BLOCK只需执行一次块内语句
+#define ATOMIC_RESTORESTATE 0
+#define ATOMIC_FORCEON      0
+#define ATOMIC_BLOCK(type)  for (int atomic_once_ = 1; atomic_once_; atomic_once_ = 0)
+
+#endif // NATIVE_ATOMIC_STUB_H
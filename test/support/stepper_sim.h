@@ -0,0 +1,63 @@
+#ifndef STEPPER_SIM_H
+#define STEPPER_SIM_H
+
+// 主机测试用的Timer1模拟：虚拟时钟以定时器tick计，每次比较匹配推进OCR1A+1个tick后调用中断，
+// 主循环（stepper_motor_update）由测试按需调用，不调用即相当于主循环被阻塞
+
+#include <Arduino.h>
+#include "stepper_motor.h"
+
+inline uint64_t sim_ticks = 0;
+
+// 定时器是否在运行（比较匹配中断已开启且时钟已启动）
+inline bool sim_timer_running() {
+    return (TIMSK1 & (1 << OCIE1A)) && (TCCR1B & ((1 << CS11) | (1 << CS10)));
+}
+
+// 同步毫秒计数
+inline void sim_sync_millis() {
+    stub_millis_value = (unsigned long)(sim_ticks / STEPPER_TICKS_PER_MS);
+}
+
+// 推进虚拟时钟（不触发中断），用于模拟主循环空转的时间
+inline void sim_advance_ms(unsigned long ms) {
+    sim_ticks += (uint64_t)ms * STEPPER_TICKS_PER_MS;
+    sim_sync_millis();
+}
+
+// 触发一次比较匹配中断，latency为中断被关中断区段推迟的tick数
+// @return 本次比较匹配的间隔（tick）
+inline uint16_t sim_fire(uint16_t latency = 0) {
+    uint16_t interval = OCR1A + 1;
+    sim_ticks += interval;
+    sim_sync_millis();
+    TCNT1 = latency;
+    TIMER1_COMPA_vect();
+    TCNT1 = 0;
+    return interval;
+}
+
+// 一直触发中断直到定时器停止，返回触发次数（超过limit次视为不会停止）
+inline uint32_t sim_run_to_stop(uint32_t limit = 1000000UL) {
+    uint32_t count = 0;
+    while (sim_timer_running() && count < limit) {
+        sim_fire();
+        count++;
+    }
+    return count;
+}
+
+// 复位模拟器和电机，每个测试开始时调用
+// 预励磁锁定单独占一次不走步的中断，按中断次数数步的测试默认关闭，需要时由测试自行设置
+inline void sim_reset() {
+    sim_ticks = 0;
+    stub_millis_value = 0;
+    TIMSK1 = 0;
+    TCCR1B = 0;
+    OCR1A = 0;
+    stepper_motor_init();
+    stepper_motor_set_lock_in(0);
+    stepper_motor_set_event_callback(nullptr);
+}
+
+#endif // STEPPER_SIM_H
@@ -0,0 +1,125 @@
+#include <unity.h>
+#include "stepper_sim.h"
+
+// 多轴联动：Bresenham插补的终点必须精确，旋转轴步数与插补节拍数分开统计
+
+void setUp(void) {
+    sim_reset();
+    stepper_motor_set_step_mode(STEP_MODE_FULL);
+    stepper_motor_set_custom_speed(2);
+    stepper_motor_set_position(0);
+    stepper_axis_set_position(STEPPER_AXIS_TILT, 0);
+}
+
+void tearDown(void) {
+    stepper_motor_halt();
+}
+
+static void run_axes(int rotation, int tilt) {
+    int steps[STEPPER_AXIS_COUNT] = {rotation, tilt};
+    stepper_motor_move_axes(steps);
+    sim_run_to_stop();
+    TEST_ASSERT_FALSE(stepper_motor_is_running());
+}
+
+// 各种步数组合（含互质、一轴为0、方向相反）走完后两轴都恰好到达终点
+void test_endpoint_exact(void) {
+    static const int pairs[][2] = {
+        {1000, 1}, {1, 1000}, {997, 331}, {512, 512}, {-700, 301},
+        {250, -999}, {0, 123}, {123, 0}, {-37, -1000}
+    };
+    int32_t rotation = 0;
+    int32_t tilt = 0;
+
+    for (uint8_t i = 0; i < sizeof(pairs) / sizeof(pairs[0]); i++) {
+        run_axes(pairs[i][0], pairs[i][1]);
+        rotation += pairs[i][0];
+        tilt += pairs[i][1];
+        TEST_ASSERT_EQUAL_INT32(rotation, stepper_motor_get_position());
+        TEST_ASSERT_EQUAL_INT32(tilt, stepper_axis_get_position(STEPPER_AXIS_TILT));
+    }
+}
+
+// 插补节拍数取步数最多的轴：总节拍数等于较大步数
+void test_event_count_is_major_axis(void) {
+    int steps[STEPPER_AXIS_COUNT] = {300, -800};
+    stepper_motor_move_axes(steps);
+    TEST_ASSERT_EQUAL_UINT32(800, sim_run_to_stop());
+}
+
+// 旋转轴是次轴时，已走步数报告的是旋转轴步数而不是插补节拍数
+void test_rotation_steps_reported(void) {
+    int steps[STEPPER_AXIS_COUNT] = {200, 1000};
+    stepper_motor_move_axes(steps);
+
+    for (uint16_t i = 0; i < 500; i++) {
+        sim_fire();
+    }
+    TEST_ASSERT_TRUE(stepper_motor_is_running());
+    uint32_t done = stepper_motor_get_current_rotation_steps();
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)stepper_motor_get_position(), done);
+    TEST_ASSERT_UINT32_WITHIN(1, 100, done);
+
+    sim_run_to_stop();
+    TEST_ASSERT_EQUAL_UINT32(200, stepper_motor_get_current_rotation_steps());
+}
+
+// 俯仰轴按自己的实例输出到PB2-PB5：半步序列逐拍前进，联动结束后只断开辅助轴
+void test_tilt_instance_drives_its_own_port(void) {
+    const uint8_t tilt_mask = 0x0F << TILT_MOTOR_INT1_PIN;
+    int steps[STEPPER_AXIS_COUNT] = {0, 3};
+    stepper_motor_move_axes(steps);
+
+    for (uint8_t i = 1; i <= 2; i++) {
+        sim_fire();
+        TEST_ASSERT_EQUAL_UINT8(stepper_sequence_half::pattern(i) << TILT_MOTOR_INT1_PIN, PORTB & tilt_mask);
+    }
+    sim_fire();
+    TEST_ASSERT_FALSE(stepper_motor_is_running());
+    TEST_ASSERT_EQUAL_UINT8(0, PORTB & tilt_mask);
+    TEST_ASSERT_EQUAL_INT32(3, stepper_axis_get_position(STEPPER_AXIS_TILT));
+
+    stepper_axis_write(STEPPER_AXIS_TILT, 0x05);
+    TEST_ASSERT_EQUAL_UINT8(0x05 << TILT_MOTOR_INT1_PIN, PORTB & tilt_mask);
+    stepper_axis_release(STEPPER_AXIS_TILT);
+    TEST_ASSERT_EQUAL_UINT8(0, PORTB & tilt_mask);
+}
+
+// 俯仰轴切换全步：每步输出双线圈组合，全步位置k与半步位置2k+1互相换算
+void test_tilt_full_step_mode(void) {
+    const uint8_t tilt_mask = 0x0F << TILT_MOTOR_INT1_PIN;
+
+    // 停在半步位置0（单线圈），切换时先对齐到半步位置1，即全步位置0
+    stepper_axis_set_step_mode(STEPPER_AXIS_TILT, STEP_MODE_FULL);
+    TEST_ASSERT_EQUAL_UINT8(STEP_MODE_FULL, stepper_axis_get_step_mode(STEPPER_AXIS_TILT));
+    TEST_ASSERT_EQUAL_INT32(0, stepper_axis_get_position(STEPPER_AXIS_TILT));
+
+    int steps[STEPPER_AXIS_COUNT] = {0, -5};
+    stepper_motor_move_axes(steps);
+    for (uint8_t i = 0; i < 4; i++) {
+        sim_fire();
+        uint8_t pattern = (PORTB & tilt_mask) >> TILT_MOTOR_INT1_PIN;
+        TEST_ASSERT_TRUE(pattern == 0x03 || pattern == 0x06 || pattern == 0x0C || pattern == 0x09);
+    }
+    sim_run_to_stop();
+    TEST_ASSERT_EQUAL_INT32(-5, stepper_axis_get_position(STEPPER_AXIS_TILT));
+
+    stepper_axis_set_step_mode(STEPPER_AXIS_TILT, STEP_MODE_HALF);
+    TEST_ASSERT_EQUAL_INT32(-9, stepper_axis_get_position(STEPPER_AXIS_TILT));
+    stepper_axis_set_step_mode(STEPPER_AXIS_TILT, STEP_MODE_FULL);
+    TEST_ASSERT_EQUAL_INT32(-5, stepper_axis_get_position(STEPPER_AXIS_TILT));
+
+    // 旋转轴不受辅助轴步进模式影响
+    stepper_axis_set_step_mode(STEPPER_AXIS_ROTATION, STEP_MODE_HALF);
+    TEST_ASSERT_EQUAL_UINT8(STEP_MODE_FULL, stepper_axis_get_step_mode(STEPPER_AXIS_ROTATION));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_endpoint_exact);
+    RUN_TEST(test_event_count_is_major_axis);
+    RUN_TEST(test_rotation_steps_reported);
+    RUN_TEST(test_tilt_instance_drives_its_own_port);
+    RUN_TEST(test_tilt_full_step_mode);
+    return UNITY_END();
+}
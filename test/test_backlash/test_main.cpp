@@ -0,0 +1,107 @@
+#include <unity.h>
+#include "stepper_sim.h"
+
+// 齿轮间隙补偿：上电后第一次运动不补偿；换向时先空转backlash×每全步步数，同方向重复运动不再空转；
+// 空转不计入绝对位置，空转中的停止命令等空转完成后才停止
+
+#define BACKLASH_FULL_STEPS  5
+
+void setUp(void) {
+    sim_reset();
+    stepper_motor_set_step_mode(STEP_MODE_HALF);
+    stepper_motor_set_custom_speed(4);
+    stepper_motor_set_backlash(BACKLASH_FULL_STEPS);
+}
+
+void tearDown(void) {
+    stepper_motor_halt();
+    stepper_motor_set_backlash(0);
+}
+
+// 走完一次运动，返回中断次数（计数步加空转步）
+static uint32_t run_move(motor_direction_t direction, int32_t steps) {
+    stepper_motor_set_direction(direction);
+    stepper_motor_rotate_steps(steps);
+    return sim_run_to_stop();
+}
+
+// 上电后间隙状态未知：第一次运动（无论方向）不空转
+void test_no_takeup_on_first_move_after_power_up(void) {
+    TEST_ASSERT_EQUAL_UINT32(40, run_move(COUNTER_CLOCKWISE, 40));
+    TEST_ASSERT_EQUAL_INT32(-40, stepper_motor_get_position());
+
+    // 重新上电后同样不补偿
+    sim_reset();
+    stepper_motor_set_step_mode(STEP_MODE_HALF);
+    stepper_motor_set_backlash(BACKLASH_FULL_STEPS);
+    TEST_ASSERT_EQUAL_UINT32(40, run_move(CLOCKWISE, 40));
+}
+
+// 换向时空转backlash×每全步步数（半步模式为2），同方向重复运动不再空转
+void test_takeup_on_reversal_only(void) {
+    const uint32_t takeup = BACKLASH_FULL_STEPS * 2;
+
+    TEST_ASSERT_EQUAL_UINT32(40, run_move(CLOCKWISE, 40));
+    TEST_ASSERT_EQUAL_UINT32(40 + takeup, run_move(COUNTER_CLOCKWISE, 40));
+    TEST_ASSERT_EQUAL_UINT32(40, run_move(COUNTER_CLOCKWISE, 40));
+    TEST_ASSERT_EQUAL_UINT32(40 + takeup, run_move(CLOCKWISE, 40));
+    TEST_ASSERT_EQUAL_INT32(0, stepper_motor_get_position());
+
+    // 全步模式下空转步数等于间隙全步数
+    stepper_motor_set_step_mode(STEP_MODE_FULL);
+    TEST_ASSERT_EQUAL_UINT32(20 + BACKLASH_FULL_STEPS, run_move(COUNTER_CLOCKWISE, 20));
+}
+
+// 空转期间线圈序列前进，绝对位置不变；空转结束后才开始计数
+void test_position_unchanged_during_takeup(void) {
+    const uint32_t takeup = BACKLASH_FULL_STEPS * 2;
+    run_move(CLOCKWISE, 40);
+    int32_t start = stepper_motor_get_position();
+
+    stepper_motor_set_direction(COUNTER_CLOCKWISE);
+    stepper_motor_rotate_steps(40);
+    uint8_t pattern = PORTE;
+    for (uint32_t i = 0; i < takeup; i++) {
+        sim_fire();
+        TEST_ASSERT_EQUAL_INT32(start, stepper_motor_get_position());
+        TEST_ASSERT_NOT_EQUAL(pattern, PORTE);
+        pattern = PORTE;
+    }
+
+    sim_fire();
+    TEST_ASSERT_EQUAL_INT32(start - 1, stepper_motor_get_position());
+    sim_run_to_stop();
+    TEST_ASSERT_EQUAL_INT32(start - 40, stepper_motor_get_position());
+}
+
+// 空转中的停止命令不打断空转：空转完成后停止，不走计数步，之后同方向运动不再空转
+void test_stop_refused_during_takeup(void) {
+    const uint32_t takeup = BACKLASH_FULL_STEPS * 2;
+    run_move(CLOCKWISE, 40);
+    int32_t start = stepper_motor_get_position();
+
+    stepper_motor_set_direction(COUNTER_CLOCKWISE);
+    stepper_motor_rotate_steps(40);
+    sim_fire();
+    sim_fire();
+
+    stepper_motor_stop();
+    TEST_ASSERT_TRUE(stepper_motor_is_running());
+    TEST_ASSERT_TRUE(sim_timer_running());
+
+    TEST_ASSERT_EQUAL_UINT32(takeup - 2, sim_run_to_stop());
+    TEST_ASSERT_FALSE(stepper_motor_is_running());
+    TEST_ASSERT_EQUAL_INT32(start, stepper_motor_get_position());
+
+    TEST_ASSERT_EQUAL_UINT32(40, run_move(COUNTER_CLOCKWISE, 40));
+    TEST_ASSERT_EQUAL_INT32(start - 40, stepper_motor_get_position());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_no_takeup_on_first_move_after_power_up);
+    RUN_TEST(test_takeup_on_reversal_only);
+    RUN_TEST(test_position_unchanged_during_takeup);
+    RUN_TEST(test_stop_refused_during_takeup);
+    return UNITY_END();
+}
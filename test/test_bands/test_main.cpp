@@ -0,0 +1,111 @@
+#include <unity.h>
+#include "stepper_sim.h"
+
+// 共振禁区：巡航和加减速的步进间隔都不落在禁区内，步数不受影响
+
+void setUp(void) {
+    sim_reset();
+    stepper_motor_set_step_mode(STEP_MODE_FULL);
+    stepper_motor_set_custom_speed(2);      // 500全步/秒，500 tick
+}
+
+void tearDown(void) {
+    stepper_motor_set_resonance_band(0, 0, 0);
+    stepper_motor_set_resonance_band(1, 0, 0);
+    stepper_motor_set_supply_voltage(0);
+    stepper_motor_halt();
+}
+
+// 走完一次运动，检查每一步的间隔都不在[low, high]内，返回巡航段最后的间隔
+static uint16_t run_outside(int32_t steps, uint16_t low, uint16_t high) {
+    uint16_t interval = 0;
+    stepper_motor_rotate_steps(steps);
+    uint32_t count = 0;
+    while (sim_timer_running()) {
+        interval = sim_fire();
+        TEST_ASSERT_TRUE(interval < low || interval > high);
+        if (++count == (uint32_t)steps / 2) break;
+    }
+    uint16_t cruise = interval;
+    while (sim_timer_running()) {
+        interval = sim_fire();
+        TEST_ASSERT_TRUE(interval < low || interval > high);
+    }
+    TEST_ASSERT_EQUAL_INT32(steps, stepper_motor_get_position());
+    return cruise;
+}
+
+// 巡航速度落在禁区内：移到较近的边缘（450-550全步/秒，500离快侧更近）
+void test_cruise_moves_to_nearest_edge(void) {
+    stepper_motor_set_resonance_band(0, 450, 550);
+    uint16_t low = STEPPER_TIMER_FREQ / 550;
+    uint16_t high = STEPPER_TIMER_FREQ / 450;
+
+    uint16_t cruise = run_outside(1500, low, high);
+    TEST_ASSERT_EQUAL_UINT16(low - 1, cruise);
+}
+
+// 只在加减速中经过的禁区（200-300全步/秒）被跳过，巡航不变
+void test_ramp_skips_band(void) {
+    stepper_motor_set_resonance_band(1, 200, 300);
+    uint16_t cruise = run_outside(1500, STEPPER_TIMER_FREQ / 300, STEPPER_TIMER_FREQ / 200);
+    TEST_ASSERT_EQUAL_UINT16(STEPPER_US_TO_TICKS(2000), cruise);
+}
+
+// S曲线和非默认加速度（运行时计算）同样避开禁区
+void test_band_avoided_by_all_ramp_paths(void) {
+    stepper_motor_set_resonance_band(1, 200, 300);
+    uint16_t low = STEPPER_TIMER_FREQ / 300;
+    uint16_t high = STEPPER_TIMER_FREQ / 200;
+
+    stepper_motor_set_acceleration(3000);
+    run_outside(800, low, high);
+
+    stepper_motor_set_position(0);
+    stepper_motor_set_motion_profile(PROFILE_SCURVE);
+    run_outside(800, low, high);
+}
+
+// 非法禁区被忽略，关闭后恢复原巡航速度
+void test_invalid_and_disabled_band(void) {
+    stepper_motor_set_resonance_band(0, 550, 450);
+    stepper_motor_set_resonance_band(0, 0, 500);
+    TEST_ASSERT_EQUAL_UINT16(STEPPER_US_TO_TICKS(2000), run_outside(600, 1, 0));
+
+    stepper_motor_set_resonance_band(0, 450, 550);
+    stepper_motor_set_resonance_band(0, 0, 0);
+    stepper_motor_set_position(0);
+    TEST_ASSERT_EQUAL_UINT16(STEPPER_US_TO_TICKS(2000), run_outside(600, 1, 0));
+}
+
+// 禁区跨过电压限制的转速（4.3V限制250全步/秒，禁区240-255全步/秒）：
+// 快侧边缘更近但超过限制，巡航取慢侧边缘，任何一步都不快于限制
+void test_band_edge_respects_governor_limit(void) {
+    stepper_motor_set_supply_voltage(4300);
+    TEST_ASSERT_EQUAL_UINT16(250, stepper_motor_get_governor_limit());
+    stepper_motor_set_resonance_band(0, 240, 255);
+    uint16_t low = STEPPER_TIMER_FREQ / 255;
+    uint16_t high = STEPPER_TIMER_FREQ / 240;
+    uint16_t limit = STEPPER_TIMER_FREQ / 250;
+
+    stepper_motor_rotate_steps(600);
+    uint16_t cruise = 0;
+    while (sim_timer_running()) {
+        uint16_t interval = sim_fire();
+        TEST_ASSERT_TRUE(interval < low || interval > high);
+        TEST_ASSERT_GREATER_OR_EQUAL(limit, interval);
+        if (stepper_motor_get_position() == 300) cruise = interval;
+    }
+    TEST_ASSERT_EQUAL_UINT16(high + 1, cruise);
+    TEST_ASSERT_EQUAL_INT32(600, stepper_motor_get_position());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_cruise_moves_to_nearest_edge);
+    RUN_TEST(test_ramp_skips_band);
+    RUN_TEST(test_band_avoided_by_all_ramp_paths);
+    RUN_TEST(test_invalid_and_disabled_band);
+    RUN_TEST(test_band_edge_respects_governor_limit);
+    return UNITY_END();
+}
@@ -0,0 +1,144 @@
+#include <unity.h>
+#include "stepper_sim.h"
+
+// 运动事件：中断置位，主循环的stepper_motor_update()合并后调用一次回调
+
+static uint8_t calls = 0;
+static uint8_t last_events = 0;
+static uint8_t chained = 0;
+
+static void on_event(uint8_t events) {
+    calls++;
+    last_events = events;
+}
+
+// 在回调中直接发起下一次运动
+static void on_event_chain(uint8_t events) {
+    on_event(events);
+    if ((events & STEPPER_EVENT_MOVE_DONE) && chained < 3) {
+        chained++;
+        stepper_motor_rotate_steps(100);
+    }
+}
+
+void setUp(void) {
+    sim_reset();
+    stepper_motor_set_step_mode(STEP_MODE_FULL);
+    stepper_motor_set_custom_speed(2);
+    calls = 0;
+    last_events = 0;
+    chained = 0;
+}
+
+void tearDown(void) {
+    stepper_motor_halt();
+    stepper_motor_set_event_callback(nullptr);
+}
+
+// 计数运动结束前没有MOVE_DONE，结束后下一次主循环收到且只收到一次
+void test_move_done_once(void) {
+    stepper_motor_set_event_callback(on_event);
+    stepper_motor_rotate_steps(20);
+    for (uint8_t i = 0; i < 10; i++) {
+        sim_fire();
+    }
+    stepper_motor_update();
+    TEST_ASSERT_EQUAL_UINT8(0, last_events & STEPPER_EVENT_MOVE_DONE);
+
+    sim_run_to_stop();
+    stepper_motor_update();
+    TEST_ASSERT_EQUAL_UINT8(STEPPER_EVENT_MOVE_DONE, last_events & STEPPER_EVENT_MOVE_DONE);
+
+    uint8_t before = calls;
+    stepper_motor_update();
+    TEST_ASSERT_EQUAL_UINT8(before, calls);
+}
+
+// 两次主循环之间的进入巡航和运动结束合并为一次回调
+void test_events_merged_between_updates(void) {
+    stepper_motor_set_event_callback(on_event);
+    stepper_motor_rotate_steps(2000);
+    sim_run_to_stop();
+    stepper_motor_update();
+
+    TEST_ASSERT_EQUAL_UINT8(1, calls);
+    TEST_ASSERT_EQUAL_UINT8(STEPPER_EVENT_CRUISE | STEPPER_EVENT_MOVE_DONE, last_events);
+}
+
+// 减速停止完成时产生MOVE_DONE，急停不产生
+void test_stop_reports_halt_does_not(void) {
+    stepper_motor_set_event_callback(on_event);
+    stepper_motor_start();
+    for (uint16_t i = 0; i < 500; i++) {
+        sim_fire();
+    }
+    stepper_motor_update();
+    stepper_motor_stop();
+    sim_run_to_stop();
+    stepper_motor_update();
+    TEST_ASSERT_EQUAL_UINT8(STEPPER_EVENT_MOVE_DONE, last_events & STEPPER_EVENT_MOVE_DONE);
+
+    calls = 0;
+    stepper_motor_start();
+    for (uint16_t i = 0; i < 500; i++) {
+        sim_fire();
+    }
+    stepper_motor_update();
+    last_events = 0;
+    stepper_motor_halt();
+    stepper_motor_update();
+    TEST_ASSERT_EQUAL_UINT8(0, last_events & STEPPER_EVENT_MOVE_DONE);
+}
+
+// 新的运动开始时丢弃上一次运动未取走的结束事件
+void test_new_move_discards_stale_done(void) {
+    stepper_motor_set_event_callback(on_event);
+    stepper_motor_rotate_steps(10);
+    sim_run_to_stop();
+
+    stepper_motor_rotate_steps(10);
+    stepper_motor_update();
+    TEST_ASSERT_EQUAL_UINT8(0, last_events & STEPPER_EVENT_MOVE_DONE);
+
+    sim_run_to_stop();
+    stepper_motor_update();
+    TEST_ASSERT_EQUAL_UINT8(STEPPER_EVENT_MOVE_DONE, last_events & STEPPER_EVENT_MOVE_DONE);
+}
+
+// 回调中可以直接发起下一次运动
+void test_callback_chains_moves(void) {
+    stepper_motor_set_event_callback(on_event_chain);
+    stepper_motor_rotate_steps(100);
+
+    for (uint8_t i = 0; i < 10; i++) {
+        sim_run_to_stop();
+        stepper_motor_update();
+    }
+    TEST_ASSERT_EQUAL_UINT8(3, chained);
+    TEST_ASSERT_EQUAL_UINT8(4, calls);
+    TEST_ASSERT_EQUAL_INT32(400, stepper_motor_get_position());
+}
+
+// 注销回调后事件被丢弃，重新注册不会收到旧事件
+void test_unregistered_callback_drops_events(void) {
+    stepper_motor_set_event_callback(on_event);
+    stepper_motor_set_event_callback(nullptr);
+    stepper_motor_rotate_steps(50);
+    sim_run_to_stop();
+    stepper_motor_update();
+
+    stepper_motor_set_event_callback(on_event);
+    stepper_motor_update();
+    TEST_ASSERT_EQUAL_UINT8(0, calls);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_move_done_once);
+    RUN_TEST(test_events_merged_between_updates);
+    RUN_TEST(test_stop_reports_halt_does_not);
+    RUN_TEST(test_new_move_discards_stale_done);
+    RUN_TEST(test_callback_chains_moves);
+    RUN_TEST(test_unregistered_callback_drops_events);
+    return UNITY_END();
+}
@@ -0,0 +1,126 @@
+#include <unity.h>
+#include "stepper_sim.h"
+#include "stepper_gear.h"
+
+// 精确减速比：多圈累计后步数与角度、圈数的换算仍与精确分数一致
+
+// 几种每转步数：全步、半步、16细分加60:20皮带、任意齿数比
+static stepper_gear_ratio_t ratios[4];
+
+// 精确值 numer/denom 四舍五入（denom > 0）
+static int64_t round_div(int64_t numer, int64_t denom) {
+    return (numer >= 0 ? numer + denom / 2 : numer - denom / 2) / denom;
+}
+
+void setUp(void) {
+    sim_reset();
+    stepper_motor_set_step_mode(STEP_MODE_FULL);
+    stepper_motor_set_custom_speed(2);
+    stepper_gear_make_ratio(&ratios[0], 1, 1, 1);
+    stepper_gear_make_ratio(&ratios[1], 2, 1, 1);
+    stepper_gear_make_ratio(&ratios[2], 16, 60, 20);
+    stepper_gear_make_ratio(&ratios[3], 4, 157, 13);
+}
+
+void tearDown(void) {
+    stepper_motor_halt();
+}
+
+// 约分后的每转步数
+void test_ratio_is_reduced(void) {
+    TEST_ASSERT_EQUAL_UINT32(825344, ratios[0].num);
+    TEST_ASSERT_EQUAL_UINT32(405, ratios[0].den);
+    TEST_ASSERT_EQUAL_UINT32(2038, stepper_gear_steps_per_revolution(&ratios[0]));
+    TEST_ASSERT_EQUAL_UINT32(4076, stepper_gear_steps_per_revolution(&ratios[1]));
+}
+
+// 拍照分度：每次转同一个角度，同一个carry连续换算1000圈，每一次的累计步数都等于精确值四舍五入
+void test_degree_steps_exact_over_many_turns(void) {
+    static const uint16_t increments[] = {1, 7, 10, 45};
+
+    for (uint8_t r = 0; r < 4; r++) {
+        for (uint8_t k = 0; k < sizeof(increments) / sizeof(increments[0]); k++) {
+            uint32_t carry = stepper_gear_carry_init(&ratios[r]);
+            int64_t total_steps = 0;
+            int64_t total_degrees = 0;
+            int64_t scale = 360LL * ratios[r].den;
+
+            // 转到整圈为止（7°要转7的倍数圈才回到0°）
+            while (total_degrees < 360LL * 1000 || total_degrees % 360 != 0) {
+                total_steps += stepper_gear_degrees_to_steps(&ratios[r], increments[k], &carry);
+                total_degrees += increments[k];
+                if (total_steps != round_div(total_degrees * ratios[r].num, scale)) {
+                    TEST_ASSERT_EQUAL_INT32((int32_t)round_div(total_degrees * ratios[r].num, scale), (int32_t)total_steps);
+                }
+            }
+            // N整圈正好是N×num/den步（四舍五入）
+            int64_t turns = total_degrees / 360;
+            TEST_ASSERT_EQUAL_INT32((int32_t)round_div(turns * ratios[r].num, ratios[r].den), (int32_t)total_steps);
+        }
+    }
+}
+
+// 第k圈的角度位置与圈数互为反函数，正负圈数都不漂移
+void test_angle_position_round_trip(void) {
+    for (uint8_t r = 0; r < 3; r++) {
+        for (int32_t turn = -500; turn <= 500; turn += 7) {
+            for (uint16_t degrees = 0; degrees < 360; degrees += 30) {
+                int32_t position = stepper_gear_angle_position(&ratios[r], turn, degrees);
+                int64_t exact = round_div(((int64_t)turn * 360 + degrees) * ratios[r].num, 360LL * ratios[r].den);
+                TEST_ASSERT_EQUAL_INT32((int32_t)exact, position);
+
+                // 四舍五入最多偏半步，0°可能落在上一圈的末尾
+                uint32_t fraction;
+                int32_t revolution = stepper_gear_revolution_of(&ratios[r], position, &fraction);
+                if (degrees == 0 && revolution == turn - 1) {
+                    TEST_ASSERT_GREATER_OR_EQUAL(ratios[r].num - ratios[r].den / 2, fraction);
+                } else {
+                    TEST_ASSERT_EQUAL_INT32(turn, revolution);
+                }
+            }
+        }
+    }
+}
+
+// 累计转动量：分成不规则的小段累加N圈的步数，圈数和圈内偏移与一次性计算完全相同
+void test_travel_exact_over_many_turns(void) {
+    for (uint8_t r = 0; r < 4; r++) {
+        stepper_gear_travel_t travel = {0, 0};
+        uint64_t total = 0;
+        uint32_t chunk = 1;
+
+        while (total < 5000ULL * ratios[r].num / ratios[r].den) {
+            stepper_gear_travel_add(&ratios[r], &travel, chunk);
+            total += chunk;
+            chunk = chunk * 7 % 9973 + 1;
+        }
+
+        uint64_t scaled = total * ratios[r].den;
+        TEST_ASSERT_EQUAL_UINT32((uint32_t)(scaled / ratios[r].num), travel.turns);
+        TEST_ASSERT_EQUAL_UINT32((uint32_t)(scaled % ratios[r].num), travel.offset);
+    }
+}
+
+// 电机按10°分度转10圈（与拍照模式相同的carry用法），最终位置是10圈的精确步数
+void test_motor_indexing_returns_exactly(void) {
+    stepper_gear_ratio_t ratio;
+    stepper_motor_get_gear_ratio(&ratio);
+    uint32_t carry = stepper_gear_carry_init(&ratio);
+
+    for (uint16_t i = 0; i < 36 * 10; i++) {
+        stepper_motor_rotate_steps(stepper_gear_degrees_to_steps(&ratio, 10, &carry));
+        sim_run_to_stop();
+    }
+    TEST_ASSERT_EQUAL_INT32((int32_t)round_div(10LL * ratio.num, ratio.den), stepper_motor_get_position());
+    TEST_ASSERT_EQUAL_INT32(10, stepper_gear_revolution_of(&ratio, stepper_motor_get_position() + 1, nullptr));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_ratio_is_reduced);
+    RUN_TEST(test_degree_steps_exact_over_many_turns);
+    RUN_TEST(test_angle_position_round_trip);
+    RUN_TEST(test_travel_exact_over_many_turns);
+    RUN_TEST(test_motor_indexing_returns_exactly);
+    return UNITY_END();
+}
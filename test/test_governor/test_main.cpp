@@ -0,0 +1,95 @@
+#include <unity.h>
+#include "stepper_sim.h"
+#include "stepper_ramp.h"
+
+// 电压调速：低电压时限制巡航速度，运行中的运动（含查表模式）立即降速
+
+void setUp(void) {
+    sim_reset();
+    stepper_motor_set_step_mode(STEP_MODE_FULL);
+    stepper_motor_set_custom_speed(2);
+}
+
+void tearDown(void) {
+    stepper_motor_halt();
+    stepper_motor_set_supply_voltage(0);
+}
+
+// 曲线端点之间线性插值，低于最低点取最低点，未接电压检测不限制
+void test_limit_interpolation(void) {
+    stepper_motor_set_supply_voltage(0);
+    TEST_ASSERT_EQUAL_UINT16(0, stepper_motor_get_governor_limit());
+    stepper_motor_set_supply_voltage(3000);
+    TEST_ASSERT_EQUAL_UINT16(250, stepper_motor_get_governor_limit());
+    stepper_motor_set_supply_voltage(4500);
+    TEST_ASSERT_EQUAL_UINT16(315, stepper_motor_get_governor_limit());
+    stepper_motor_set_supply_voltage(6000);
+    TEST_ASSERT_EQUAL_UINT16(600, stepper_motor_get_governor_limit());
+}
+
+// 连续转动中电压跌落：巡航间隔从500 tick（500全步/秒）降到1000 tick（250全步/秒）
+void test_continuous_rotation_slows(void) {
+    stepper_motor_start();
+    for (uint16_t i = 0; i < 1000; i++) {
+        sim_fire();
+    }
+    TEST_ASSERT_EQUAL_UINT16(STEPPER_US_TO_TICKS(2000), sim_fire());
+
+    stepper_motor_set_supply_voltage(4300);
+    sim_fire();
+    for (uint16_t i = 0; i < 100; i++) {
+        TEST_ASSERT_EQUAL_UINT16(STEPPER_US_TO_TICKS(4000), sim_fire());
+    }
+}
+
+// 计数运动（默认加速度，查表模式）巡航中电压跌落：立即降速，减速段从新速度开始单调减速，终点不变
+void test_counted_table_move_slows(void) {
+    stepper_motor_rotate_steps(3000);
+    for (uint16_t i = 0; i < 1000; i++) {
+        sim_fire();
+    }
+    TEST_ASSERT_EQUAL_UINT16(STEPPER_US_TO_TICKS(2000), sim_fire());
+
+    stepper_motor_set_supply_voltage(4300);
+    sim_fire();
+    uint32_t steps = 1002;
+    uint16_t previous = sim_fire();
+    steps++;
+    TEST_ASSERT_EQUAL_UINT16(STEPPER_US_TO_TICKS(4000), previous);
+    while (sim_timer_running()) {
+        uint16_t interval = sim_fire();
+        TEST_ASSERT_GREATER_OR_EQUAL(previous, interval);
+        previous = interval;
+        steps++;
+    }
+    TEST_ASSERT_EQUAL_UINT32(3000, steps);
+    TEST_ASSERT_EQUAL_INT32(3000, stepper_motor_get_position());
+}
+
+// 加速曲线层：只有巡航速度真正改变时才返回true（堵转检测据此重新学习基线）
+void test_set_cruise_reports_change(void) {
+    stepper_ramp_t ramp = {};
+    stepper_ramp_set_acceleration(&ramp, STEPPER_DEFAULT_ACCELERATION);
+    stepper_ramp_set_profile(&ramp, PROFILE_TRAPEZOID);
+
+    uint16_t delay = stepper_ramp_plan(&ramp, 5000, 500);
+    while (ramp.phase != RAMP_RUN) {
+        delay = stepper_ramp_next_delay(&ramp);
+    }
+    TEST_ASSERT_EQUAL_UINT16(500, delay);
+
+    TEST_ASSERT_FALSE(stepper_ramp_set_cruise(&ramp, 500));
+    TEST_ASSERT_FALSE(stepper_ramp_set_cruise(&ramp, 400));    // 计数运动的提速在下次运动生效
+    TEST_ASSERT_TRUE(stepper_ramp_set_cruise(&ramp, 1000));
+    TEST_ASSERT_FALSE(stepper_ramp_set_cruise(&ramp, 1000));
+    TEST_ASSERT_EQUAL_UINT16(1000, stepper_ramp_next_delay(&ramp));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_limit_interpolation);
+    RUN_TEST(test_continuous_rotation_slows);
+    RUN_TEST(test_counted_table_move_slows);
+    RUN_TEST(test_set_cruise_reports_change);
+    return UNITY_END();
+}
@@ -0,0 +1,142 @@
+#include <unity.h>
+#include "stepper_sim.h"
+#include "stepper_microstep.h"
+
+// 减流保持：运动结束后以设定占空比保持最后的线圈组合，超时或下一次运动时结束
+
+void setUp(void) {
+    sim_reset();
+    stepper_microstep_init();
+    stepper_motor_set_step_mode(STEP_MODE_FULL);
+    stepper_motor_set_custom_speed(2);
+}
+
+void tearDown(void) {
+    stepper_motor_set_hold(0, 0);
+    stepper_motor_halt();
+}
+
+static void move(int32_t steps) {
+    stepper_motor_rotate_steps(steps);
+    sim_run_to_stop();
+}
+
+// 未设置保持时运动结束直接断电
+void test_no_hold_releases_coils(void) {
+    move(10);
+    TEST_ASSERT_FALSE(stepper_motor_is_holding());
+    for (uint8_t coil = 0; coil < 4; coil++) {
+        TEST_ASSERT_EQUAL_UINT8(0, stepper_microstep_get_duty(coil));
+    }
+}
+
+// 25%保持：最后一步的两个线圈以8/32占空比通电，其余线圈断电
+void test_hold_keeps_last_pattern_at_reduced_duty(void) {
+    stepper_motor_set_hold(25, 0);
+    move(10);
+    TEST_ASSERT_TRUE(stepper_motor_is_holding());
+
+    uint8_t energised = 0;
+    for (uint8_t coil = 0; coil < 4; coil++) {
+        uint8_t duty = stepper_microstep_get_duty(coil);
+        TEST_ASSERT_TRUE(duty == 0 || duty == 8);
+        if (duty > 0) energised++;
+    }
+    TEST_ASSERT_EQUAL_UINT8(2, energised);
+}
+
+// 超时后由主循环释放
+void test_hold_times_out(void) {
+    stepper_motor_set_hold(25, 500);
+    move(10);
+    TEST_ASSERT_TRUE(stepper_motor_is_holding());
+
+    sim_advance_ms(499);
+    stepper_motor_update();
+    TEST_ASSERT_TRUE(stepper_motor_is_holding());
+
+    sim_advance_ms(1);
+    stepper_motor_update();
+    TEST_ASSERT_FALSE(stepper_motor_is_holding());
+    TEST_ASSERT_FALSE(TIMSK3 & (1 << OCIE3A));
+}
+
+// 下一次运动开始时结束保持，全步模式下PWM停止，线圈由步进中断直接驱动
+void test_next_move_ends_hold(void) {
+    stepper_motor_set_hold(25, 0);
+    move(10);
+    TEST_ASSERT_TRUE(TIMSK3 & (1 << OCIE3A));
+
+    stepper_motor_rotate_steps(10);
+    TEST_ASSERT_FALSE(stepper_motor_is_holding());
+    TEST_ASSERT_FALSE(TIMSK3 & (1 << OCIE3A));
+    sim_run_to_stop();
+    TEST_ASSERT_TRUE(stepper_motor_is_holding());
+}
+
+// 静止时可以直接进入保持（例如第一张照片前锁定原点），release()断开线圈
+void test_hold_and_release_while_stopped(void) {
+    stepper_motor_hold();
+    TEST_ASSERT_FALSE(stepper_motor_is_holding());
+
+    stepper_motor_set_hold(50, 0);
+    stepper_motor_hold();
+    TEST_ASSERT_TRUE(stepper_motor_is_holding());
+
+    stepper_motor_release();
+    TEST_ASSERT_FALSE(stepper_motor_is_holding());
+    for (uint8_t coil = 0; coil < 4; coil++) {
+        TEST_ASSERT_EQUAL_UINT8(0, stepper_microstep_get_duty(coil));
+    }
+}
+
+// 断电后的运动先以满电流输出断电前最后的相位，锁定期间不走步，锁定结束后从该相位走下一步
+void test_move_from_released_starts_at_latched_phase(void) {
+    const uint8_t coil_mask = 0x0F << STEP_MOTOR_INT1_PIN;
+    stepper_motor_set_lock_in(STEPPER_LOCK_IN_MS);
+
+    move(3);
+    TEST_ASSERT_EQUAL_UINT8(0, PORTE & coil_mask);
+    uint8_t latched = stepper_sequence_full::pattern(3) << STEP_MOTOR_INT1_PIN;
+
+    stepper_motor_rotate_steps(2);
+    TEST_ASSERT_EQUAL_UINT8(latched, PORTE & coil_mask);
+
+    TEST_ASSERT_EQUAL_UINT16(STEPPER_LOCK_IN_MS * STEPPER_TICKS_PER_MS, sim_fire());
+    TEST_ASSERT_EQUAL_INT32(3, stepper_motor_get_position());
+    TEST_ASSERT_EQUAL_UINT8(latched, PORTE & coil_mask);
+
+    sim_fire();
+    TEST_ASSERT_EQUAL_INT32(4, stepper_motor_get_position());
+    TEST_ASSERT_EQUAL_UINT8(stepper_sequence_full::pattern(0) << STEP_MOTOR_INT1_PIN, PORTE & coil_mask);
+    sim_run_to_stop();
+    TEST_ASSERT_EQUAL_INT32(5, stepper_motor_get_position());
+}
+
+// 最长锁定时间加上慢速的第一步间隔超过16位比较寄存器：两段分开计时，锁定时间不被截断
+void test_long_lock_in_not_cut_short(void) {
+    stepper_motor_set_lock_in(STEPPER_LOCK_IN_MAX_MS);
+    stepper_motor_set_custom_speed(100);    // 匀速运行，第一步间隔25000 tick
+
+    stepper_motor_rotate_steps(2);
+    TEST_ASSERT_EQUAL_UINT16(STEPPER_LOCK_IN_MAX_MS * STEPPER_TICKS_PER_MS, sim_fire());
+    TEST_ASSERT_EQUAL_INT32(0, stepper_motor_get_position());
+    TEST_ASSERT_EQUAL_UINT16(STEPPER_US_TO_TICKS(100000), sim_fire());
+    TEST_ASSERT_EQUAL_INT32(1, stepper_motor_get_position());
+
+    TEST_ASSERT_EQUAL_UINT32(1, sim_run_to_stop());
+    TEST_ASSERT_EQUAL_INT32(2, stepper_motor_get_position());
+    stepper_motor_set_lock_in(STEPPER_LOCK_IN_MS);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_no_hold_releases_coils);
+    RUN_TEST(test_hold_keeps_last_pattern_at_reduced_duty);
+    RUN_TEST(test_hold_times_out);
+    RUN_TEST(test_next_move_ends_hold);
+    RUN_TEST(test_hold_and_release_while_stopped);
+    RUN_TEST(test_move_from_released_starts_at_latched_phase);
+    RUN_TEST(test_long_lock_in_not_cut_short);
+    return UNITY_END();
+}
@@ -0,0 +1,213 @@
+#include <unity.h>
+#include "stepper_sim.h"
+#include "stepper_home.h"
+
+// 原点/索引传感器：模拟转台上的磁铁经过传感器，检查归零边沿、索引误差回绕和跟踪修正
+// 转台的实际位置（physical）与电机计数分开保存，丢步时只有计数前进
+
+static stepper_gear_ratio_t ratio;
+static int32_t physical = 0;
+static int32_t last_motor = 0;
+static bool magnet_installed = true;
+static uint32_t magnet_start = 700;     // 磁铁在圈内的起始位置（步）
+static uint32_t magnet_width = 40;      // 传感器触发范围（步）
+static uint32_t homing_steps = 0;       // 归零过程中发出的步数
+
+// 传感器是否处于触发范围（每转步数不是整数，按1/den步比较）
+static bool magnet_at(int32_t position) {
+    uint32_t fraction;
+    stepper_gear_revolution_of(&ratio, position, &fraction);
+    return magnet_installed && fraction >= magnet_start * ratio.den &&
+           fraction < (magnet_start + magnet_width) * ratio.den;
+}
+
+// 电平变化时触发引脚变化中断
+static void sense() {
+    int level = magnet_at(physical) ? HOME_SENSOR_ACTIVE_LEVEL : !HOME_SENSOR_ACTIVE_LEVEL;
+    if (stub_pin_level[HOME_SENSOR_PIN] != level) {
+        stub_pin_level[HOME_SENSOR_PIN] = level;
+        PCINT2_vect();
+    }
+}
+
+// 一次比较匹配中断；slip为true时转台没有跟着转（丢步）
+static void step(bool slip = false) {
+    sim_fire();
+    int32_t position = stepper_motor_get_position();
+    if (!slip) {
+        physical += position - last_motor;
+    }
+    last_motor = position;
+    sense();
+}
+
+// 一次主循环（归零可能重设绝对坐标，转台实际位置不变）
+static void main_loop() {
+    stepper_home_update();
+    stepper_motor_update();
+    last_motor = stepper_motor_get_position();
+}
+
+// 推进归零直到结束，每20步跑一次主循环
+static home_state_t run_homing(motor_direction_t direction) {
+    homing_steps = 0;
+    TEST_ASSERT_TRUE(stepper_home_start(direction));
+    last_motor = stepper_motor_get_position();
+
+    for (uint32_t i = 0; i < 200000UL && stepper_home_is_busy(); i++) {
+        if (sim_timer_running()) {
+            step();
+            homing_steps++;
+            if (i % 20 != 0) continue;
+        } else {
+            sim_advance_ms(1);
+        }
+        main_loop();
+    }
+    return stepper_home_get_state();
+}
+
+// 圈内位置（步，向下取整）
+static uint32_t physical_in_turn() {
+    uint32_t fraction;
+    stepper_gear_revolution_of(&ratio, physical, &fraction);
+    return fraction / ratio.den;
+}
+
+void setUp(void) {
+    sim_reset();
+    stepper_motor_set_step_mode(STEP_MODE_FULL);
+    stepper_motor_set_custom_speed(2);
+    stepper_motor_get_gear_ratio(&ratio);
+
+    physical = 0;
+    last_motor = 0;
+    magnet_installed = true;
+    magnet_start = 700;
+    magnet_width = 40;
+    stub_pin_level[HOME_SENSOR_PIN] = !HOME_SENSOR_ACTIVE_LEVEL;
+    stepper_home_init();
+    stepper_home_clear_reference();
+}
+
+void tearDown(void) {
+    stepper_home_cancel();
+    stepper_home_enable_tracking(false);
+    stepper_motor_halt();
+}
+
+// 顺时针归零：原点是顺时针慢速进入传感器的第一步
+void test_home_clockwise_edge(void) {
+    TEST_ASSERT_EQUAL(HOME_STATE_DONE, run_homing(CLOCKWISE));
+    TEST_ASSERT_EQUAL_INT32(0, stepper_motor_get_position());
+    TEST_ASSERT_EQUAL_UINT32(magnet_start, physical_in_turn());
+}
+
+// 逆时针归零：从另一侧进入，原点是传感器范围的最后一步
+void test_home_counter_clockwise_edge(void) {
+    physical = 1500;
+    TEST_ASSERT_EQUAL(HOME_STATE_DONE, run_homing(COUNTER_CLOCKWISE));
+    TEST_ASSERT_EQUAL_INT32(0, stepper_motor_get_position());
+    TEST_ASSERT_EQUAL_UINT32(magnet_start + magnet_width - 1, physical_in_turn());
+}
+
+// 起步时已停在传感器上：先退出再慢速逼近，结果与从外面开始相同
+void test_home_starting_on_sensor(void) {
+    physical = (int32_t)(magnet_start + magnet_width / 2);
+    sense();
+    TEST_ASSERT_EQUAL(HOME_STATE_DONE, run_homing(CLOCKWISE));
+    TEST_ASSERT_EQUAL_INT32(0, stepper_motor_get_position());
+    TEST_ASSERT_EQUAL_UINT32(magnet_start, physical_in_turn());
+}
+
+// 传感器触发范围比退出余量宽得多（约30°）：退出到释放为止，不会在传感器上开始慢速逼近而多转一圈
+void test_home_wide_sensor(void) {
+    magnet_width = 170;
+    physical = (int32_t)(magnet_start + magnet_width / 2);
+    sense();
+    TEST_ASSERT_EQUAL(HOME_STATE_DONE, run_homing(CLOCKWISE));
+    TEST_ASSERT_EQUAL_INT32(0, stepper_motor_get_position());
+    TEST_ASSERT_EQUAL_UINT32(magnet_start, physical_in_turn());
+    TEST_ASSERT_LESS_THAN(stepper_motor_get_steps_per_revolution() / 2, homing_steps);
+}
+
+// 传感器常触发（接线短路）：反向退出一圈多仍未释放，失败并停止
+void test_home_fails_when_sensor_stuck(void) {
+    magnet_start = 0;
+    magnet_width = 2038;
+    sense();
+    TEST_ASSERT_EQUAL(HOME_STATE_FAILED, run_homing(CLOCKWISE));
+    TEST_ASSERT_FALSE(stepper_motor_is_running());
+}
+
+// 没有索引：转过一圈多后失败并停止
+void test_home_fails_without_index(void) {
+    magnet_installed = false;
+    TEST_ASSERT_EQUAL(HOME_STATE_FAILED, run_homing(CLOCKWISE));
+    TEST_ASSERT_FALSE(stepper_motor_is_running());
+    TEST_ASSERT_LESS_THAN(stepper_motor_get_steps_per_revolution() * 3 / 2, (uint32_t)labs(physical));
+}
+
+// 索引误差：期望位置按精确分数取最近的整圈，正反方向、上千圈后都不漂移
+void test_index_error_wraparound(void) {
+    const int32_t reference = 700;
+    static const int32_t turns[] = {-1000, -3, -1, 0, 1, 5, 1000};
+    static const int32_t offsets[] = {-10, -1, 0, 1, 10};
+
+    for (uint8_t i = 0; i < sizeof(turns) / sizeof(turns[0]); i++) {
+        // k圈的精确位置四舍五入到整步
+        int64_t exact = (int64_t)turns[i] * ratio.num;
+        int64_t rounded = (exact >= 0 ? exact + ratio.den / 2 : exact - ratio.den / 2) / (int64_t)ratio.den;
+        for (uint8_t j = 0; j < sizeof(offsets) / sizeof(offsets[0]); j++) {
+            int32_t captured = reference + (int32_t)rounded + offsets[j];
+            TEST_ASSERT_EQUAL_INT32(offsets[j], stepper_home_index_error(captured, reference, &ratio));
+        }
+    }
+
+    // 半圈处换号：1018步在前半圈，1019步已更接近下一圈的索引
+    TEST_ASSERT_EQUAL_INT32(1018, stepper_home_index_error(reference + 1018, reference, &ratio));
+    TEST_ASSERT_EQUAL_INT32(-1019, stepper_home_index_error(reference + 1019, reference, &ratio));
+}
+
+// 跟踪：归零后连续转动，每圈丢3步，每次同方向经过索引都修正回来，丢步不累积
+void test_tracking_corrects_lost_steps(void) {
+    TEST_ASSERT_EQUAL(HOME_STATE_DONE, run_homing(CLOCKWISE));
+    int32_t offset = physical - stepper_motor_get_position();
+    stepper_home_enable_tracking(true);
+    uint16_t corrections = stepper_home_get_correction_count();
+
+    stepper_motor_set_direction(CLOCKWISE);
+    stepper_motor_start();
+    last_motor = stepper_motor_get_position();
+    for (uint32_t i = 0; i < 1000; i++) {
+        step();
+    }
+    // 每圈在经过索引之前丢步
+    for (uint8_t turn = 0; turn < 6; turn++) {
+        bool lossy = turn < 3;
+        for (uint32_t i = 0; i < 2038; i++) {
+            step(lossy && i >= 100 && i < 103);
+            if (i % 20 == 0) {
+                main_loop();
+            }
+        }
+        main_loop();
+        // 每转步数不是整数，传感器只能在整步上触发，边沿位置本身有不到1步的量化误差
+        TEST_ASSERT_INT_WITHIN(1, lossy ? 3 : 0, stepper_home_get_last_error());
+        TEST_ASSERT_INT_WITHIN(1, offset, physical - stepper_motor_get_position());
+    }
+    TEST_ASSERT_EQUAL_UINT16(corrections + 6, stepper_home_get_correction_count());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_home_clockwise_edge);
+    RUN_TEST(test_home_counter_clockwise_edge);
+    RUN_TEST(test_home_starting_on_sensor);
+    RUN_TEST(test_home_wide_sensor);
+    RUN_TEST(test_home_fails_when_sensor_stuck);
+    RUN_TEST(test_home_fails_without_index);
+    RUN_TEST(test_index_error_wraparound);
+    RUN_TEST(test_tracking_corrects_lost_steps);
+    return UNITY_END();
+}
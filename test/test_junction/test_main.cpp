@@ -0,0 +1,114 @@
+#include <unity.h>
+#include "stepper_sim.h"
+
+// 前瞻衔接：同向同曲线的相邻转动段以巡航速度通过段间，只在换向、停留或队列末尾减速
+
+void setUp(void) {
+    sim_reset();
+    stepper_motor_set_step_mode(STEP_MODE_FULL);
+    stepper_motor_set_custom_speed(2);
+}
+
+void tearDown(void) {
+    stepper_motor_halt();
+}
+
+// 运行到停止，返回用时（tick）
+static uint64_t run_timed() {
+    uint64_t start = sim_ticks;
+    sim_run_to_stop();
+    return sim_ticks - start;
+}
+
+// 4段300步连续排队与一次1200步运动用时相同（第一段已开始执行，后续段并入时从查表转为运行时计算，
+// 递推余数从0重新累积，误差在千分之二以内），段间间隔保持巡航
+void test_blended_segments_match_single_move(void) {
+    stepper_motor_rotate_steps(1200);
+    uint64_t single = run_timed();
+
+    sim_reset();
+    stepper_motor_set_step_mode(STEP_MODE_FULL);
+    stepper_motor_set_custom_speed(2);
+    for (uint8_t i = 0; i < 4; i++) {
+        TEST_ASSERT_TRUE(stepper_motor_queue_move(300, PROFILE_TRAPEZOID));
+    }
+
+    uint64_t start = sim_ticks;
+    uint32_t step = 0;
+    while (sim_timer_running()) {
+        uint16_t interval = sim_fire();
+        step++;
+        if (step == 300 || step == 600 || step == 900 || step == 301 || step == 601 || step == 901) {
+            TEST_ASSERT_EQUAL_UINT16(STEPPER_US_TO_TICKS(2000), interval);
+        }
+    }
+    TEST_ASSERT_UINT32_WITHIN(single / 500, single, sim_ticks - start);
+    TEST_ASSERT_EQUAL_INT32(1200, stepper_motor_get_position());
+}
+
+// 逐段停止再起步的对照：衔接后总用时明显更短
+void test_blending_beats_stop_start(void) {
+    uint64_t stop_start = 0;
+    for (uint8_t i = 0; i < 4; i++) {
+        stepper_motor_rotate_steps(300);
+        stop_start += run_timed();
+    }
+
+    sim_reset();
+    stepper_motor_set_step_mode(STEP_MODE_FULL);
+    stepper_motor_set_custom_speed(2);
+    for (uint8_t i = 0; i < 4; i++) {
+        stepper_motor_queue_move(300, PROFILE_TRAPEZOID);
+    }
+    uint64_t blended = run_timed();
+
+    TEST_ASSERT_TRUE(blended < stop_start);
+    TEST_ASSERT_EQUAL_INT32(1200, stepper_motor_get_position());
+}
+
+// 换向段打断衔接：反向之前先减速到起步速度附近
+void test_reversal_is_not_blended(void) {
+    stepper_motor_queue_move(300, PROFILE_TRAPEZOID);
+    stepper_motor_queue_direction(COUNTER_CLOCKWISE);
+    stepper_motor_queue_move(300, PROFILE_TRAPEZOID);
+
+    uint32_t step = 0;
+    uint16_t last_forward = 0;
+    while (sim_timer_running()) {
+        uint16_t interval = sim_fire();
+        if (++step == 300) last_forward = interval;
+    }
+    TEST_ASSERT_GREATER_THAN(STEPPER_US_TO_TICKS(2000) * 3, last_forward);
+    TEST_ASSERT_EQUAL_INT32(0, stepper_motor_get_position());
+}
+
+// 取消已衔接的段：按加速度减速停止，而不是在当前段末尾以巡航速度急停
+// （减速第一步取加速段最后一个间隔，可能比巡航间隔略短）
+void test_clear_blended_decelerates(void) {
+    for (uint8_t i = 0; i < 3; i++) {
+        stepper_motor_queue_move(300, PROFILE_TRAPEZOID);
+    }
+    for (uint16_t i = 0; i < 280; i++) {
+        sim_fire();
+    }
+    stepper_motor_queue_clear();
+
+    uint16_t previous = 0;
+    while (sim_timer_running()) {
+        uint16_t interval = sim_fire();
+        if (previous > 0) {
+            TEST_ASSERT_GREATER_OR_EQUAL(previous - previous / 50, interval);
+        }
+        previous = interval;
+    }
+    TEST_ASSERT_GREATER_THAN(300, stepper_motor_get_position());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_blended_segments_match_single_move);
+    RUN_TEST(test_blending_beats_stop_start);
+    RUN_TEST(test_reversal_is_not_blended);
+    RUN_TEST(test_clear_blended_decelerates);
+    return UNITY_END();
+}
@@ -0,0 +1,223 @@
+#include <unity.h>
+#include <stdio.h>
+#include "stepper_sim.h"
+#include "stepper_microstep.h"
+#include "stepper_axis.h"
+#include "stepper_ramp.h"
+
+// 正弦细分：两相电流的合成幅值近似恒定，整全步处与半步序列的线圈组合一致，软件PWM按占空比输出
+
+// 支持的细分数，电机层的测试逐一覆盖
+static const uint8_t resolutions[] = {4, 8, 16};
+#define RESOLUTION_COUNT  (sizeof(resolutions) / sizeof(resolutions[0]))
+
+// Timer1 tick与Timer3时隙折算为CPU时钟
+#define CLOCKS_PER_TIMER1_TICK  (F_CPU / STEPPER_TIMER_FREQ)
+#define CLOCKS_PER_PWM_SLOT     (F_CPU / STEPPER_PWM_SLOT_FREQ)
+
+void setUp(void) {
+    sim_reset();
+    stepper_microstep_init();
+}
+
+void tearDown(void) {
+    stepper_motor_halt();
+    stepper_microstep_release();
+}
+
+// 线圈输出引脚是否为高（coil为0-3，对应INT1-INT4）
+static bool coil_output(uint8_t coil) {
+    return PORTE & (1 << (STEP_MOTOR_INT1_PIN + coil));
+}
+
+// 当前占空比下 sin² + cos² 在满幅32²的±8%以内，同一相的正负两个线圈不会同时通电
+static void assert_current_vector(void) {
+    uint16_t sum = 0;
+    for (uint8_t coil = 0; coil < 4; coil++) {
+        uint8_t duty = stepper_microstep_get_duty(coil);
+        sum += (uint16_t)duty * duty;
+    }
+    TEST_ASSERT_UINT32_WITHIN(82, 1024, sum);
+    TEST_ASSERT_TRUE(stepper_microstep_get_duty(0) == 0 || stepper_microstep_get_duty(2) == 0);
+    TEST_ASSERT_TRUE(stepper_microstep_get_duty(1) == 0 || stepper_microstep_get_duty(3) == 0);
+}
+
+// 走一个PWM周期（32个时隙），每个线圈的通电时隙数等于其占空比
+static void assert_pwm_follows_duty(void) {
+    uint8_t on_slots[4] = {0, 0, 0, 0};
+    for (uint8_t slot = 0; slot < STEPPER_PWM_LEVELS; slot++) {
+        TIMER3_COMPA_vect();
+        for (uint8_t coil = 0; coil < 4; coil++) {
+            if (coil_output(coil)) on_slots[coil]++;
+        }
+    }
+    for (uint8_t coil = 0; coil < 4; coil++) {
+        TEST_ASSERT_EQUAL_UINT8(stepper_microstep_get_duty(coil), on_slots[coil]);
+    }
+}
+
+// 细分模式、满幅保持（停止后线圈电流保持在当前电角度）
+static void enter_micro_mode(uint8_t microsteps) {
+    stepper_motor_set_step_mode(STEP_MODE_MICRO);
+    stepper_motor_set_microsteps(microsteps);
+    stepper_motor_set_hold(100, 0);
+}
+
+// 每个电角度下 sin² + cos² 在满幅32²的±8%以内
+void test_phase_current_magnitude_is_constant(void) {
+    for (uint8_t phase = 0; phase < STEPPER_MICROSTEP_PHASES; phase++) {
+        stepper_microstep_set_phase(phase, STEPPER_PWM_LEVELS);
+        assert_current_vector();
+    }
+}
+
+// 整全步的电角度只有一个线圈满幅通电，依次为INT1、INT2、INT3、INT4（半步序列的偶数步）
+void test_full_step_phases_match_half_step_sequence(void) {
+    for (uint8_t step = 0; step < 4; step++) {
+        stepper_microstep_set_phase(step * STEPPER_MICROSTEP_PHASES_PER_FULL, STEPPER_PWM_LEVELS);
+        for (uint8_t coil = 0; coil < 4; coil++) {
+            TEST_ASSERT_EQUAL_UINT8((coil == step) ? STEPPER_PWM_LEVELS : 0, stepper_microstep_get_duty(coil));
+        }
+    }
+}
+
+// 降低幅值时各线圈按比例减小
+void test_reduced_amplitude_scales_duty(void) {
+    stepper_microstep_set_phase(8, STEPPER_PWM_LEVELS);
+    uint8_t full0 = stepper_microstep_get_duty(0);
+    uint8_t full1 = stepper_microstep_get_duty(1);
+
+    stepper_microstep_set_phase(8, STEPPER_PWM_LEVELS / 2);
+    TEST_ASSERT_EQUAL_UINT8(full0 / 2, stepper_microstep_get_duty(0));
+    TEST_ASSERT_EQUAL_UINT8(full1 / 2, stepper_microstep_get_duty(1));
+}
+
+// 一个PWM周期（32个时隙）内每个线圈的通电时隙数等于其占空比
+void test_pwm_slots_follow_duty(void) {
+    stepper_microstep_set_phase(5, STEPPER_PWM_LEVELS);
+    TEST_ASSERT_TRUE(TIMSK3 & (1 << OCIE3A));
+    assert_pwm_follows_duty();
+
+    stepper_microstep_release();
+    TEST_ASSERT_FALSE(TIMSK3 & (1 << OCIE3A));
+    TEST_ASSERT_EQUAL_UINT8(0, PORTE & stepper_rotation_coils::mask);
+}
+
+// 每种细分数下逐个微步走完一个电周期：每一步的电流矢量幅值恒定、与上一步不同，PWM输出与占空比一致
+void test_motor_microstep_duty_each_resolution(void) {
+    for (uint8_t r = 0; r < RESOLUTION_COUNT; r++) {
+        enter_micro_mode(resolutions[r]);
+
+        uint8_t previous[4];
+        for (uint8_t coil = 0; coil < 4; coil++) previous[coil] = stepper_microstep_get_duty(coil);
+
+        for (uint8_t k = 0; k < 4 * resolutions[r]; k++) {
+            stepper_motor_rotate_steps(1);
+            sim_run_to_stop();
+            assert_current_vector();
+            assert_pwm_follows_duty();
+
+            bool changed = false;
+            for (uint8_t coil = 0; coil < 4; coil++) {
+                if (stepper_microstep_get_duty(coil) != previous[coil]) changed = true;
+                previous[coil] = stepper_microstep_get_duty(coil);
+            }
+            TEST_ASSERT_TRUE(changed);
+        }
+    }
+}
+
+// 细分模式下走一个全步的微步数后，电角度前进16个相位单位，即通电线圈整体移到下一个线圈
+void test_motor_microsteps_advance_one_full_step(void) {
+    for (uint8_t r = 0; r < RESOLUTION_COUNT; r++) {
+        enter_micro_mode(resolutions[r]);
+        int32_t start = stepper_motor_get_position();
+
+        stepper_motor_rotate_steps(3);
+        sim_run_to_stop();
+        uint8_t before[4];
+        for (uint8_t coil = 0; coil < 4; coil++) before[coil] = stepper_microstep_get_duty(coil);
+        TEST_ASSERT_GREATER_THAN(0, before[0] + before[1] + before[2] + before[3]);
+
+        stepper_motor_rotate_steps(resolutions[r]);
+        sim_run_to_stop();
+        TEST_ASSERT_EQUAL_INT32(start + 3 + resolutions[r], stepper_motor_get_position());
+        for (uint8_t coil = 0; coil < 4; coil++) {
+            TEST_ASSERT_EQUAL_UINT8(before[(coil + 3) & 0x03], stepper_microstep_get_duty(coil));
+        }
+    }
+}
+
+// 中断负载模型：按CPU时钟交替触发Timer3时隙中断和Timer1步进中断，以最快速度预设运行，
+// 统计每个PWM时隙内的中断次数。每个时隙固定一次PWM中断，步进中断另加
+// 细分数×500全步/秒÷32kHz次（16细分时每4个时隙一次），任何时隙内最多一次步进中断，
+// 两个微步之间至少间隔64÷细分数-1个时隙
+void test_isr_load_per_pwm_slot_each_resolution(void) {
+    const uint8_t fastest_full_ms = 2;
+    const uint32_t full_sps = 1000UL / fastest_full_ms;
+
+    for (uint8_t r = 0; r < RESOLUTION_COUNT; r++) {
+        uint8_t microsteps = resolutions[r];
+        sim_reset();
+        stepper_microstep_init();
+        enter_micro_mode(microsteps);
+        stepper_motor_set_custom_speed(fastest_full_ms);
+        stepper_motor_set_acceleration(STEPPER_MAX_ACCELERATION);
+
+        stepper_motor_rotate_steps(1000L * microsteps);
+        TEST_ASSERT_TRUE(TIMSK3 & (1 << OCIE3A));
+
+        uint64_t next_slot_clock = sim_ticks * CLOCKS_PER_TIMER1_TICK + CLOCKS_PER_PWM_SLOT;
+        uint32_t slots = 0;
+        uint32_t steps = 0;
+        uint8_t steps_in_slot = 0;
+        uint8_t max_steps_in_slot = 0;
+        uint32_t slots_since_step = 0;
+        uint32_t min_slots_between_steps = 0xFFFFFFFFUL;
+        bool first_step = true;
+
+        while (sim_timer_running() && steps < 1000000UL) {
+            uint64_t next_step_clock = (sim_ticks + OCR1A + 1) * CLOCKS_PER_TIMER1_TICK;
+            if (next_slot_clock <= next_step_clock) {
+                TIMER3_COMPA_vect();
+                slots++;
+                slots_since_step++;
+                if (steps_in_slot > max_steps_in_slot) max_steps_in_slot = steps_in_slot;
+                steps_in_slot = 0;
+                next_slot_clock += CLOCKS_PER_PWM_SLOT;
+            } else {
+                sim_fire();
+                steps++;
+                steps_in_slot++;
+                if (!first_step && slots_since_step < min_slots_between_steps) {
+                    min_slots_between_steps = slots_since_step;
+                }
+                first_step = false;
+                slots_since_step = 0;
+            }
+        }
+
+        TEST_ASSERT_EQUAL_INT32(1000L * microsteps, stepper_motor_get_position());
+        TEST_ASSERT_LESS_OR_EQUAL(1, max_steps_in_slot);
+        TEST_ASSERT_GREATER_OR_EQUAL(64 / microsteps - 1, min_slots_between_steps);
+
+        // 平均每时隙的中断次数：1次PWM加步进中断，加速段更慢，不超过巡航时的比例
+        TEST_ASSERT_LESS_OR_EQUAL_UINT32(slots * microsteps * full_sps, (uint64_t)steps * STEPPER_PWM_SLOT_FREQ);
+        TEST_ASSERT_LESS_OR_EQUAL_UINT32(slots / 4, steps);
+        printf("  %2u microsteps: %lu slots, %lu step ISRs (%.3f per slot), min gap %lu slots\n",
+               microsteps, (unsigned long)slots, (unsigned long)steps, (double)steps / slots,
+               (unsigned long)min_slots_between_steps);
+    }
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_phase_current_magnitude_is_constant);
+    RUN_TEST(test_full_step_phases_match_half_step_sequence);
+    RUN_TEST(test_reduced_amplitude_scales_duty);
+    RUN_TEST(test_pwm_slots_follow_duty);
+    RUN_TEST(test_motor_microstep_duty_each_resolution);
+    RUN_TEST(test_motor_microsteps_advance_one_full_step);
+    RUN_TEST(test_isr_load_per_pwm_slot_each_resolution);
+    return UNITY_END();
+}
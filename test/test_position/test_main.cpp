@@ -0,0 +1,129 @@
+#include <unity.h>
+#include "stepper_sim.h"
+
+// 有符号绝对位置与最短路径转到指定角度
+
+void setUp(void) {
+    sim_reset();
+    stepper_motor_set_step_mode(STEP_MODE_FULL);
+    stepper_motor_set_custom_speed(2);
+    stepper_motor_set_home();
+}
+
+void tearDown(void) {
+    stepper_motor_halt();
+}
+
+static void run_to(uint16_t angle) {
+    stepper_motor_move_to(angle);
+    sim_run_to_stop();
+}
+
+// 逆时针越过原点后位置为负数，圈内位置仍落在[0, 每圈步数)内
+void test_position_is_signed(void) {
+    stepper_motor_set_direction(COUNTER_CLOCKWISE);
+    stepper_motor_rotate_steps(100);
+    sim_run_to_stop();
+
+    uint32_t per_rev = stepper_motor_get_steps_per_revolution();
+    TEST_ASSERT_EQUAL_INT32(-100, stepper_motor_get_position());
+    TEST_ASSERT_UINT32_WITHIN(1, per_rev - 100, stepper_motor_get_position_in_revolution());
+}
+
+// 从0°转到350°走逆时针10°，再转到10°顺时针越过原点走20°
+void test_move_to_takes_shortest_path(void) {
+    uint32_t per_rev = stepper_motor_get_steps_per_revolution();
+    int32_t ten_degrees = (int32_t)((per_rev * 10 + 180) / 360);
+
+    run_to(350);
+    TEST_ASSERT_INT_WITHIN(1, -ten_degrees, stepper_motor_get_position());
+
+    run_to(10);
+    TEST_ASSERT_INT_WITHIN(1, ten_degrees, stepper_motor_get_position());
+}
+
+// 已在目标角度时不转动；多圈之后仍按圈内位置选最近的方向
+void test_move_to_after_several_turns(void) {
+    uint32_t per_rev = stepper_motor_get_steps_per_revolution();
+
+    run_to(0);
+    TEST_ASSERT_FALSE(stepper_motor_is_running());
+    TEST_ASSERT_EQUAL_INT32(0, stepper_motor_get_position());
+
+    stepper_motor_set_position(-3 * (int32_t)per_rev);
+    run_to(90);
+    int32_t travelled = stepper_motor_get_position() + 3 * (int32_t)per_rev;
+    TEST_ASSERT_INT_WITHIN(1, (int32_t)(per_rev / 4), travelled);
+
+    run_to(300);
+    travelled = stepper_motor_get_position() + 3 * (int32_t)per_rev;
+    TEST_ASSERT_INT_WITHIN(1, -(int32_t)(per_rev / 6), travelled);
+}
+
+// 最短偏移取值范围为(-半圈, +半圈]
+void test_shortest_offset_range(void) {
+    uint32_t per_rev = stepper_motor_get_steps_per_revolution();
+    for (uint32_t target = 0; target < per_rev; target += 97) {
+        int32_t offset = stepper_motor_get_shortest_offset(target);
+        TEST_ASSERT_TRUE(offset > -(int32_t)(per_rev / 2) - 1);
+        TEST_ASSERT_TRUE(offset <= (int32_t)(per_rev / 2) + 1);
+    }
+}
+
+// 切换步进模式换算位置：奇数半步位置换到全步再换回不丢半步，负数同样成立
+void test_step_mode_round_trip_keeps_odd_positions(void) {
+    const int32_t positions[] = {7, -7, 1, -1, 12345, -12345};
+
+    for (uint8_t i = 0; i < sizeof(positions) / sizeof(positions[0]); i++) {
+        stepper_motor_set_step_mode(STEP_MODE_HALF);
+        stepper_motor_set_position(positions[i]);
+
+        stepper_motor_set_step_mode(STEP_MODE_FULL);
+        // 全步位置向负方向取整
+        int32_t full = (positions[i] >= 0) ? positions[i] / 2 : -((-positions[i] + 1) / 2);
+        TEST_ASSERT_EQUAL_INT32(full, stepper_motor_get_position());
+
+        stepper_motor_set_step_mode(STEP_MODE_MICRO);
+        stepper_motor_set_microsteps(16);
+        TEST_ASSERT_EQUAL_INT32(positions[i] * 8, stepper_motor_get_position());
+        stepper_motor_set_microsteps(4);
+        TEST_ASSERT_EQUAL_INT32(positions[i] * 2, stepper_motor_get_position());
+
+        stepper_motor_set_step_mode(STEP_MODE_HALF);
+        TEST_ASSERT_EQUAL_INT32(positions[i], stepper_motor_get_position());
+    }
+}
+
+// 大位置换算不溢出：半步2亿步换到16细分为16亿步，4细分2.7亿微步换到16细分
+void test_step_mode_rescale_large_positions(void) {
+    stepper_motor_set_step_mode(STEP_MODE_HALF);
+    stepper_motor_set_position(200000000L);
+    stepper_motor_set_step_mode(STEP_MODE_MICRO);
+    stepper_motor_set_microsteps(16);
+    TEST_ASSERT_EQUAL_INT32(1600000000L, stepper_motor_get_position());
+
+    stepper_motor_set_microsteps(4);
+    stepper_motor_set_position(-270000001L);
+    stepper_motor_set_microsteps(16);
+    TEST_ASSERT_EQUAL_INT32(-1080000004L, stepper_motor_get_position());
+    stepper_motor_set_microsteps(8);
+    TEST_ASSERT_EQUAL_INT32(-540000002L, stepper_motor_get_position());
+
+    // 超出32位的结果饱和而不是回绕
+    stepper_motor_set_step_mode(STEP_MODE_FULL);
+    stepper_motor_set_position(200000000L);
+    stepper_motor_set_step_mode(STEP_MODE_MICRO);
+    stepper_motor_set_microsteps(16);
+    TEST_ASSERT_EQUAL_INT32(0x7FFFFFFFL, stepper_motor_get_position());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_position_is_signed);
+    RUN_TEST(test_move_to_takes_shortest_path);
+    RUN_TEST(test_move_to_after_several_turns);
+    RUN_TEST(test_shortest_offset_range);
+    RUN_TEST(test_step_mode_round_trip_keeps_odd_positions);
+    RUN_TEST(test_step_mode_rescale_large_positions);
+    return UNITY_END();
+}
@@ -0,0 +1,132 @@
+#include <unity.h>
+#include "stepper_sim.h"
+#include "stepper_queue.h"
+
+// 运动段队列：环形缓冲区的满/空和先进先出，以及由步进中断直接消费的段序列
+
+static uint8_t done_events = 0;
+
+static void on_event(uint8_t events) {
+    if (events & STEPPER_EVENT_MOVE_DONE) done_events++;
+}
+
+void setUp(void) {
+    sim_reset();
+    stepper_queue_clear();
+    stepper_motor_set_step_mode(STEP_MODE_FULL);
+    stepper_motor_set_custom_speed(2);
+    done_events = 0;
+}
+
+void tearDown(void) {
+    stepper_motor_halt();
+}
+
+static motion_segment_t make_segment(uint32_t value) {
+    motion_segment_t segment;
+    segment.type = MOTION_SEGMENT_MOVE;
+    segment.arg = 0;
+    segment.value = value;
+    return segment;
+}
+
+// 实际可存放SIZE-1段，满时push失败，空时pop失败
+void test_queue_full_and_empty(void) {
+    motion_segment_t segment;
+    TEST_ASSERT_FALSE(stepper_queue_pop(&segment));
+    TEST_ASSERT_EQUAL_UINT8(STEPPER_QUEUE_SIZE - 1, stepper_queue_free());
+
+    for (uint8_t i = 0; i < STEPPER_QUEUE_SIZE - 1; i++) {
+        segment = make_segment(i);
+        TEST_ASSERT_TRUE(stepper_queue_push(&segment));
+    }
+    segment = make_segment(99);
+    TEST_ASSERT_FALSE(stepper_queue_push(&segment));
+    TEST_ASSERT_EQUAL_UINT8(0, stepper_queue_free());
+    TEST_ASSERT_EQUAL_UINT8(STEPPER_QUEUE_SIZE - 1, stepper_queue_count());
+
+    for (uint8_t i = 0; i < STEPPER_QUEUE_SIZE - 1; i++) {
+        TEST_ASSERT_TRUE(stepper_queue_pop(&segment));
+        TEST_ASSERT_EQUAL_UINT32(i, segment.value);
+    }
+    TEST_ASSERT_FALSE(stepper_queue_pop(&segment));
+}
+
+// 下标回绕多圈后仍保持先进先出，peek不取出
+void test_queue_fifo_across_wraparound(void) {
+    motion_segment_t segment;
+    uint32_t next_in = 0;
+    uint32_t next_out = 0;
+
+    for (uint16_t round = 0; round < 50; round++) {
+        for (uint8_t i = 0; i < 3; i++) {
+            segment = make_segment(next_in++);
+            TEST_ASSERT_TRUE(stepper_queue_push(&segment));
+        }
+        TEST_ASSERT_TRUE(stepper_queue_peek(1, &segment));
+        TEST_ASSERT_EQUAL_UINT32(next_out + 1, segment.value);
+        TEST_ASSERT_FALSE(stepper_queue_peek(3, &segment));
+
+        for (uint8_t i = 0; i < 3; i++) {
+            TEST_ASSERT_TRUE(stepper_queue_pop(&segment));
+            TEST_ASSERT_EQUAL_UINT32(next_out++, segment.value);
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT8(0, stepper_queue_count());
+}
+
+// 转动-停留-换向-转动整串由中断执行完，只产生一次运动结束事件
+void test_motor_executes_segments_in_order(void) {
+    stepper_motor_set_event_callback(on_event);
+
+    TEST_ASSERT_TRUE(stepper_motor_queue_move(200, PROFILE_TRAPEZOID));
+    TEST_ASSERT_TRUE(stepper_motor_is_running());
+    TEST_ASSERT_TRUE(stepper_motor_queue_dwell(50000));
+    TEST_ASSERT_TRUE(stepper_motor_queue_direction(COUNTER_CLOCKWISE));
+    TEST_ASSERT_TRUE(stepper_motor_queue_move(50, PROFILE_TRAPEZOID));
+
+    int32_t peak = 0;
+    while (sim_timer_running()) {
+        sim_fire();
+        int32_t position = stepper_motor_get_position();
+        if (position > peak) peak = position;
+    }
+    stepper_motor_update();
+
+    TEST_ASSERT_EQUAL_INT32(200, peak);
+    TEST_ASSERT_EQUAL_INT32(150, stepper_motor_get_position());
+    TEST_ASSERT_EQUAL_UINT8(1, done_events);
+    TEST_ASSERT_EQUAL_UINT8(STEPPER_QUEUE_SIZE - 1, stepper_motor_queue_free());
+}
+
+// 停留段按微秒计时：停留期间不走步
+void test_dwell_duration(void) {
+    TEST_ASSERT_TRUE(stepper_motor_queue_dwell(300000));
+    TEST_ASSERT_TRUE(stepper_motor_is_running());
+    sim_run_to_stop();
+    TEST_ASSERT_EQUAL_INT32(0, stepper_motor_get_position());
+    TEST_ASSERT_UINT32_WITHIN(STEPPER_TICKS_PER_MS, 300UL * STEPPER_TICKS_PER_MS, sim_ticks);
+}
+
+// 超出范围的转动段被拒绝；取消队列后当前段走完即停止
+void test_reject_and_clear(void) {
+    TEST_ASSERT_FALSE(stepper_motor_queue_move(STEPPER_QUEUE_MAX_MOVE_STEPS + 1UL, PROFILE_TRAPEZOID));
+    TEST_ASSERT_FALSE(stepper_motor_is_running());
+
+    TEST_ASSERT_TRUE(stepper_motor_queue_move(100, PROFILE_TRAPEZOID));
+    TEST_ASSERT_TRUE(stepper_motor_queue_dwell(10000));
+    TEST_ASSERT_TRUE(stepper_motor_queue_move(100, PROFILE_TRAPEZOID));
+    stepper_motor_queue_clear();
+    sim_run_to_stop();
+    TEST_ASSERT_EQUAL_INT32(100, stepper_motor_get_position());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_queue_full_and_empty);
+    RUN_TEST(test_queue_fifo_across_wraparound);
+    RUN_TEST(test_motor_executes_segments_in_order);
+    RUN_TEST(test_dwell_duration);
+    RUN_TEST(test_reject_and_clear);
+    return UNITY_END();
+}
@@ -0,0 +1,166 @@
+#include <unity.h>
+#include "stepper_sim.h"
+#include "stepper_ramp.h"
+
+// 加减速曲线：步数精确、加减速对称；运行中的新命令先减速停止，不突然降速也不高速换向
+
+static stepper_ramp_t ramp;
+
+void setUp(void) {
+    memset(&ramp, 0, sizeof(ramp));
+    stepper_ramp_set_profile(&ramp, PROFILE_TRAPEZOID);
+    stepper_ramp_set_acceleration(&ramp, STEPPER_DEFAULT_ACCELERATION);
+    stepper_ramp_set_jerk(&ramp, STEPPER_DEFAULT_JERK);
+
+    sim_reset();
+    stepper_motor_set_step_mode(STEP_MODE_FULL);
+    stepper_motor_set_custom_speed(2);
+}
+
+void tearDown(void) {
+    stepper_motor_halt();
+}
+
+// 按中断的调用方式走完一次运动，记录每步间隔，返回步数
+static uint32_t run_ramp(uint32_t steps, uint16_t cruise_delay, uint16_t* delays, uint32_t capacity) {
+    uint32_t count = 0;
+    uint16_t delay = stepper_ramp_plan(&ramp, steps, cruise_delay);
+    while (delay != 0 && count < 100000UL) {
+        if (count < capacity) delays[count] = delay;
+        count++;
+        delay = stepper_ramp_next_delay(&ramp);
+    }
+    return count;
+}
+
+// 运行时计算的梯形曲线：各种步数下都正好走完，且减速段是加速段的镜像
+void test_trapezoid_step_count_and_symmetry(void) {
+    static uint16_t delays[4000];
+    const uint32_t lengths[] = {1, 2, 3, 10, 57, 400, 3000};
+
+    stepper_ramp_set_acceleration(&ramp, 3000);
+    for (uint8_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++) {
+        uint32_t count = run_ramp(lengths[i], STEPPER_US_TO_TICKS(1000), delays, 4000);
+        TEST_ASSERT_EQUAL_UINT32(lengths[i], count);
+        TEST_ASSERT_FALSE(ramp.use_table);
+
+        // 整数递推的截断误差由余数累积消除，对称步的间隔相差不超过1%
+        for (uint32_t k = 0; k < count / 2; k++) {
+            uint16_t up = delays[k];
+            uint16_t down = delays[count - 1 - k];
+            TEST_ASSERT_INT_WITHIN(up / 100 + 1, up, down);
+        }
+    }
+}
+
+// 查表模式：步数精确，减速段与加速段逐项相同
+void test_table_step_count_and_symmetry(void) {
+    static uint16_t delays[2000];
+    const uint32_t lengths[] = {2, 3, 11, 100, 1500};
+
+    for (uint8_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++) {
+        uint32_t count = run_ramp(lengths[i], STEPPER_US_TO_TICKS(2000), delays, 2000);
+        TEST_ASSERT_TRUE(ramp.use_table);
+        TEST_ASSERT_EQUAL_UINT32(lengths[i], count);
+        for (uint32_t k = 0; k < count / 2; k++) {
+            TEST_ASSERT_EQUAL_UINT16(delays[k], delays[count - 1 - k]);
+        }
+    }
+}
+
+// 巡航中发出新的计数运动：先按加速度减速，停止后从静止开始，相邻间隔最多翻倍
+void test_rotate_while_running_has_no_abrupt_slowdown(void) {
+    stepper_motor_set_acceleration(3000);
+    stepper_motor_start();
+    for (uint16_t i = 0; i < 800; i++) {
+        sim_fire();
+    }
+    int32_t start = stepper_motor_get_position();
+
+    stepper_motor_rotate_steps(500);
+    uint16_t previous = OCR1A + 1;
+    while (sim_timer_running()) {
+        uint16_t interval = sim_fire();
+        TEST_ASSERT_LESS_OR_EQUAL(2UL * previous, interval);
+        previous = interval;
+    }
+
+    // 减速距离加上新运动的500步
+    int32_t travelled = stepper_motor_get_position() - start;
+    TEST_ASSERT_GREATER_THAN(500, travelled);
+    TEST_ASSERT_EQUAL_INT32(500, stepper_motor_get_current_rotation_steps());
+}
+
+// 巡航中要求移动到身后的位置：先减速停止再反向，最终精确到达目标
+void test_move_to_position_never_reverses_at_speed(void) {
+    stepper_motor_set_acceleration(3000);
+    stepper_motor_start();
+    for (uint16_t i = 0; i < 800; i++) {
+        sim_fire();
+    }
+    stepper_ramp_set_acceleration(&ramp, 3000);
+    uint16_t c0 = ramp.c0;
+
+    stepper_motor_move_to_position(-300);
+    TEST_ASSERT_EQUAL(CLOCKWISE, stepper_motor_get_direction());
+
+    int32_t last = stepper_motor_get_position();
+    uint16_t interval = 0;
+    bool reversed = false;
+    while (sim_timer_running()) {
+        uint16_t previous = interval;
+        interval = sim_fire();
+        int32_t position = stepper_motor_get_position();
+        if (!reversed && position < last) {
+            // 第一次反向的前一步已降到接近起步速度
+            TEST_ASSERT_GREATER_OR_EQUAL(c0 / 2, previous);
+            reversed = true;
+        }
+        last = position;
+    }
+    TEST_ASSERT_TRUE(reversed);
+    TEST_ASSERT_EQUAL_INT32(-300, stepper_motor_get_position());
+}
+
+// 运行中设置的方向在停止后生效
+void test_direction_latched_while_running(void) {
+    stepper_motor_start();
+    for (uint16_t i = 0; i < 100; i++) {
+        sim_fire();
+    }
+    stepper_motor_set_direction(COUNTER_CLOCKWISE);
+    TEST_ASSERT_EQUAL(CLOCKWISE, stepper_motor_get_direction());
+
+    int32_t last = stepper_motor_get_position();
+    stepper_motor_stop();
+    while (sim_timer_running()) {
+        sim_fire();
+        TEST_ASSERT_GREATER_OR_EQUAL(last, stepper_motor_get_position());
+        last = stepper_motor_get_position();
+    }
+    TEST_ASSERT_EQUAL(COUNTER_CLOCKWISE, stepper_motor_get_direction());
+}
+
+// 运行中设置的加速度不丢失，下一次启动时生效
+void test_acceleration_set_while_running_applies_on_next_start(void) {
+    stepper_motor_start();
+    sim_fire();
+    stepper_motor_set_acceleration(5000);
+    TEST_ASSERT_EQUAL_UINT16(STEPPER_DEFAULT_ACCELERATION, stepper_motor_get_acceleration());
+
+    stepper_motor_stop();
+    sim_run_to_stop();
+    stepper_motor_rotate_steps(10);
+    TEST_ASSERT_EQUAL_UINT16(5000, stepper_motor_get_acceleration());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_trapezoid_step_count_and_symmetry);
+    RUN_TEST(test_table_step_count_and_symmetry);
+    RUN_TEST(test_rotate_while_running_has_no_abrupt_slowdown);
+    RUN_TEST(test_move_to_position_never_reverses_at_speed);
+    RUN_TEST(test_direction_latched_while_running);
+    RUN_TEST(test_acceleration_set_while_running_applies_on_next_start);
+    return UNITY_END();
+}
@@ -0,0 +1,134 @@
+#include <unity.h>
+#include <stdio.h>
+#include "stepper_sim.h"
+#include "stepper_ramp.h"
+#include "stepper_ramp_table.h"
+#include "config.h"
+
+// 加速表与运行时递推的每步开销对比（主机基准）
+// 查表：替身的pgm_read_word计数Flash读取次数；
+// 运行时：trapezoid_next_delay()在加速/减速步各做一次32位除法（商和余数由同一次除法得到），按阶段计数。
+// 只比较运算次数，不代表AVR上的周期数。
+
+#define BENCH_STEPS     2000UL
+#define BENCH_CAPACITY  256
+
+typedef struct {
+    uint32_t steps;             // 总步数
+    uint32_t ramp_steps;        // 加速和减速的步数
+    uint32_t divisions;         // 递推除法次数
+    uint32_t table_reads;       // Flash表读取次数
+    uint32_t accel_len;         // 加速段记录的间隔个数
+    uint16_t accel[BENCH_CAPACITY];
+} bench_result_t;
+
+static stepper_ramp_t ramp;
+
+void setUp(void) {
+    memset(&ramp, 0, sizeof(ramp));
+    stepper_ramp_set_profile(&ramp, PROFILE_TRAPEZOID);
+    stepper_ramp_set_acceleration(&ramp, STEPPER_DEFAULT_ACCELERATION);
+    stub_pgm_word_reads = 0;
+}
+
+void tearDown(void) {
+}
+
+// 按中断的调用方式走完一次运动，统计每步的运算
+static void bench_run(uint16_t cruise_delay, bench_result_t* result) {
+    memset(result, 0, sizeof(*result));
+    stub_pgm_word_reads = 0;
+
+    uint16_t delay = stepper_ramp_plan(&ramp, BENCH_STEPS, cruise_delay);
+    bool table = ramp.use_table;
+    while (delay != 0 && result->steps < 100000UL) {
+        if (ramp.phase == RAMP_ACCEL && result->accel_len < BENCH_CAPACITY) {
+            result->accel[result->accel_len++] = delay;
+        }
+        result->steps++;
+
+        ramp_phase_t phase = ramp.phase;
+        delay = stepper_ramp_next_delay(&ramp);
+        if (phase == RAMP_ACCEL || phase == RAMP_DECEL) {
+            result->ramp_steps++;
+            // 长距离运动不会从加速段直接折返；减速段最后一次调用在除法前返回0
+            if (!table && (phase == RAMP_ACCEL || delay != 0)) {
+                result->divisions++;
+            }
+        }
+    }
+    result->table_reads = stub_pgm_word_reads;
+}
+
+// 对比一个巡航间隔：查表用预设间隔，运行时用多1 tick的间隔（不在表中），两者的c(n)序列相同
+static void bench_compare(uint8_t preset, uint16_t cruise_delay) {
+    static bench_result_t table;
+    static bench_result_t runtime;
+
+    // 预设间隔不短于c0时无需加速，两种方式都是匀速
+    const uint16_t* unused;
+    if (stepper_ramp_table_lookup(STEPPER_DEFAULT_ACCELERATION, cruise_delay, &unused) == 0) {
+        printf("  preset %3u ms, delay %5u: no ramp\n", preset, cruise_delay);
+        return;
+    }
+
+    bench_run(cruise_delay, &table);
+    TEST_ASSERT_TRUE(ramp.use_table);
+    bench_run(cruise_delay + 1, &runtime);
+    TEST_ASSERT_FALSE(ramp.use_table);
+
+    TEST_ASSERT_EQUAL_UINT32(BENCH_STEPS, table.steps);
+    TEST_ASSERT_EQUAL_UINT32(BENCH_STEPS, runtime.steps);
+
+    // 查表：每个加减速步一次Flash读取，没有除法
+    TEST_ASSERT_EQUAL_UINT32(0, table.divisions);
+    TEST_ASSERT_EQUAL_UINT32(table.ramp_steps, table.table_reads);
+
+    // 运行时：每个加减速步一次除法，不读表（减速段最后一步c0不需要再算）
+    TEST_ASSERT_EQUAL_UINT32(0, runtime.table_reads);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(runtime.ramp_steps, runtime.divisions);
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(runtime.ramp_steps - 2, runtime.divisions);
+
+    // 两种方式的加速间隔逐项相同（运行时巡航间隔大1 tick，高速时可能提前几步进入巡航）
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(table.accel_len, runtime.accel_len);
+    for (uint32_t k = 0; k < runtime.accel_len; k++) {
+        TEST_ASSERT_EQUAL_UINT16(table.accel[k], runtime.accel[k]);
+    }
+
+    printf("  preset %3u ms, delay %5u: table %3lu ramp steps, %3lu reads, %lu div | runtime %3lu ramp steps, %3lu div, %lu reads\n",
+           preset, cruise_delay,
+           (unsigned long)table.ramp_steps, (unsigned long)table.table_reads, (unsigned long)table.divisions,
+           (unsigned long)runtime.ramp_steps, (unsigned long)runtime.divisions, (unsigned long)runtime.table_reads);
+}
+
+// 全步：每个速度预设的每全步间隔
+void test_full_step_presets_table_vs_runtime(void) {
+    for (uint8_t i = 0; i < MOTOR_SPEED_PRESET_COUNT; i++) {
+        uint8_t preset = config_get_motor_speed_preset(i);
+        bench_compare(preset, (uint16_t)(preset * STEPPER_TICKS_PER_MS));
+    }
+}
+
+// 半步/自动模式：预设间隔的一半
+void test_half_step_presets_table_vs_runtime(void) {
+    for (uint8_t i = 0; i < MOTOR_SPEED_PRESET_COUNT; i++) {
+        uint8_t preset = config_get_motor_speed_preset(i);
+        bench_compare(preset, (uint16_t)(preset * STEPPER_TICKS_PER_MS / 2));
+    }
+}
+
+// 表的Flash占用按尺寸计算：共用表加每个预设的全步/半步长度
+void test_table_flash_bytes(void) {
+    uint16_t bytes = stepper_ramp_table_flash_bytes();
+    printf("  ramp table flash bytes: %u\n", bytes);
+    TEST_ASSERT_GREATER_THAN(2 * MOTOR_SPEED_PRESET_COUNT, bytes);
+    TEST_ASSERT_LESS_OR_EQUAL(2 * 255 + 2 * MOTOR_SPEED_PRESET_COUNT, bytes);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_full_step_presets_table_vs_runtime);
+    RUN_TEST(test_half_step_presets_table_vs_runtime);
+    RUN_TEST(test_table_flash_bytes);
+    return UNITY_END();
+}
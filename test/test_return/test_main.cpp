@@ -0,0 +1,134 @@
+#include <unity.h>
+#include "stepper_sim.h"
+#include "config.h"
+
+// 拍照结束回原点：按拍照模式的方式分度旋转（自动步进模式，余数带到下一次），
+// 最后move_to(0)取最短有符号偏移，精确停在某一整圈的0°
+
+static stepper_gear_ratio_t ratio;
+
+void setUp(void) {
+    sim_reset();
+    stepper_motor_set_step_mode(STEP_MODE_AUTO);
+    stepper_motor_set_custom_speed(4);
+    stepper_motor_get_gear_ratio(&ratio);
+}
+
+void tearDown(void) {
+    stepper_motor_halt();
+    stepper_motor_set_backlash(0);
+}
+
+// 拍一次会话：total_angle/interval张照片，最后一张之后不再旋转
+static void run_session(uint16_t total_angle, uint8_t interval, motor_direction_t direction) {
+    uint32_t carry = stepper_gear_carry_init(&ratio);
+    uint16_t photos = total_angle / interval;
+
+    stepper_motor_set_direction(direction);
+    for (uint16_t i = 1; i < photos; i++) {
+        stepper_motor_rotate_steps(stepper_gear_degrees_to_steps(&ratio, interval, &carry));
+        sim_run_to_stop();
+    }
+}
+
+// 回原点，返回走过的有符号步数
+static int32_t run_return() {
+    int32_t start = stepper_motor_get_position();
+    stepper_motor_set_custom_speed(MOTOR_SPEED_MIN);
+    stepper_motor_set_motion_profile(PROFILE_TRAPEZOID);
+    stepper_motor_move_to(0);
+    sim_run_to_stop();
+    TEST_ASSERT_FALSE(stepper_motor_is_running());
+    return stepper_motor_get_position() - start;
+}
+
+// 终点是最近的整圈0°：与起点所在圈或相邻圈的0°位置精确相等
+static void assert_at_origin(int32_t start) {
+    int32_t position = stepper_motor_get_position();
+    int32_t revolution = stepper_gear_revolution_of(&ratio, start, nullptr);
+    bool exact = false;
+    for (int32_t k = revolution - 1; k <= revolution + 1; k++) {
+        if (position == stepper_gear_angle_position(&ratio, k, 0)) {
+            exact = true;
+        }
+    }
+    TEST_ASSERT_TRUE(exact);
+    TEST_ASSERT_EQUAL_INT32(0, stepper_motor_get_shortest_offset(0));
+}
+
+// 非整圈会话：反向回到原点，不超过半圈
+void test_partial_turn_returns_backwards(void) {
+    static const uint16_t angles[] = {90, 180, 270};
+    static const uint8_t intervals[] = {5, 10, 15, 30};
+
+    for (uint8_t a = 0; a < 3; a++) {
+        for (uint8_t i = 0; i < 4; i++) {
+            setUp();
+            run_session(angles[a], intervals[i], CLOCKWISE);
+            int32_t start = stepper_motor_get_position();
+            int32_t travelled = run_return();
+
+            assert_at_origin(start);
+            TEST_ASSERT_LESS_OR_EQUAL((int32_t)(stepper_gear_steps_per_revolution(&ratio) / 2), labs(travelled));
+            // 最后一张在(angle - interval)°，按最短路径回原点
+            uint16_t last = angles[a] - intervals[i];
+            TEST_ASSERT_TRUE(last <= 180 ? travelled < 0 : travelled > 0);
+        }
+    }
+}
+
+// 整圈和多圈会话：沿原方向再转一个间隔就到原点
+void test_full_turn_returns_forward(void) {
+    static const uint16_t angles[] = {360, 720};
+
+    for (uint8_t a = 0; a < 2; a++) {
+        for (uint8_t d = 0; d < 2; d++) {
+            setUp();
+            motor_direction_t direction = d == 0 ? CLOCKWISE : COUNTER_CLOCKWISE;
+            run_session(angles[a], 30, direction);
+            int32_t start = stepper_motor_get_position();
+            int32_t travelled = run_return();
+
+            assert_at_origin(start);
+            int32_t interval_steps = (int32_t)((30UL * ratio.num + 180UL * ratio.den) / (360UL * ratio.den));
+            TEST_ASSERT_INT_WITHIN(1, direction == CLOCKWISE ? interval_steps : -interval_steps, travelled);
+        }
+    }
+}
+
+// 间隙补偿：回程反向时先吃掉间隙，位置计数仍精确回到原点
+void test_return_with_backlash(void) {
+    stepper_motor_set_backlash(8);
+    run_session(90, 10, CLOCKWISE);
+    int32_t start = stepper_motor_get_position();
+    run_return();
+    assert_at_origin(start);
+}
+
+// 回程用最高速度：比以拍摄速度走同样的偏移更快
+void test_return_is_faster_than_capture_speed(void) {
+    run_session(180, 15, CLOCKWISE);
+    int32_t start = stepper_motor_get_position();
+
+    uint64_t begin = sim_ticks;
+    run_return();
+    uint64_t fast = sim_ticks - begin;
+
+    stepper_motor_set_position(start);
+    stepper_motor_set_custom_speed(4);
+    begin = sim_ticks;
+    stepper_motor_move_to_position(0);
+    sim_run_to_stop();
+    uint64_t capture = sim_ticks - begin;
+
+    TEST_ASSERT_TRUE(fast * 10 < capture * 8);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_partial_turn_returns_backwards);
+    RUN_TEST(test_full_turn_returns_forward);
+    RUN_TEST(test_return_with_backlash);
+    RUN_TEST(test_return_is_faster_than_capture_speed);
+    return UNITY_END();
+}
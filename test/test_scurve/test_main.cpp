@@ -0,0 +1,106 @@
+#include <unity.h>
+#include "stepper_sim.h"
+#include "stepper_ramp.h"
+
+// S曲线：步数精确、高速低加加速度下规划不溢出；运行中修改的jerk和曲线类型在下一次运动生效
+
+static stepper_ramp_t ramp;
+
+void setUp(void) {
+    memset(&ramp, 0, sizeof(ramp));
+    stepper_ramp_set_profile(&ramp, PROFILE_SCURVE);
+    stepper_ramp_set_acceleration(&ramp, STEPPER_DEFAULT_ACCELERATION);
+    stepper_ramp_set_jerk(&ramp, STEPPER_DEFAULT_JERK);
+
+    sim_reset();
+    stepper_motor_set_step_mode(STEP_MODE_FULL);
+    stepper_motor_set_custom_speed(2);
+}
+
+void tearDown(void) {
+    stepper_motor_halt();
+}
+
+// 走完一次计数运动，返回步数
+static uint32_t run_ramp(uint32_t steps, uint16_t cruise_delay) {
+    uint32_t count = 0;
+    uint16_t delay = stepper_ramp_plan(&ramp, steps, cruise_delay);
+    while (delay != 0 && count < 1000000UL) {
+        count++;
+        delay = stepper_ramp_next_delay(&ramp);
+    }
+    return count;
+}
+
+// 各种步数下都正好走完
+void test_scurve_step_count(void) {
+    const uint32_t lengths[] = {1, 2, 5, 40, 333, 5000};
+    for (uint8_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++) {
+        TEST_ASSERT_EQUAL_UINT32(lengths[i], run_ramp(lengths[i], STEPPER_US_TO_TICKS(1000)));
+    }
+}
+
+// 巡航10000步/秒、jerk取最小值：AVR上unsigned long为32位，加速时间曾在v×10⁶处溢出，短距离运动的峰值速度因此估错
+// 主机上long为64位复现不了溢出，这里检查改写后的整数运算与实测加速距离一致
+void test_scurve_high_speed_plan_does_not_overflow(void) {
+    const uint16_t cruise_delay = 25;   // 10000步/秒
+    stepper_ramp_set_acceleration(&ramp, STEPPER_MAX_ACCELERATION);
+    stepper_ramp_set_jerk(&ramp, STEPPER_MIN_JERK);
+
+    // 连续转动实测加速到巡航所需步数
+    uint32_t accel_steps = 0;
+    stepper_ramp_plan(&ramp, STEPPER_RAMP_UNLIMITED, cruise_delay);
+    while (!ramp.accel_done && accel_steps < 1000000UL) {
+        stepper_ramp_next_delay(&ramp);
+        accel_steps++;
+    }
+    TEST_ASSERT_TRUE(ramp.accel_done);
+
+    // 规划估算与实测一致：够长的运动能到巡航，不够长的运动降低峰值
+    stepper_ramp_plan(&ramp, accel_steps * 22 / 10, cruise_delay);
+    TEST_ASSERT_TRUE(ramp.full_cruise);
+    stepper_ramp_plan(&ramp, accel_steps * 18 / 10, cruise_delay);
+    TEST_ASSERT_FALSE(ramp.full_cruise);
+
+    TEST_ASSERT_EQUAL_UINT32(accel_steps * 18 / 10, run_ramp(accel_steps * 18 / 10, cruise_delay));
+}
+
+// 走一次计数运动，返回用时（tick）
+static uint64_t timed_move(uint32_t steps) {
+    uint64_t start = sim_ticks;
+    stepper_motor_rotate_steps(steps);
+    sim_run_to_stop();
+    return sim_ticks - start;
+}
+
+// 运行中设置的曲线类型和jerk不丢失：停止后的下一次运动与静止时设置的结果相同
+void test_profile_and_jerk_set_while_running_apply_on_next_move(void) {
+    stepper_motor_set_motion_profile(PROFILE_SCURVE);
+    stepper_motor_set_jerk(STEPPER_MIN_JERK);
+    uint64_t reference = timed_move(400);
+
+    sim_reset();
+    stepper_motor_set_step_mode(STEP_MODE_FULL);
+    stepper_motor_set_custom_speed(2);
+    stepper_motor_start();
+    sim_fire();
+    stepper_motor_set_motion_profile(PROFILE_SCURVE);
+    stepper_motor_set_jerk(STEPPER_MIN_JERK);
+    TEST_ASSERT_EQUAL(PROFILE_TRAPEZOID, stepper_motor_get_motion_profile());
+
+    stepper_motor_stop();
+    sim_run_to_stop();
+    stepper_motor_update();
+    TEST_ASSERT_EQUAL(PROFILE_SCURVE, stepper_motor_get_motion_profile());
+
+    uint64_t elapsed = timed_move(400);
+    TEST_ASSERT_TRUE(elapsed == reference);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_scurve_step_count);
+    RUN_TEST(test_scurve_high_speed_plan_does_not_overflow);
+    RUN_TEST(test_profile_and_jerk_set_while_running_apply_on_next_move);
+    return UNITY_END();
+}
@@ -0,0 +1,163 @@
+#include <unity.h>
+#include "stepper_sim.h"
+#include "stepper_stall.h"
+
+// 堵转检测：检测算法喂入合成的电流序列，以及步进中断→比较B→ADC中断的完整采样链路
+
+static stepper_stall_detector_t detector;
+static uint8_t received_events = 0;
+
+static void on_event(uint8_t events) {
+    received_events |= events;
+}
+
+void setUp(void) {
+    sim_reset();
+    stepper_motor_set_step_mode(STEP_MODE_FULL);
+    stepper_motor_set_custom_speed(2);
+    stepper_stall_detector_reset(&detector);
+    received_events = 0;
+}
+
+void tearDown(void) {
+    stepper_motor_halt();
+    stepper_motor_enable_stall_detection(false);
+}
+
+// 学习基线：两种线圈组合交替，各自学满STEPPER_STALL_LEARN_SAMPLES个样本
+static void learn(uint16_t single, uint16_t dual) {
+    for (uint8_t i = 0; i < STEPPER_STALL_LEARN_SAMPLES; i++) {
+        TEST_ASSERT_FALSE(stepper_stall_detector_feed(&detector, 0, single));
+        TEST_ASSERT_FALSE(stepper_stall_detector_feed(&detector, 1, dual));
+    }
+}
+
+// 正常转动：±10%的噪声和缓慢漂移（电压、温度）不触发
+void test_normal_current_does_not_trip(void) {
+    learn(300, 500);
+
+    srand(7);
+    for (uint16_t i = 0; i < 2000; i++) {
+        uint16_t drift = i / 40;
+        int16_t noise = (int16_t)(rand() % 61) - 30;
+        TEST_ASSERT_FALSE(stepper_stall_detector_feed(&detector, 0, (uint16_t)(300 + drift + noise / 2)));
+        TEST_ASSERT_FALSE(stepper_stall_detector_feed(&detector, 1, (uint16_t)(500 + drift + noise)));
+    }
+}
+
+// 堵转（没有反电动势，电流升高）：第STEPPER_STALL_CONSECUTIVE个连续异常样本触发，之后保持
+void test_stall_trips_after_consecutive_anomalies(void) {
+    learn(300, 500);
+
+    for (uint8_t i = 1; i < STEPPER_STALL_CONSECUTIVE; i++) {
+        TEST_ASSERT_FALSE(stepper_stall_detector_feed(&detector, 1, 700));
+    }
+    TEST_ASSERT_TRUE(stepper_stall_detector_feed(&detector, 1, 700));
+    TEST_ASSERT_TRUE(stepper_stall_detector_feed(&detector, 1, 500));
+}
+
+// 断线（电流偏低）同样触发；异常之间夹一个正常样本则重新计数
+void test_intermittent_anomalies_do_not_trip(void) {
+    learn(300, 500);
+
+    for (uint8_t round = 0; round < 10; round++) {
+        for (uint8_t i = 1; i < STEPPER_STALL_CONSECUTIVE; i++) {
+            TEST_ASSERT_FALSE(stepper_stall_detector_feed(&detector, 0, 150));
+        }
+        TEST_ASSERT_FALSE(stepper_stall_detector_feed(&detector, 0, 300));
+    }
+    for (uint8_t i = 1; i < STEPPER_STALL_CONSECUTIVE; i++) {
+        TEST_ASSERT_FALSE(stepper_stall_detector_feed(&detector, 0, 150));
+    }
+    TEST_ASSERT_TRUE(stepper_stall_detector_feed(&detector, 0, 150));
+}
+
+// 阈值附近：偏离基线不超过STEPPER_STALL_THRESHOLD_PCT不算异常
+void test_threshold_boundary(void) {
+    learn(400, 400);
+
+    uint16_t inside = 400 + 400 * STEPPER_STALL_THRESHOLD_PCT / 100;
+    for (uint16_t i = 0; i < 100; i++) {
+        TEST_ASSERT_FALSE(stepper_stall_detector_feed(&detector, 1, inside));
+        TEST_ASSERT_FALSE(stepper_stall_detector_feed(&detector, 1, 400));
+    }
+}
+
+// 完整链路：巡航中每步在比较B时刻启动ADC，ADC中断喂入样本
+// @return 本步是否安排了采样
+static bool step_with_sample(uint16_t sample) {
+    sim_fire();
+    if (!(TIMSK1 & (1 << OCIE1B))) {
+        return false;
+    }
+    TIMER1_COMPB_vect();
+    TEST_ASSERT_TRUE(ADCSRA & (1 << ADIE));
+    ADCSRA &= ~(1 << ADSC);
+    ADC = sample;
+    ADC_vect();
+    return true;
+}
+
+// 加速段不采样；巡航学习基线后电流持续升高，主循环收到STEPPER_EVENT_STALL
+void test_stall_event_from_sampling_chain(void) {
+    stepper_motor_set_event_callback(on_event);
+    stepper_motor_enable_stall_detection(true);
+    stepper_motor_start();
+
+    uint16_t accel_samples = 0;
+    uint16_t steps = 0;
+    while (steps < 1000) {
+        if (step_with_sample(500)) {
+            break;
+        }
+        steps++;
+        accel_samples++;
+    }
+    TEST_ASSERT_GREATER_THAN(10, accel_samples);
+    TEST_ASSERT_LESS_THAN(1000, steps);
+
+    for (uint16_t i = 0; i < 200; i++) {
+        step_with_sample(500);
+    }
+    stepper_motor_update();
+    TEST_ASSERT_EQUAL_UINT8(0, received_events & STEPPER_EVENT_STALL);
+
+    uint8_t sampled = 0;
+    while (sampled < STEPPER_STALL_CONSECUTIVE) {
+        if (step_with_sample(800)) {
+            sampled++;
+        }
+    }
+    stepper_motor_update();
+    TEST_ASSERT_EQUAL_UINT8(STEPPER_EVENT_STALL, received_events & STEPPER_EVENT_STALL);
+}
+
+// 主循环占用ADC时不采样，也就不会误判
+void test_adc_lock_suppresses_sampling(void) {
+    stepper_motor_set_event_callback(on_event);
+    stepper_motor_enable_stall_detection(true);
+    stepper_motor_start();
+    for (uint16_t i = 0; i < 1000; i++) {
+        sim_fire();
+        TIMSK1 &= ~(1 << OCIE1B);
+    }
+
+    stepper_stall_adc_lock();
+    for (uint16_t i = 0; i < 200; i++) {
+        TEST_ASSERT_FALSE(step_with_sample(800));
+    }
+    stepper_stall_adc_unlock();
+    stepper_motor_update();
+    TEST_ASSERT_EQUAL_UINT8(0, received_events & STEPPER_EVENT_STALL);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_normal_current_does_not_trip);
+    RUN_TEST(test_stall_trips_after_consecutive_anomalies);
+    RUN_TEST(test_intermittent_anomalies_do_not_trip);
+    RUN_TEST(test_threshold_boundary);
+    RUN_TEST(test_stall_event_from_sampling_chain);
+    RUN_TEST(test_adc_lock_suppresses_sampling);
+    return UNITY_END();
+}
@@ -0,0 +1,108 @@
+#include <unity.h>
+#include "stepper_sim.h"
+
+// Timer1步进引擎：步距只由比较匹配中断决定，与主循环是否被阻塞无关
+
+void setUp(void) {
+    sim_reset();
+    stepper_motor_set_step_mode(STEP_MODE_FULL);
+    stepper_motor_set_custom_speed(2);
+}
+
+void tearDown(void) {
+    stepper_motor_halt();
+}
+
+// 2ms预设：加速结束后每步间隔正好是500 tick
+void test_cruise_interval_matches_preset(void) {
+    stepper_motor_start();
+    TEST_ASSERT_TRUE(sim_timer_running());
+
+    for (uint16_t i = 0; i < 1000; i++) {
+        sim_fire();
+    }
+    for (uint16_t i = 0; i < 500; i++) {
+        TEST_ASSERT_EQUAL_UINT16(STEPPER_US_TO_TICKS(2000), sim_fire());
+    }
+}
+
+// 主循环完全不调用stepper_motor_update()，计数运动仍按时走完并停止
+void test_move_completes_while_loop_blocked(void) {
+    stepper_motor_rotate_steps(2048);
+    uint32_t fired = sim_run_to_stop();
+
+    TEST_ASSERT_FALSE(stepper_motor_is_running());
+    TEST_ASSERT_EQUAL_UINT32(2048, fired);
+    TEST_ASSERT_EQUAL_INT32(2048, stepper_motor_get_position());
+
+    // 2048步按500 tick巡航约4.1秒，加上加减速和预励磁不超过5秒
+    TEST_ASSERT_LESS_OR_EQUAL(5000UL * STEPPER_TICKS_PER_MS, sim_ticks);
+}
+
+// 中断被推迟（主循环关中断）时，CTC模式的计数器在比较匹配时已清零，
+// 延迟只影响本步的输出时刻，不会累积到后续步：整个运动的比较匹配时刻序列不变
+void test_isr_latency_does_not_accumulate(void) {
+    const uint16_t max_latency = 100;
+    uint64_t schedule[600];
+
+    stepper_motor_rotate_steps(600);
+    for (uint16_t i = 0; i < 600; i++) {
+        sim_fire();
+        schedule[i] = sim_ticks;
+    }
+    TEST_ASSERT_FALSE(sim_timer_running());
+
+    sim_reset();
+    stepper_motor_set_step_mode(STEP_MODE_FULL);
+    stepper_motor_set_custom_speed(2);
+    stepper_motor_rotate_steps(600);
+
+    uint64_t last_output = 0;
+    srand(1);
+    for (uint16_t i = 0; i < 600; i++) {
+        uint16_t latency = (uint16_t)(rand() % (max_latency + 1));
+        sim_fire(latency);
+        TEST_ASSERT_TRUE(sim_ticks == schedule[i]);
+
+        // 实际输出时刻与预定时刻之差不超过最大延迟，相邻步距的抖动不超过两倍最大延迟
+        uint64_t output = sim_ticks + latency;
+        if (i > 0) {
+            int64_t jitter = (int64_t)(output - last_output) - (int64_t)(schedule[i] - schedule[i - 1]);
+            TEST_ASSERT_INT_WITHIN(max_latency, 0, jitter);
+        }
+        last_output = output;
+    }
+}
+
+// 停止请求按加速度减速，而不是立即断电
+void test_stop_decelerates(void) {
+    stepper_motor_start();
+    for (uint16_t i = 0; i < 1000; i++) {
+        sim_fire();
+    }
+
+    stepper_motor_stop();
+    TEST_ASSERT_TRUE(stepper_motor_is_running());
+
+    uint16_t previous = 0;
+    uint32_t steps = 0;
+    while (sim_timer_running()) {
+        uint16_t interval = sim_fire();
+        if (steps > 0) {
+            TEST_ASSERT_GREATER_OR_EQUAL(previous, interval);
+        }
+        previous = interval;
+        steps++;
+    }
+    TEST_ASSERT_GREATER_THAN(10, steps);
+    TEST_ASSERT_FALSE(stepper_motor_is_running());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_cruise_interval_matches_preset);
+    RUN_TEST(test_move_completes_while_loop_blocked);
+    RUN_TEST(test_isr_latency_does_not_accumulate);
+    RUN_TEST(test_stop_decelerates);
+    return UNITY_END();
+}
@@ -0,0 +1,110 @@
+#include <unity.h>
+#include "stepper_sim.h"
+
+// 线圈温升模型：用减流保持构造固定通电量，检查稳态值、小温差的积分和过热降速
+
+void setUp(void) {
+    sim_reset();
+    stepper_motor_set_step_mode(STEP_MODE_FULL);
+    stepper_motor_set_custom_speed(2);
+}
+
+void tearDown(void) {
+    stepper_motor_halt();
+    stepper_motor_set_hold(0, 0);
+}
+
+// 主循环空转seconds秒，每秒调用一次stepper_motor_update()
+static void idle_seconds(uint16_t seconds) {
+    for (uint16_t i = 0; i < seconds; i++) {
+        sim_advance_ms(1000);
+        stepper_motor_update();
+    }
+}
+
+// 以duty_percent的占空比保持（全步模式两个线圈）
+static void hold_at(uint8_t duty_percent) {
+    stepper_motor_set_hold(duty_percent, 0);
+    stepper_motor_hold();
+    TEST_ASSERT_TRUE(stepper_motor_is_holding());
+}
+
+// 100%保持相当于两个线圈持续通电：6个时间常数后接近稳态温升60°C
+void test_full_duty_steady_state(void) {
+    hold_at(100);
+    idle_seconds(STEPPER_THERMAL_TAU_S * 6);
+    TEST_ASSERT_UINT32_WITHIN(3, 2 * STEPPER_THERMAL_RISE_PER_COIL * 10, stepper_motor_get_temperature_rise());
+}
+
+// 10%保持（3/32占空比）的稳态温升约5.6°C：每周期的变化量小于1（Q8），靠余数累积才能达到
+void test_low_duty_reaches_steady_state(void) {
+    hold_at(10);
+    idle_seconds(STEPPER_THERMAL_TAU_S * 6);
+
+    uint32_t expected = 2UL * STEPPER_THERMAL_RISE_PER_COIL * 10 * 3 / 32;
+    TEST_ASSERT_UINT32_WITHIN(1, expected, stepper_motor_get_temperature_rise());
+}
+
+// 断电后按时间常数冷却，且单调下降
+void test_cooling_after_release(void) {
+    hold_at(100);
+    idle_seconds(STEPPER_THERMAL_TAU_S);
+    uint16_t previous = stepper_motor_get_temperature_rise();
+    TEST_ASSERT_GREATER_THAN(300, previous);
+
+    stepper_motor_release();
+    for (uint16_t i = 0; i < STEPPER_THERMAL_TAU_S * 6; i += 100) {
+        idle_seconds(100);
+        uint16_t rise = stepper_motor_get_temperature_rise();
+        TEST_ASSERT_LESS_OR_EQUAL(previous, rise);
+        previous = rise;
+    }
+    TEST_ASSERT_LESS_OR_EQUAL(10, previous);
+}
+
+// 主循环阻塞5分钟后才更新：按STEPPER_THERMAL_MAX_GAP_MS积分一次，不会溢出
+void test_long_gap_is_clamped(void) {
+    hold_at(100);
+    sim_advance_ms(300000UL);
+    stepper_motor_update();
+
+    // 60°C × 60秒 / 900秒 = 4.0°C
+    uint32_t expected = 2UL * STEPPER_THERMAL_RISE_PER_COIL * 10 * STEPPER_THERMAL_MAX_GAP_MS / (STEPPER_THERMAL_TAU_S * 1000UL);
+    TEST_ASSERT_UINT32_WITHIN(1, expected, stepper_motor_get_temperature_rise());
+}
+
+// 查表加速的计数运动在巡航中过热：降到STEPPER_THERMAL_DERATE_FSPS，仍然精确走完
+void test_derate_slows_running_table_move(void) {
+    hold_at(100);
+    while (stepper_motor_get_temperature_rise() < STEPPER_THERMAL_DERATE_RISE * 10 - 2) {
+        idle_seconds(1);
+    }
+
+    const uint32_t total = 30000;
+    stepper_motor_rotate_steps(total);
+    uint32_t steps = 0;
+    uint16_t interval = 0;
+    while (sim_timer_running() && interval != STEPPER_TIMER_FREQ / STEPPER_THERMAL_DERATE_FSPS) {
+        interval = sim_fire();
+        steps++;
+        if (steps % 500 == 0) {
+            stepper_motor_update();
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT16(STEPPER_TIMER_FREQ / STEPPER_THERMAL_DERATE_FSPS, interval);
+    TEST_ASSERT_LESS_THAN(total / 2, steps);
+
+    steps += sim_run_to_stop();
+    TEST_ASSERT_EQUAL_UINT32(total, steps);
+    TEST_ASSERT_EQUAL_INT32((int32_t)total, stepper_motor_get_position());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_full_duty_steady_state);
+    RUN_TEST(test_low_duty_reaches_steady_state);
+    RUN_TEST(test_cooling_after_release);
+    RUN_TEST(test_long_gap_is_clamped);
+    RUN_TEST(test_derate_slows_running_table_move);
+    return UNITY_END();
+}
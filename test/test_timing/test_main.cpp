@@ -0,0 +1,169 @@
+#include <unity.h>
+#include "stepper_sim.h"
+#include "stepper_timing.h"
+
+// 步进时序统计：对数直方图的桶边界、实际步距的推算、最大超时（总体和按主循环分段）、清空，
+// 以及步进中断的记录链路和串口命令
+
+void setUp(void) {
+    sim_reset();
+    stepper_motor_set_step_mode(STEP_MODE_FULL);
+    stepper_motor_set_custom_speed(2);
+    stepper_timing_reset();
+    stepper_timing_begin_move();
+    stepper_timing_set_section(TIMING_SECTION_IDLE);
+    stub_serial_output.clear();
+    stub_serial_input.clear();
+}
+
+void tearDown(void) {
+    stepper_motor_halt();
+    stepper_motor_set_lock_in(0);
+}
+
+static stepper_timing_stats_t snapshot() {
+    stepper_timing_stats_t stats;
+    stepper_timing_get(&stats);
+    return stats;
+}
+
+// 第0桶为0 tick，第k桶为[2^(k-1), 2^k)，超出范围的计入最后一桶
+void test_bucket_boundaries(void) {
+    const uint16_t intervals[] = {0, 1, 2, 3, 4, 255, 256, 0x4000, 0x7FFF, 0x8000, 0xFFFF};
+    const uint8_t buckets[]    = {0, 1, 2, 2, 3, 8,   9,   15,     15,     15,     15};
+
+    for (uint8_t i = 0; i < sizeof(intervals) / sizeof(intervals[0]); i++) {
+        stepper_timing_reset();
+        stepper_timing_record(0, intervals[i]);
+
+        stepper_timing_stats_t stats = snapshot();
+        for (uint8_t b = 0; b < STEPPER_TIMING_BUCKETS; b++) {
+            TEST_ASSERT_EQUAL_UINT16(b == buckets[i] ? 1 : 0, stats.interval_histogram[b]);
+        }
+        TEST_ASSERT_EQUAL_UINT16(1, stats.overrun_histogram[0]);
+    }
+}
+
+// 实际步距 = 预定间隔 + 本步超时 - 上一步超时；新运动的第一步不减上一次运动的超时
+void test_interval_uses_previous_overrun(void) {
+    stepper_timing_record(10, 256);     // 266：第9桶
+    stepper_timing_record(0, 256);      // 246：第8桶
+    stepper_timing_record(0, 256);      // 256：第9桶
+
+    stepper_timing_stats_t stats = snapshot();
+    TEST_ASSERT_EQUAL_UINT16(1, stats.interval_histogram[8]);
+    TEST_ASSERT_EQUAL_UINT16(2, stats.interval_histogram[9]);
+    TEST_ASSERT_EQUAL_UINT16(2, stats.overrun_histogram[0]);
+    TEST_ASSERT_EQUAL_UINT16(1, stats.overrun_histogram[4]);
+
+    stepper_timing_record(10, 256);
+    stepper_timing_begin_move();
+    stepper_timing_record(0, 256);      // 256而不是246
+    stats = snapshot();
+    TEST_ASSERT_EQUAL_UINT16(1, stats.interval_histogram[8]);
+    TEST_ASSERT_EQUAL_UINT16(4, stats.interval_histogram[9]);
+}
+
+// 最大超时、超时累计和步数；各分段只记录标记期间的最大超时，无效分段号被忽略
+void test_worst_overrun_total_and_by_section(void) {
+    stepper_timing_set_section(TIMING_SECTION_KEYS);
+    stepper_timing_record(40, 500);
+    stepper_timing_set_section(TIMING_SECTION_MENU);
+    stepper_timing_record(100, 500);
+    stepper_timing_set_section(STEPPER_TIMING_SECTIONS);
+    stepper_timing_record(60, 500);
+    stepper_timing_set_section(TIMING_SECTION_KEYS);
+    stepper_timing_record(20, 500);
+
+    stepper_timing_stats_t stats = snapshot();
+    TEST_ASSERT_EQUAL_UINT32(4, stats.samples);
+    TEST_ASSERT_EQUAL_UINT32(220, stats.overrun_sum);
+    TEST_ASSERT_EQUAL_UINT16(100, stats.worst_overrun);
+    TEST_ASSERT_EQUAL_UINT16(40, stats.section_worst[TIMING_SECTION_KEYS]);
+    TEST_ASSERT_EQUAL_UINT16(100, stats.section_worst[TIMING_SECTION_MENU]);
+    TEST_ASSERT_EQUAL_UINT16(0, stats.section_worst[TIMING_SECTION_IDLE]);
+    TEST_ASSERT_EQUAL_UINT16(0, stats.section_worst[TIMING_SECTION_STEPPER]);
+}
+
+// 清空后所有计数归零，之后重新开始记录
+void test_reset_clears_everything(void) {
+    stepper_timing_set_section(TIMING_SECTION_SCAN);
+    for (uint16_t i = 0; i < 50; i++) {
+        stepper_timing_record(i, 500);
+    }
+    stepper_timing_reset();
+
+    stepper_timing_stats_t stats = snapshot();
+    for (uint8_t b = 0; b < STEPPER_TIMING_BUCKETS; b++) {
+        TEST_ASSERT_EQUAL_UINT16(0, stats.interval_histogram[b]);
+        TEST_ASSERT_EQUAL_UINT16(0, stats.overrun_histogram[b]);
+    }
+    for (uint8_t s = 0; s < STEPPER_TIMING_SECTIONS; s++) {
+        TEST_ASSERT_EQUAL_UINT16(0, stats.section_worst[s]);
+    }
+    TEST_ASSERT_EQUAL_UINT16(0, stats.worst_overrun);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.overrun_sum);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.samples);
+
+    stepper_timing_record(7, 500);
+    stats = snapshot();
+    TEST_ASSERT_EQUAL_UINT32(1, stats.samples);
+    TEST_ASSERT_EQUAL_UINT16(7, stats.section_worst[TIMING_SECTION_SCAN]);
+}
+
+// 步进中断每走一步记录一次：入口处的TCNT1为超时，预励磁锁定的中断不计入
+void test_step_isr_records_each_step(void) {
+    const uint16_t latency[] = {0, 3, 0, 50, 12, 0, 0, 7};
+    const uint8_t steps = sizeof(latency) / sizeof(latency[0]);
+    stepper_motor_set_lock_in(STEPPER_LOCK_IN_MS);
+
+    stepper_motor_rotate_steps(steps);
+    sim_fire();
+    TEST_ASSERT_EQUAL_UINT32(0, snapshot().samples);
+
+    uint32_t sum = 0;
+    for (uint8_t i = 0; i < steps; i++) {
+        sim_fire(latency[i]);
+        sum += latency[i];
+    }
+    TEST_ASSERT_FALSE(sim_timer_running());
+
+    stepper_timing_stats_t stats = snapshot();
+    TEST_ASSERT_EQUAL_UINT32(steps, stats.samples);
+    TEST_ASSERT_EQUAL_UINT32(sum, stats.overrun_sum);
+    TEST_ASSERT_EQUAL_UINT16(50, stats.worst_overrun);
+
+    uint16_t counted = 0;
+    for (uint8_t b = 0; b < STEPPER_TIMING_BUCKETS; b++) {
+        counted += stats.interval_histogram[b];
+    }
+    TEST_ASSERT_EQUAL_UINT16(steps, counted);
+}
+
+// 串口命令：'t'输出统计，'r'清空统计
+void test_serial_commands(void) {
+    stepper_timing_record(5, 500);
+    stepper_timing_record(9, 500);
+
+    stub_serial_input = "t";
+    stepper_timing_poll_serial();
+    TEST_ASSERT_TRUE(stub_serial_output.find("Steps: 2\r\n") != std::string::npos);
+    TEST_ASSERT_TRUE(stub_serial_output.find("Worst overrun (ticks): 9\r\n") != std::string::npos);
+    TEST_ASSERT_TRUE(stub_serial_output.find("Mean overrun (ticks x100): 700\r\n") != std::string::npos);
+
+    stub_serial_input = "r";
+    stepper_timing_poll_serial();
+    TEST_ASSERT_EQUAL_UINT32(0, snapshot().samples);
+    TEST_ASSERT_EQUAL_INT(0, Serial.available());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_bucket_boundaries);
+    RUN_TEST(test_interval_uses_previous_overrun);
+    RUN_TEST(test_worst_overrun_total_and_by_section);
+    RUN_TEST(test_reset_clears_everything);
+    RUN_TEST(test_step_isr_records_each_step);
+    RUN_TEST(test_serial_commands);
+    return UNITY_END();
+}
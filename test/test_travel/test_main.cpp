@@ -0,0 +1,137 @@
+#include <unity.h>
+#include "stepper_sim.h"
+
+// 累计转动量长时间运行：圈数和圈内偏移与总步数的精确换算一致，不溢出、不漂移
+
+static stepper_gear_ratio_t ratio;
+
+void setUp(void) {
+    sim_reset();
+    stepper_motor_set_step_mode(STEP_MODE_FULL);
+    stepper_motor_set_custom_speed(2);
+    stepper_motor_reset_step_count();
+    stepper_motor_get_gear_ratio(&ratio);
+}
+
+void tearDown(void) {
+    stepper_motor_halt();
+}
+
+// 累计量与总步数的精确换算一致
+static void assert_travel(uint64_t total_steps) {
+    stepper_gear_travel_t travel;
+    stepper_motor_get_travel(&travel);
+
+    uint64_t scaled = total_steps * ratio.den;
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)(scaled / ratio.num), travel.turns);
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)(scaled % ratio.num), travel.offset);
+    TEST_ASSERT_EQUAL_UINT16((uint16_t)((scaled % ratio.num) * 360 / ratio.num), stepper_motor_get_current_angle());
+}
+
+// 连续转动200圈，主循环以不规则的间隔结算，每次结算后都精确
+void test_continuous_soak(void) {
+    stepper_motor_start();
+    uint64_t fired = 0;
+    uint32_t gap = 1;
+
+    while (fired < 200ULL * ratio.num / ratio.den) {
+        for (uint32_t i = 0; i < gap; i++) {
+            sim_fire();
+        }
+        fired += gap;
+        stepper_motor_update();
+        assert_travel(fired);
+        gap = gap * 13 % 4093 + 1;
+    }
+}
+
+// 正反交替的计数运动：累计量按走过的步数计，与方向无关
+void test_back_and_forth_soak(void) {
+    uint64_t total = 0;
+    uint32_t steps = 17;
+
+    for (uint16_t i = 0; i < 300; i++) {
+        stepper_motor_set_direction(i % 2 == 0 ? CLOCKWISE : COUNTER_CLOCKWISE);
+        stepper_motor_rotate_steps(steps);
+        sim_run_to_stop();
+        total += steps;
+        if (i % 7 == 0) {
+            stepper_motor_update();
+        }
+        steps = steps * 31 % 2503 + 1;
+    }
+    assert_travel(total);
+}
+
+// 绝对位置超过STEPPER_POSITION_WRAP时按整圈回绕：圈内位置和累计量都不受影响
+void test_position_wrap_keeps_travel(void) {
+    stepper_motor_set_position(STEPPER_POSITION_WRAP - 500);
+    uint32_t before = stepper_motor_get_position_in_revolution();
+
+    stepper_motor_rotate_steps(1000);
+    sim_run_to_stop();
+    stepper_motor_update();
+
+    TEST_ASSERT_LESS_OR_EQUAL(STEPPER_POSITION_WRAP, stepper_motor_get_position());
+    uint32_t expected = (uint32_t)(((uint64_t)before * ratio.den + 1000ULL * ratio.den) % ratio.num / ratio.den);
+    TEST_ASSERT_UINT32_WITHIN(1, expected, stepper_motor_get_position_in_revolution());
+    assert_travel(1000);
+}
+
+// 切换步进模式：未结算的步数按旧每转步数结算，圈内偏移换算到新单位，每次切换误差小于1/num圈
+void test_mode_switch_soak(void) {
+    // 以1/(num_full×num_half)圈为单位保存精确累计量
+    stepper_gear_ratio_t full, half;
+    stepper_gear_make_ratio(&full, 1, 1, 1);
+    stepper_gear_make_ratio(&half, 2, 1, 1);
+    uint64_t exact = 0;     // 精确圈数 × full.num × half.num
+    uint16_t switches = 0;
+
+    for (uint16_t i = 0; i < 40; i++) {
+        bool is_half = i % 2 == 1;
+        const stepper_gear_ratio_t* current = is_half ? &half : &full;
+        stepper_motor_set_step_mode(is_half ? STEP_MODE_HALF : STEP_MODE_FULL);
+        switches++;
+
+        uint32_t steps = 3000 + i * 37;
+        stepper_motor_start();
+        for (uint32_t s = 0; s < steps; s++) {
+            sim_fire();
+        }
+        stepper_motor_halt();
+        exact += (uint64_t)steps * current->den * (is_half ? full.num : half.num);
+    }
+
+    stepper_gear_travel_t travel;
+    stepper_motor_get_travel(&travel);
+    stepper_motor_get_gear_ratio(&ratio);
+
+    uint64_t unit = (uint64_t)full.num * half.num;
+    uint64_t measured = (uint64_t)travel.turns * unit + (uint64_t)travel.offset * unit / ratio.num;
+    uint64_t tolerance = switches * unit / ratio.num + 1;
+    TEST_ASSERT_TRUE(measured + tolerance >= exact && measured <= exact + tolerance);
+}
+
+// 超过2^32步（按最高速度约100天）的累计：分块结算仍与64位精确值一致
+void test_beyond_32bit_steps(void) {
+    stepper_gear_travel_t travel = {0, 0};
+    uint64_t total = 0;
+
+    while (total < 6000000000ULL) {
+        stepper_gear_travel_add(&ratio, &travel, 0xFFFFFFUL);
+        total += 0xFFFFFFUL;
+    }
+    uint64_t scaled = total * ratio.den;
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)(scaled / ratio.num), travel.turns);
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)(scaled % ratio.num), travel.offset);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_continuous_soak);
+    RUN_TEST(test_back_and_forth_soak);
+    RUN_TEST(test_position_wrap_keeps_travel);
+    RUN_TEST(test_mode_switch_soak);
+    RUN_TEST(test_beyond_32bit_steps);
+    return UNITY_END();
+}